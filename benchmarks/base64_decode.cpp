@@ -0,0 +1,168 @@
+/*
+  base64_decode.cpp : compares the scalar and SIMD base64 decoders.
+    First checks that the AVX2 (or NEON) decoder agrees with the
+    scalar one: random strings of many lengths, with and without
+    padding and some with an invalid character, must decode to the
+    same bytes and be rejected alike. Exits with 1 if they do not.
+    On a processor without AVX2 both sides use the scalar decoder.
+
+    Then times Base64::DecodeFloats on one embedding with each
+    decoder, and EmbeddingMatrix::Parse on an embeddings response
+    whose vectors are written as text and as base64.
+
+    usage: base64_decode [rows] [dimensions]
+*/
+
+#include "liboai.h"
+#include "bench.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+using namespace liboai;
+
+namespace {
+  std::string Encode(const uint8_t* data, size_t size, bool padded) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    std::string out;
+    for (size_t i = 0; i < size; i += 3) {
+      uint32_t v = static_cast<uint32_t>(data[i]) << 16;
+      if (i + 1 < size) v |= static_cast<uint32_t>(data[i + 1]) << 8;
+      if (i + 2 < size) v |= data[i + 2];
+
+      size_t chars = size - i >= 3 ? 4 : size - i + 1;
+      for (size_t c = 0; c < chars; ++c) {
+        out += alphabet[(v >> (18 - 6 * c)) & 0x3F];
+      }
+      if (padded) {
+        out.append(4 - chars, '=');
+      }
+    }
+    return out;
+  }
+
+  // decodes 'in' with both decoders and reports whether they agree
+  // with each other and, for valid input, with 'expected'
+  bool Agrees(const std::string& in, const std::vector<uint8_t>* expected) {
+    size_t size = Base64::DecodedSize(in);
+    std::vector<uint8_t> simd(size == Base64::npos ? 0 : size), scalar(simd.size());
+
+    Base64::SetSimd(true);
+    bool simd_ok = size != Base64::npos && Base64::Decode(in, simd.data());
+    Base64::SetSimd(false);
+    bool scalar_ok = size != Base64::npos && Base64::Decode(in, scalar.data());
+    Base64::SetSimd(true);
+
+    if (simd_ok != scalar_ok || simd_ok != (expected != nullptr)) {
+      return false;
+    }
+    return !simd_ok || (simd == scalar && simd == *expected);
+  }
+
+  bool CrossCheck() {
+    std::mt19937 rng(15);
+    std::uniform_int_distribution<int> byte(0, 255);
+    const char invalid[] = { '=', '-', '_', ' ', '\n', '.', '\0', '\x80', '\xFF' };
+
+    size_t checked = 0, failed = 0;
+    for (size_t length = 0; length <= 4096; length += (length < 512 ? 1 : 61)) {
+      for (int trial = 0; trial < 4; ++trial) {
+        std::vector<uint8_t> data(length);
+        for (auto& b : data) {
+          b = static_cast<uint8_t>(byte(rng));
+        }
+
+        std::string in = Encode(data.data(), data.size(), trial % 2 == 0);
+        bool corrupt = trial >= 2 && !in.empty();
+        if (corrupt) {
+          // anywhere before the padding; an '=' in the last place
+          // would just be read as padding
+          size_t significant = std::min(in.find('='), in.size());
+          size_t at = rng() % significant;
+          char c;
+          do {
+            c = invalid[rng() % sizeof(invalid)];
+          } while (c == '=' && at + 1 == significant);
+          in[at] = c;
+        }
+
+        ++checked;
+        if (!Agrees(in, corrupt ? nullptr : &data)) {
+          if (++failed <= 10) {
+            std::printf("mismatch: %zu bytes%s%s\n", length, trial % 2 == 0 ? ", padded" : "", corrupt ? ", corrupt" : "");
+          }
+        }
+      }
+    }
+
+    std::printf("cross-check: %zu strings, %zu mismatches\n", checked, failed);
+    return failed == 0;
+  }
+}
+
+int main(int argc, char** argv) {
+  size_t rows = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 16;
+  size_t dimensions = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1536;
+
+  if (!CrossCheck()) {
+    return 1;
+  }
+
+  // vectors shaped like real embeddings, in both of the API's encodings
+  std::mt19937 rng(1536);
+  std::normal_distribution<float> component(0.0f, 0.03f);
+
+  std::vector<std::vector<float>> vectors(rows, std::vector<float>(dimensions));
+  std::string text = R"({"object":"list","data":[)", base64 = text;
+  for (size_t r = 0; r < rows; ++r) {
+    std::string index = std::to_string(r);
+    text += (r ? "," : "") + std::string(R"({"object":"embedding","index":)") + index + R"(,"embedding":[)";
+    for (size_t d = 0; d < dimensions; ++d) {
+      char digits[32];
+      vectors[r][d] = component(rng);
+      std::snprintf(digits, sizeof(digits), "%s%.9g", d ? "," : "", vectors[r][d]);
+      text += digits;
+    }
+    text += "]}";
+
+    base64 += (r ? "," : "") + std::string(R"({"object":"embedding","index":)") + index + R"(,"embedding":")";
+    base64 += Encode(reinterpret_cast<const uint8_t*>(vectors[r].data()), dimensions * sizeof(float), true);
+    base64 += "\"}";
+  }
+  const std::string tail = R"(],"model":"text-embedding-ada-002-v2","usage":{"prompt_tokens":8,"total_tokens":8}})";
+  text += tail;
+  base64 += tail;
+
+  std::string one = Encode(reinterpret_cast<const uint8_t*>(vectors[0].data()), dimensions * sizeof(float), true);
+  std::vector<float> out(dimensions);
+
+  std::printf("\nBase64::DecodeFloats, %zu dimensions (%zu characters)\n", dimensions, one.size());
+  for (bool simd : { false, true }) {
+    Base64::SetSimd(simd);
+    bench::Measure(simd ? "  SIMD" : "  scalar", one.size(), [&]() {
+      return Base64::DecodeFloats(one, out.data(), dimensions) ? out.size() : 0;
+    });
+  }
+
+  std::printf("\nEmbeddingMatrix::Parse, %zu x %zu\n", rows, dimensions);
+  bench::Measure("  text (" + std::to_string(text.size()) + " bytes)", text.size(), [&]() {
+    return EmbeddingMatrix::Parse(text).Rows();
+  });
+  for (bool simd : { false, true }) {
+    Base64::SetSimd(simd);
+    bench::Measure(std::string("  base64, ") + (simd ? "SIMD" : "scalar") + " (" + std::to_string(base64.size()) + " bytes)", base64.size(), [&]() {
+      return EmbeddingMatrix::Parse(base64).Rows();
+    });
+  }
+
+  // both encodings must give the same vectors
+  EmbeddingMatrix from_text = EmbeddingMatrix::Parse(text), from_base64 = EmbeddingMatrix::Parse(base64);
+  for (size_t r = 0; r < rows; ++r) {
+    if (std::memcmp(from_text.Row(r).data(), from_base64.Row(r).data(), dimensions * sizeof(float)) != 0) {
+      std::printf("row %zu differs between text and base64\n", r);
+      return 1;
+    }
+  }
+}
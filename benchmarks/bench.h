@@ -0,0 +1,56 @@
+#pragma once
+
+/*
+  bench.h : helpers shared by the benchmarks.
+    Reads the payloads checked in under benchmarks/data and times
+    a call by repeating it until the measurement is long enough to
+    be stable, then prints its mean time and throughput.
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace bench {
+  // reads a payload relative to benchmarks/data
+  inline std::string ReadData(const std::string& name) {
+    std::ifstream file(std::string(LIBOAI_BENCH_DATA) + "/" + name, std::ios::binary);
+    if (!file) {
+      throw std::runtime_error("cannot open benchmarks/data/" + name);
+    }
+
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+  }
+
+  // results are summed into here so the calls being timed can't be
+  // optimized away
+  inline volatile size_t sink = 0;
+
+  // calls 'call' in doubling batches until a batch takes at least a
+  // quarter of a second, then prints the mean time per call and, as
+  // each call handles 'bytes', the throughput; returns microseconds
+  template <class _Call>
+  double Measure(const std::string& label, size_t bytes, _Call&& call) {
+    using clock = std::chrono::steady_clock;
+
+    sink = sink + call(); // warm up
+    for (size_t iterations = 1; ; iterations *= 2) {
+      auto start = clock::now();
+      for (size_t i = 0; i < iterations; ++i) {
+        sink = sink + call();
+      }
+      double seconds = std::chrono::duration<double>(clock::now() - start).count();
+
+      if (seconds >= 0.25) {
+        double micros = seconds * 1e6 / iterations;
+        std::printf("%-44s %12.2f us %10.1f MB/s\n", label.c_str(), micros, bytes / micros);
+        return micros;
+      }
+    }
+  }
+}
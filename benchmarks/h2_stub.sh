@@ -0,0 +1,35 @@
+#!/bin/sh
+# Serves benchmarks/data/h2 on https://127.0.0.1:8443 over both
+# HTTP/2 and HTTP/1.1, for the http2 benchmark. nghttpx terminates
+# TLS with a throwaway self-signed certificate and forwards to a
+# static file server. Needs nghttpx, python3 and openssl on PATH.
+set -e
+
+here=$(cd "$(dirname "$0")" && pwd)
+work=$(mktemp -d)
+trap 'kill $backend 2>/dev/null; rm -rf "$work"' EXIT INT TERM
+
+openssl req -x509 -newkey rsa:2048 -nodes -subj /CN=127.0.0.1 -days 1 \
+  -keyout "$work/key.pem" -out "$work/cert.pem" 2>/dev/null
+
+# http.server's default listen backlog of five drops connections
+# under load, so the backend is set up here with a deeper one
+python3 - "$here/data/h2" <<'PY' &
+import functools, http.server, sys
+
+class Handler(http.server.SimpleHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+    disable_nagle_algorithm = True
+    def log_message(self, *args):
+        pass
+
+class Server(http.server.ThreadingHTTPServer):
+    request_queue_size = 1024
+    daemon_threads = True
+
+Server(("127.0.0.1", 8480), functools.partial(Handler, directory=sys.argv[1])).serve_forever()
+PY
+backend=$!
+
+nghttpx --frontend=127.0.0.1,8443 --backend=127.0.0.1,8480 --workers=1 \
+  --no-ocsp --log-level=WARN "$work/key.pem" "$work/cert.pem"
@@ -0,0 +1,122 @@
+/*
+  http2.cpp : compares HTTP/1.1 with multiplexed HTTP/2.
+    Sends the same requests to a local stub with each protocol, first
+    from threads making synchronous calls and then as asynchronous
+    calls kept in flight together, and reports the throughput and how
+    many connections had to be opened. Asynchronous calls may reuse
+    connections the synchronous ones opened.
+
+    Start the stub with benchmarks/h2_stub.sh. It presents a self-
+    signed certificate, so liboai must be configured with
+    -DCMAKE_CXX_FLAGS=-DLIBOAI_DISABLE_PEERVERIFY for this benchmark.
+
+    usage: http2 [root] [requests] [concurrency]
+*/
+
+#include "liboai.h"
+
+#include <chrono>
+#include <deque>
+#include <thread>
+
+using namespace liboai;
+
+namespace {
+  struct Outcome {
+    int failed = 0;
+    double seconds = 0.0;
+  };
+
+  Outcome RunSync(const OpenAI& oai, int requests, int concurrency) {
+    std::atomic<int> next = 0, failed = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < concurrency; ++t) {
+      threads.emplace_back([&]() {
+        while (next.fetch_add(1) < requests) {
+          try {
+            oai.Model->retrieve("bench");
+          }
+          catch (const std::exception&) {
+            ++failed;
+          }
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    return { failed.load(), std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() };
+  }
+
+  Outcome RunAsync(const OpenAI& oai, int requests, int concurrency) {
+    Outcome outcome;
+    auto start = std::chrono::steady_clock::now();
+
+    // at most 'concurrency' requests are in flight at once
+    std::deque<FutureResponse> in_flight;
+    for (int i = 0; i < requests || !in_flight.empty(); ) {
+      if (i < requests && static_cast<int>(in_flight.size()) < concurrency) {
+        in_flight.push_back(oai.Model->retrieve_async("bench"));
+        ++i;
+        continue;
+      }
+
+      try {
+        in_flight.front().get();
+      }
+      catch (const std::exception&) {
+        ++outcome.failed;
+      }
+      in_flight.pop_front();
+    }
+
+    outcome.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return outcome;
+  }
+}
+
+int main(int argc, char** argv) {
+  std::string root = argc > 1 ? argv[1] : "https://127.0.0.1:8443/v1";
+  int requests = argc > 2 ? std::atoi(argv[2]) : 2000;
+  int concurrency = argc > 3 ? std::atoi(argv[3]) : 32;
+
+  // each protocol is measured in a process of its own, as cURL would
+  // otherwise carry connections the other one opened over to it
+  if (argc <= 4) {
+    std::printf("%-9s %-6s %10s %12s %8s %8s\n", "protocol", "calls", "requests/s", "connections", "reused", "failed");
+    std::fflush(stdout);
+
+    for (const char* protocol : { "1.1", "2" }) {
+      std::string command = "\"" + std::string(argv[0]) + "\" \"" + root + "\" " + std::to_string(requests) + " " + std::to_string(concurrency) + " " + protocol;
+      if (std::system(command.c_str()) != 0) {
+        return 1;
+      }
+    }
+    return 0;
+  }
+
+  bool http2 = std::string(argv[4]) == "2";
+  if (!Network::SetHttp2(http2)) {
+    std::printf("cURL was built without HTTP/2 support\n");
+    return 1;
+  }
+
+  OpenAI oai(root);
+  netimpl::Share& share = netimpl::Share::Shared();
+
+  for (bool async : { false, true }) {
+    uint64_t opened = share.NewConnections(), reused = share.ConnectionReuses();
+    Outcome outcome = async ? RunAsync(oai, requests, concurrency) : RunSync(oai, requests, concurrency);
+
+    std::printf("%-9s %-6s %10.0f %12llu %8llu %8d\n",
+      http2 ? "HTTP/2" : "HTTP/1.1", async ? "async" : "sync",
+      requests / outcome.seconds,
+      static_cast<unsigned long long>(share.NewConnections() - opened),
+      static_cast<unsigned long long>(share.ConnectionReuses() - reused),
+      outcome.failed
+    );
+  }
+}
@@ -0,0 +1,51 @@
+/*
+  json_backend.cpp : times the JSON backend liboai was built with.
+    Parses the response payloads under benchmarks/data/json into a
+    document with JsonParser::Parse, and into the typed results that
+    read them as they are parsed where the payload has one, next to
+    nlohmann::json::parse as the reference. Build liboai once with
+    and once without -DLIBOAI_SIMDJSON=ON to compare the backends.
+
+    usage: json_backend
+*/
+
+#include "liboai.h"
+#include "bench.h"
+
+using namespace liboai;
+
+int main() {
+  std::printf("backend: %s\n", JsonParser::Backend());
+
+  for (const char* name : { "chat_completion", "embeddings", "moderation", "models" }) {
+    const std::string payload = bench::ReadData(std::string("json/") + name + ".json");
+    std::printf("\n%s (%zu bytes)\n", name, payload.size());
+
+    bench::Measure("  nlohmann::json::parse", payload.size(), [&]() {
+      return nlohmann::json::parse(payload).size();
+    });
+    bench::Measure("  JsonParser::Parse", payload.size(), [&]() {
+      return JsonParser::Parse(payload).size();
+    });
+
+    std::string typed = name;
+    if (typed == "chat_completion") {
+      bench::Measure("  ChatCompletionResult::Parse", payload.size(), [&]() {
+        return ChatCompletionResult::Parse(payload).choices.size();
+      });
+    }
+    else if (typed == "embeddings") {
+      bench::Measure("  EmbeddingResult::Parse", payload.size(), [&]() {
+        return EmbeddingResult::Parse(payload).data.size();
+      });
+      bench::Measure("  EmbeddingMatrix::Parse", payload.size(), [&]() {
+        return EmbeddingMatrix::Parse(payload).Rows();
+      });
+    }
+    else if (typed == "moderation") {
+      bench::Measure("  ModerationResult::Parse", payload.size(), [&]() {
+        return ModerationResult::Parse(payload).results.size();
+      });
+    }
+  }
+}
@@ -0,0 +1,78 @@
+/*
+  retry_policy.cpp : checks and times RetryPolicy::Delay.
+    First checks that each form of Retry-After is honored: a number
+    of seconds, retry-after-ms, and an HTTP date such as "Wed, 21 Oct
+    2015 07:28:00 GMT", a minute ahead and in the past. A malformed
+    header must fall back to backoff. Exits with 1 if any is not.
+
+    Then times Delay on a 429 carrying each form of the header.
+
+    usage: retry_policy
+*/
+
+#include "liboai.h"
+#include "bench.h"
+
+#include <ctime>
+
+using namespace liboai;
+
+namespace {
+  // an IMF-fixdate 'offset' seconds from now
+  std::string HttpDate(std::chrono::seconds offset) {
+    std::time_t at = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now() + offset);
+    char date[64];
+    std::strftime(date, sizeof(date), "%a, %d %b %Y %H:%M:%S GMT", std::gmtime(&at));
+    return date;
+  }
+
+  std::optional<std::chrono::milliseconds> Delay(const RetryPolicy& policy, const netimpl::components::Header& header) {
+    RetryPolicy::Failure failure;
+    failure.status_code = 429;
+    failure.header = &header;
+    return policy.Delay(failure);
+  }
+
+  bool Expect(const char* label, std::optional<std::chrono::milliseconds> delay, int64_t low, int64_t high) {
+    bool ok = delay && delay->count() >= low && delay->count() <= high;
+    std::printf("%-44s %s (%lld ms)\n", label, ok ? "ok" : "FAILED", delay ? static_cast<long long>(delay->count()) : -1LL);
+    return ok;
+  }
+}
+
+int main() {
+  // backoff is pinned to 1 ms, so that only a honored header can
+  // give a longer delay
+  RetryPolicyOptions options;
+  options.statuses = { { 429, { 4, std::chrono::milliseconds(1) } } };
+  options.max_delay = std::chrono::milliseconds(1);
+  RetryPolicy policy(options);
+
+  const netimpl::components::Header seconds = { { "Retry-After", "7" } };
+  const netimpl::components::Header ms = { { "retry-after-ms", "250" } };
+  const netimpl::components::Header date = { { "Retry-After", HttpDate(std::chrono::seconds(60)) } };
+  const netimpl::components::Header past = { { "Retry-After", HttpDate(-std::chrono::seconds(60)) } };
+  const netimpl::components::Header malformed = { { "Retry-After", "Wed 21 Oct" } };
+
+  bool ok = true;
+  ok &= Expect("Retry-After: 7", Delay(policy, seconds), 7000, 7000);
+  ok &= Expect("retry-after-ms: 250", Delay(policy, ms), 250, 250);
+  ok &= Expect("Retry-After: <a minute from now>", Delay(policy, date), 58000, 61000);
+  ok &= Expect("Retry-After: <a minute ago>", Delay(policy, past), 0, 0);
+  ok &= Expect("Retry-After: <malformed>", Delay(policy, malformed), 1, 1);
+  if (!ok) {
+    return 1;
+  }
+
+  std::printf("\n");
+  bench::Measure("Delay, Retry-After seconds", 0, [&]() {
+    return static_cast<size_t>(Delay(policy, seconds)->count());
+  });
+  bench::Measure("Delay, retry-after-ms", 0, [&]() {
+    return static_cast<size_t>(Delay(policy, ms)->count());
+  });
+  bench::Measure("Delay, Retry-After date", 0, [&]() {
+    return static_cast<size_t>(Delay(policy, date)->count());
+  });
+  return 0;
+}
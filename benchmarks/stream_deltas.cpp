@@ -0,0 +1,65 @@
+/*
+  stream_deltas.cpp : times the accumulation of streamed deltas.
+    Feeds a synthetic chat completion stream to a Conversation with
+    AppendStreamData, one event per call as cURL would hand them
+    over, until [DONE]. Each event carries a delta of one token.
+    Streams of 1k to 32k tokens are timed, and the cost per token,
+    which should stay flat as the response grows, is printed for
+    each, along with how it compares to the shortest.
+
+    usage: stream_deltas [tokens]
+*/
+
+#include "liboai.h"
+#include "bench.h"
+
+#include <cstdlib>
+
+using namespace liboai;
+
+namespace {
+  // the events of a stream of 'tokens' deltas, each one a complete
+  // "data: ...\n\n" event
+  std::vector<std::string> Stream(size_t tokens) {
+    std::vector<std::string> events;
+    events.reserve(tokens + 2);
+    events.push_back(R"(data: {"id":"chatcmpl-bench","object":"chat.completion.chunk","created":1686985942,"model":"gpt-3.5-turbo-0613","choices":[{"index":0,"delta":{"role":"assistant","content":""},"finish_reason":null}]})" "\n\n");
+    for (size_t i = 0; i < tokens; ++i) {
+      events.push_back(R"(data: {"id":"chatcmpl-bench","object":"chat.completion.chunk","created":1686985942,"model":"gpt-3.5-turbo-0613","choices":[{"index":0,"delta":{"content":" token)" + std::to_string(i % 100) + R"("},"finish_reason":null}]})" "\n\n");
+    }
+    events.push_back("data: [DONE]\n\n");
+    return events;
+  }
+}
+
+int main(int argc, char** argv) {
+  size_t longest = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 32768;
+
+  double first = 0.0;
+  for (size_t tokens = 1024; tokens <= longest; tokens *= 2) {
+    const std::vector<std::string> events = Stream(tokens);
+    size_t bytes = 0;
+    for (const auto& event : events) {
+      bytes += event.size();
+    }
+
+    double micros = bench::Measure(std::to_string(tokens) + " tokens", bytes, [&]() {
+      Conversation convo;
+      size_t accepted = convo.AddUserData("Write a long story.");
+
+      std::string delta;
+      bool completed = false;
+      for (const auto& event : events) {
+        accepted += convo.AppendStreamData(event, delta, completed);
+      }
+      return accepted + convo.GetLastResponse().size() + delta.size();
+    });
+
+    double per_token = micros / tokens;
+    if (first == 0.0) {
+      first = per_token;
+    }
+    std::printf("%-44s %12.2f us %9.2fx\n", "  per token", per_token, per_token / first);
+  }
+  return 0;
+}
@@ -1,6 +1,7 @@
 #include "../include/components/audio.h"
 
-liboai::Response liboai::Audio::transcribe(const std::filesystem::path& file, const std::string& model, std::optional<std::string> prompt, std::optional<std::string> response_format, std::optional<float> temperature, std::optional<std::string> language) const& noexcept(false) {
+template <class _Mode>
+typename _Mode::Result liboai::Audio::Transcribe(_Mode mode, const std::filesystem::path& file, const std::string& model, std::optional<std::string> prompt, std::optional<std::string> response_format, std::optional<float> temperature, std::optional<std::string> language) const {
 	if (!this->Validate(file)) {
 		throw liboai::exception::OpenAIException(
 			"File path provided is non-existent, is not a file, or is empty.",
@@ -19,24 +20,26 @@ liboai::Response liboai::Audio::transcribe(const std::filesystem::path& file, co
 	if (temperature) { form.parts.push_back({ "temperature", std::to_string(temperature.value()) }); }
 	if (language) { form.parts.push_back({ "language", language.value() }); }
 
-	Response res;
-	res = this->Request(
-		Method::HTTP_POST, this->openai_root_, "/audio/transcriptions", "multipart/form-data",
+	return this->Send(
+		mode, Method::HTTP_POST, this->openai_root_, "/audio/transcriptions", "multipart/form-data",
 		this->auth_.GetAuthorizationHeaders(),
 		std::move(form),
 		this->auth_.GetProxies(),
 		this->auth_.GetProxyAuth(),
 		this->auth_.GetMaxTimeout()
 	);
+}
 
-	return res;
+liboai::Response liboai::Audio::transcribe(const std::filesystem::path& file, const std::string& model, std::optional<std::string> prompt, std::optional<std::string> response_format, std::optional<float> temperature, std::optional<std::string> language) const& noexcept(false) {
+	return this->Transcribe(Synchronous{}, file, model, std::move(prompt), std::move(response_format), std::move(temperature), std::move(language));
 }
 
 liboai::FutureResponse liboai::Audio::transcribe_async(const std::filesystem::path& file, const std::string& model, std::optional<std::string> prompt, std::optional<std::string> response_format, std::optional<float> temperature, std::optional<std::string> language) const& noexcept(false) {
-	return std::async(std::launch::async, &liboai::Audio::transcribe, this, file, model, prompt, response_format, temperature, language);
+	return this->Transcribe(Asynchronous{}, file, model, std::move(prompt), std::move(response_format), std::move(temperature), std::move(language));
 }
 
-liboai::Response liboai::Audio::translate(const std::filesystem::path& file, const std::string& model, std::optional<std::string> prompt, std::optional<std::string> response_format, std::optional<float> temperature) const& noexcept(false) {
+template <class _Mode>
+typename _Mode::Result liboai::Audio::Translate(_Mode mode, const std::filesystem::path& file, const std::string& model, std::optional<std::string> prompt, std::optional<std::string> response_format, std::optional<float> temperature) const {
 	if (!this->Validate(file)) {
 		throw liboai::exception::OpenAIException(
 			"File path provided is non-existent, is not a file, or is empty.",
@@ -54,24 +57,26 @@ liboai::Response liboai::Audio::translate(const std::filesystem::path& file, con
 	if (response_format) { form.parts.push_back({ "response_format", std::move(response_format.value()) }); }
 	if (temperature) { form.parts.push_back({ "temperature", std::to_string(temperature.value()) }); }
 
-	Response res;
-	res = this->Request(
-		Method::HTTP_POST, this->openai_root_, "/audio/translations", "multipart/form-data",
+	return this->Send(
+		mode, Method::HTTP_POST, this->openai_root_, "/audio/translations", "multipart/form-data",
 		this->auth_.GetAuthorizationHeaders(),
 		std::move(form),
 		this->auth_.GetProxies(),
 		this->auth_.GetProxyAuth(),
 		this->auth_.GetMaxTimeout()
 	);
+}
 
-	return res;
+liboai::Response liboai::Audio::translate(const std::filesystem::path& file, const std::string& model, std::optional<std::string> prompt, std::optional<std::string> response_format, std::optional<float> temperature) const& noexcept(false) {
+	return this->Translate(Synchronous{}, file, model, std::move(prompt), std::move(response_format), std::move(temperature));
 }
 
 liboai::FutureResponse liboai::Audio::translate_async(const std::filesystem::path& file, const std::string& model, std::optional<std::string> prompt, std::optional<std::string> response_format, std::optional<float> temperature) const& noexcept(false) {
-	return std::async(std::launch::async, &liboai::Audio::translate, this, file, model, prompt, response_format, temperature);
+	return this->Translate(Asynchronous{}, file, model, std::move(prompt), std::move(response_format), std::move(temperature));
 }
 
-liboai::Response liboai::Audio::speech(const std::string& model, const std::string& voice, const std::string& input, std::optional<std::string> response_format, std::optional<float> speed) const& noexcept(false) {
+template <class _Mode>
+typename _Mode::Result liboai::Audio::Speech(_Mode mode, const std::string& model, const std::string& voice, const std::string& input, std::optional<std::string> response_format, std::optional<float> speed) const {
 	liboai::JsonConstructor jcon;
 	jcon.push_back("model", model);
 	jcon.push_back("voice", voice);
@@ -80,21 +85,22 @@ liboai::Response liboai::Audio::speech(const std::string& model, const std::stri
 	if (response_format) { jcon.push_back("response_format", std::move(response_format.value())); }
 	if (speed) { jcon.push_back("speed", speed.value()); }
 
-	Response res;
-	res = this->Request(
-		Method::HTTP_POST, this->openai_root_, "/audio/speech", "application/json",
+	return this->Send(
+		mode, Method::HTTP_POST, this->openai_root_, "/audio/speech", "application/json",
 		this->auth_.GetAuthorizationHeaders(),
 		netimpl::components::Body {
-			jcon.dump()
+			jcon.release()
 		},
 		this->auth_.GetProxies(),
 		this->auth_.GetProxyAuth(),
 		this->auth_.GetMaxTimeout()
 	);
+}
 
-	return res;
+liboai::Response liboai::Audio::speech(const std::string& model, const std::string& voice, const std::string& input, std::optional<std::string> response_format, std::optional<float> speed) const& noexcept(false) {
+	return this->Speech(Synchronous{}, model, voice, input, std::move(response_format), std::move(speed));
 }
 
 liboai::FutureResponse liboai::Audio::speech_async(const std::string& model, const std::string& voice, const std::string& input, std::optional<std::string> response_format, std::optional<float> speed) const& noexcept(false) {
-	return std::async(std::launch::async, &liboai::Audio::translate, this, model, voice, input, response_format, speed);
+	return this->Speech(Asynchronous{}, model, voice, input, std::move(response_format), std::move(speed));
 }
@@ -1,6 +1,7 @@
 #include "../include/components/azure.h"
 
-liboai::Response liboai::Azure::create_completion(const std::string& resource_name, const std::string& deployment_id, const std::string& api_version, std::optional<std::string> prompt, std::optional<std::string> suffix, std::optional<uint16_t> max_tokens, std::optional<float> temperature, std::optional<float> top_p, std::optional<uint16_t> n, std::optional<std::function<bool(std::string, intptr_t)>> stream, std::optional<uint8_t> logprobs, std::optional<bool> echo, std::optional<std::vector<std::string>> stop, std::optional<float> presence_penalty, std::optional<float> frequency_penalty, std::optional<uint16_t> best_of, std::optional<std::unordered_map<std::string, int8_t>> logit_bias, std::optional<std::string> user) const & noexcept(false) {
+template <class _Mode>
+typename _Mode::Result liboai::Azure::CreateCompletion(_Mode mode, const std::string& resource_name, const std::string& deployment_id, const std::string& api_version, std::optional<std::string> prompt, std::optional<std::string> suffix, std::optional<uint16_t> max_tokens, std::optional<float> temperature, std::optional<float> top_p, std::optional<uint16_t> n, std::optional<std::function<bool(std::string, intptr_t)>> stream, std::optional<uint8_t> logprobs, std::optional<bool> echo, std::optional<std::vector<std::string>> stop, std::optional<float> presence_penalty, std::optional<float> frequency_penalty, std::optional<uint16_t> best_of, std::optional<std::unordered_map<std::string, int8_t>> logit_bias, std::optional<std::string> user) const {
 	liboai::JsonConstructor jcon;
 	jcon.push_back("prompt", std::move(prompt));
 	jcon.push_back("suffix", std::move(suffix));
@@ -21,28 +22,30 @@ liboai::Response liboai::Azure::create_completion(const std::string& resource_na
 	netimpl::components::Parameters params;
 	params.Add({ "api-version", api_version });
 
-	Response res;
-	res = this->Request(
-		Method::HTTP_POST, ("https://" + resource_name + this->azure_root_ + "/deployments/" + deployment_id), "/completions", "application/json",
+	return this->Send(
+		mode, Method::HTTP_POST, ("https://" + resource_name + this->azure_root_ + "/deployments/" + deployment_id), "/completions", "application/json",
 		this->auth_.GetAzureAuthorizationHeaders(),
 		netimpl::components::Body {
-			jcon.dump()
+			jcon.release()
 		},
 		std::move(params),
-		stream ? netimpl::components::WriteCallback{std::move(stream.value())} : netimpl::components::WriteCallback{},
+		stream ? SseParser::Framed(std::move(stream.value())) : netimpl::components::WriteCallback{},
 		this->auth_.GetProxies(),
 		this->auth_.GetProxyAuth(),
 		this->auth_.GetMaxTimeout()
 	);
+}
 
-	return res;
+liboai::Response liboai::Azure::create_completion(const std::string& resource_name, const std::string& deployment_id, const std::string& api_version, std::optional<std::string> prompt, std::optional<std::string> suffix, std::optional<uint16_t> max_tokens, std::optional<float> temperature, std::optional<float> top_p, std::optional<uint16_t> n, std::optional<std::function<bool(std::string, intptr_t)>> stream, std::optional<uint8_t> logprobs, std::optional<bool> echo, std::optional<std::vector<std::string>> stop, std::optional<float> presence_penalty, std::optional<float> frequency_penalty, std::optional<uint16_t> best_of, std::optional<std::unordered_map<std::string, int8_t>> logit_bias, std::optional<std::string> user) const & noexcept(false) {
+	return this->CreateCompletion(Synchronous{}, resource_name, deployment_id, api_version, std::move(prompt), std::move(suffix), std::move(max_tokens), std::move(temperature), std::move(top_p), std::move(n), std::move(stream), std::move(logprobs), std::move(echo), std::move(stop), std::move(presence_penalty), std::move(frequency_penalty), std::move(best_of), std::move(logit_bias), std::move(user));
 }
 
 liboai::FutureResponse liboai::Azure::create_completion_async(const std::string& resource_name, const std::string& deployment_id, const std::string& api_version, std::optional<std::string> prompt, std::optional<std::string> suffix, std::optional<uint16_t> max_tokens, std::optional<float> temperature, std::optional<float> top_p, std::optional<uint16_t> n, std::optional<std::function<bool(std::string, intptr_t)>> stream, std::optional<uint8_t> logprobs, std::optional<bool> echo, std::optional<std::vector<std::string>> stop, std::optional<float> presence_penalty, std::optional<float> frequency_penalty, std::optional<uint16_t> best_of, std::optional<std::unordered_map<std::string, int8_t>> logit_bias, std::optional<std::string> user) const & noexcept(false) {
-	return std::async(std::launch::async, &liboai::Azure::create_completion, this, resource_name, deployment_id, api_version, prompt, suffix, max_tokens, temperature, top_p, n, stream, logprobs, echo, stop, presence_penalty, frequency_penalty, best_of, logit_bias, user);
+	return this->CreateCompletion(Asynchronous{}, resource_name, deployment_id, api_version, std::move(prompt), std::move(suffix), std::move(max_tokens), std::move(temperature), std::move(top_p), std::move(n), std::move(stream), std::move(logprobs), std::move(echo), std::move(stop), std::move(presence_penalty), std::move(frequency_penalty), std::move(best_of), std::move(logit_bias), std::move(user));
 }
 
-liboai::Response liboai::Azure::create_embedding(const std::string& resource_name, const std::string& deployment_id, const std::string& api_version, const std::string& input, std::optional<std::string> user) const & noexcept(false) {
+template <class _Mode>
+typename _Mode::Result liboai::Azure::CreateEmbedding(_Mode mode, const std::string& resource_name, const std::string& deployment_id, const std::string& api_version, const std::string& input, std::optional<std::string> user) const {
 	liboai::JsonConstructor jcon;
 	jcon.push_back("input", input);
 	jcon.push_back("user", std::move(user));
@@ -50,27 +53,29 @@ liboai::Response liboai::Azure::create_embedding(const std::string& resource_nam
 	netimpl::components::Parameters params;
 	params.Add({ "api-version", api_version });
 
-	Response res;
-	res = this->Request(
-		Method::HTTP_POST, ("https://" + resource_name + this->azure_root_ + "/deployments/" + deployment_id), "/embeddings", "application/json",
+	return this->Send(
+		mode, Method::HTTP_POST, ("https://" + resource_name + this->azure_root_ + "/deployments/" + deployment_id), "/embeddings", "application/json",
 		this->auth_.GetAzureAuthorizationHeaders(),
 		netimpl::components::Body {
-			jcon.dump()
+			jcon.release()
 		},
 		std::move(params),
 		this->auth_.GetProxies(),
 		this->auth_.GetProxyAuth(),
 		this->auth_.GetMaxTimeout()
 	);
+}
 
-	return res;
+liboai::Response liboai::Azure::create_embedding(const std::string& resource_name, const std::string& deployment_id, const std::string& api_version, const std::string& input, std::optional<std::string> user) const & noexcept(false) {
+	return this->CreateEmbedding(Synchronous{}, resource_name, deployment_id, api_version, input, std::move(user));
 }
 
 liboai::FutureResponse liboai::Azure::create_embedding_async(const std::string& resource_name, const std::string& deployment_id, const std::string& api_version, const std::string& input, std::optional<std::string> user) const & noexcept(false) {
-	return std::async(std::launch::async, &liboai::Azure::create_embedding, this, resource_name, deployment_id, api_version, input, user);
+	return this->CreateEmbedding(Asynchronous{}, resource_name, deployment_id, api_version, input, std::move(user));
 }
 
-liboai::Response liboai::Azure::create_chat_completion(const std::string& resource_name, const std::string& deployment_id, const std::string& api_version, Conversation& conversation, std::optional<std::string> function_call, std::optional<float> temperature, std::optional<uint16_t> n, std::optional<ChatStreamCallback> stream, std::optional<std::vector<std::string>> stop, std::optional<uint16_t> max_tokens, std::optional<float> presence_penalty, std::optional<float> frequency_penalty, std::optional<std::unordered_map<std::string, int8_t>> logit_bias, std::optional<std::string> user) const & noexcept(false) {
+template <class _Mode>
+typename _Mode::Result liboai::Azure::CreateChatCompletion(_Mode mode, const std::string& resource_name, const std::string& deployment_id, const std::string& api_version, Conversation& conversation, std::optional<std::string> function_call, std::optional<float> temperature, std::optional<uint16_t> n, std::optional<ChatStreamCallback> stream, std::optional<std::vector<std::string>> stop, std::optional<uint16_t> max_tokens, std::optional<float> presence_penalty, std::optional<float> frequency_penalty, std::optional<std::unordered_map<std::string, int8_t>> logit_bias, std::optional<std::string> user) const {
 	liboai::JsonConstructor jcon;
 	jcon.push_back("temperature", std::move(temperature));
 	jcon.push_back("n", std::move(n));
@@ -102,9 +107,7 @@ liboai::Response liboai::Azure::create_chat_completion(const std::string& resour
 		jcon.push_back("stream", _sscb);
 	}
 
-	if (conversation.GetJSON().contains("messages")) {
-		jcon.push_back("messages", conversation.GetJSON()["messages"]);
-	}
+	jcon.push_back_raw("messages", conversation.SerializeMessages());
 
 	if (conversation.HasFunctions()) {
 		jcon.push_back("functions", conversation.GetFunctionsJSON()["functions"]);
@@ -113,12 +116,11 @@ liboai::Response liboai::Azure::create_chat_completion(const std::string& resour
 	netimpl::components::Parameters params;
 	params.Add({ "api-version", api_version });
 
-	Response res;
-	res = this->Request(
-		Method::HTTP_POST, ("https://" + resource_name + this->azure_root_ + "/deployments/" + deployment_id), "/chat/completions", "application/json",
+	return this->Send(
+		mode, Method::HTTP_POST, ("https://" + resource_name + this->azure_root_ + "/deployments/" + deployment_id), "/chat/completions", "application/json",
 		this->auth_.GetAzureAuthorizationHeaders(),
 		netimpl::components::Body {
-			jcon.dump()
+			jcon.release()
 		},
 		std::move(params),
 		_sscb ? netimpl::components::WriteCallback{std::move(_sscb)} : netimpl::components::WriteCallback{},
@@ -126,15 +128,18 @@ liboai::Response liboai::Azure::create_chat_completion(const std::string& resour
 		this->auth_.GetProxyAuth(),
 		this->auth_.GetMaxTimeout()
 	);
+}
 
-	return res;
+liboai::Response liboai::Azure::create_chat_completion(const std::string& resource_name, const std::string& deployment_id, const std::string& api_version, Conversation& conversation, std::optional<std::string> function_call, std::optional<float> temperature, std::optional<uint16_t> n, std::optional<ChatStreamCallback> stream, std::optional<std::vector<std::string>> stop, std::optional<uint16_t> max_tokens, std::optional<float> presence_penalty, std::optional<float> frequency_penalty, std::optional<std::unordered_map<std::string, int8_t>> logit_bias, std::optional<std::string> user) const & noexcept(false) {
+	return this->CreateChatCompletion(Synchronous{}, resource_name, deployment_id, api_version, conversation, std::move(function_call), std::move(temperature), std::move(n), std::move(stream), std::move(stop), std::move(max_tokens), std::move(presence_penalty), std::move(frequency_penalty), std::move(logit_bias), std::move(user));
 }
 
 liboai::FutureResponse liboai::Azure::create_chat_completion_async(const std::string& resource_name, const std::string& deployment_id, const std::string& api_version, Conversation& conversation, std::optional<std::string> function_call, std::optional<float> temperature, std::optional<uint16_t> n, std::optional<ChatStreamCallback> stream, std::optional<std::vector<std::string>> stop, std::optional<uint16_t> max_tokens, std::optional<float> presence_penalty, std::optional<float> frequency_penalty, std::optional<std::unordered_map<std::string, int8_t>> logit_bias, std::optional<std::string> user) const & noexcept(false) {
-	return std::async(std::launch::async, &liboai::Azure::create_chat_completion, this, resource_name, deployment_id, api_version, std::ref(conversation), function_call, temperature, n, stream, stop, max_tokens, presence_penalty, frequency_penalty, logit_bias, user);
+	return this->CreateChatCompletion(Asynchronous{}, resource_name, deployment_id, api_version, conversation, std::move(function_call), std::move(temperature), std::move(n), std::move(stream), std::move(stop), std::move(max_tokens), std::move(presence_penalty), std::move(frequency_penalty), std::move(logit_bias), std::move(user));
 }
 
-liboai::Response liboai::Azure::request_image_generation(const std::string& resource_name, const std::string& api_version, const std::string& prompt, std::optional<uint8_t> n, std::optional<std::string> size) const & noexcept(false) {
+template <class _Mode>
+typename _Mode::Result liboai::Azure::RequestImageGeneration(_Mode mode, const std::string& resource_name, const std::string& api_version, const std::string& prompt, std::optional<uint8_t> n, std::optional<std::string> size) const {
 	liboai::JsonConstructor jcon;
 	jcon.push_back("prompt", prompt);
 	jcon.push_back("n", std::move(n));
@@ -143,64 +148,69 @@ liboai::Response liboai::Azure::request_image_generation(const std::string& reso
 	netimpl::components::Parameters params;
 	params.Add({ "api-version", api_version });
 
-	Response res;
-	res = this->Request(
-		Method::HTTP_POST, ("https://" + resource_name + this->azure_root_), "/images/generations:submit", "application/json",
+	return this->Send(
+		mode, Method::HTTP_POST, ("https://" + resource_name + this->azure_root_), "/images/generations:submit", "application/json",
 		this->auth_.GetAzureAuthorizationHeaders(),
 		netimpl::components::Body {
-			jcon.dump()
+			jcon.release()
 		},
 		std::move(params),
 		this->auth_.GetProxies(),
 		this->auth_.GetProxyAuth(),
 		this->auth_.GetMaxTimeout()
 	);
+}
 
-	return res;
+liboai::Response liboai::Azure::request_image_generation(const std::string& resource_name, const std::string& api_version, const std::string& prompt, std::optional<uint8_t> n, std::optional<std::string> size) const & noexcept(false) {
+	return this->RequestImageGeneration(Synchronous{}, resource_name, api_version, prompt, std::move(n), std::move(size));
 }
 
 liboai::FutureResponse liboai::Azure::request_image_generation_async(const std::string& resource_name, const std::string& api_version, const std::string& prompt, std::optional<uint8_t> n, std::optional<std::string> size) const & noexcept(false) {
-	return std::async(std::launch::async, &liboai::Azure::request_image_generation, this, resource_name, api_version, prompt, n, size);
+	return this->RequestImageGeneration(Asynchronous{}, resource_name, api_version, prompt, std::move(n), std::move(size));
 }
 
-liboai::Response liboai::Azure::get_generated_image(const std::string& resource_name, const std::string& api_version, const std::string& operation_id) const & noexcept(false) {
+template <class _Mode>
+typename _Mode::Result liboai::Azure::GetGeneratedImage(_Mode mode, const std::string& resource_name, const std::string& api_version, const std::string& operation_id) const {
 	netimpl::components::Parameters params;
 	params.Add({ "api-version", api_version });
 
-	Response res;
-	res = this->Request(
-		Method::HTTP_GET, ("https://" + resource_name + this->azure_root_), "/operations/images/" + operation_id, "application/json",
+	return this->Send(
+		mode, Method::HTTP_GET, ("https://" + resource_name + this->azure_root_), "/operations/images/" + operation_id, "application/json",
 		this->auth_.GetAzureAuthorizationHeaders(),
 		std::move(params),
 		this->auth_.GetProxies(),
 		this->auth_.GetProxyAuth(),
 		this->auth_.GetMaxTimeout()
 	);
+}
 
-	return res;
+liboai::Response liboai::Azure::get_generated_image(const std::string& resource_name, const std::string& api_version, const std::string& operation_id) const & noexcept(false) {
+	return this->GetGeneratedImage(Synchronous{}, resource_name, api_version, operation_id);
 }
 
 liboai::FutureResponse liboai::Azure::get_generated_image_async(const std::string& resource_name, const std::string& api_version, const std::string& operation_id) const & noexcept(false) {
-	return std::async(std::launch::async, &liboai::Azure::get_generated_image, this, resource_name, api_version, operation_id);
+	return this->GetGeneratedImage(Asynchronous{}, resource_name, api_version, operation_id);
 }
 
-liboai::Response liboai::Azure::delete_generated_image(const std::string& resource_name, const std::string& api_version, const std::string& operation_id) const & noexcept(false) {
+template <class _Mode>
+typename _Mode::Result liboai::Azure::DeleteGeneratedImage(_Mode mode, const std::string& resource_name, const std::string& api_version, const std::string& operation_id) const {
 	netimpl::components::Parameters params;
 	params.Add({ "api-version", api_version });
 
-	Response res;
-	res = this->Request(
-		Method::HTTP_DELETE, ("https://" + resource_name + this->azure_root_), "/operations/images/" + operation_id, "application/json",
+	return this->Send(
+		mode, Method::HTTP_DELETE, ("https://" + resource_name + this->azure_root_), "/operations/images/" + operation_id, "application/json",
 		this->auth_.GetAzureAuthorizationHeaders(),
 		std::move(params),
 		this->auth_.GetProxies(),
 		this->auth_.GetProxyAuth(),
 		this->auth_.GetMaxTimeout()
 	);
+}
 
-	return res;
+liboai::Response liboai::Azure::delete_generated_image(const std::string& resource_name, const std::string& api_version, const std::string& operation_id) const & noexcept(false) {
+	return this->DeleteGeneratedImage(Synchronous{}, resource_name, api_version, operation_id);
 }
 
 liboai::FutureResponse liboai::Azure::delete_generated_image_async(const std::string& resource_name, const std::string& api_version, const std::string& operation_id) const & noexcept(false) {
-	return std::async(std::launch::async, &liboai::Azure::delete_generated_image, this, resource_name, api_version, operation_id);
+	return this->DeleteGeneratedImage(Asynchronous{}, resource_name, api_version, operation_id);
 }
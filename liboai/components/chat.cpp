@@ -1,82 +1,116 @@
 #include "../include/components/chat.h"
 
-liboai::Conversation::Conversation() {
-	this->_conversation["messages"] = nlohmann::json::array();
-}
+liboai::Conversation::Conversation() {}
 
 liboai::Conversation::Conversation(const Conversation& other) {
-	this->_conversation = other._conversation;
+	this->_messages = other._messages;
+	this->_arena = other._arena;
+	this->_arena_garbage = other._arena_garbage;
+	this->_names = other._names;
+	this->_function_call = other._function_call;
 	this->_functions = other._functions;
 	this->_last_resp_is_fc = other._last_resp_is_fc;
+	this->_body_cache = other._body_cache;
+	this->_body_cache_ends = other._body_cache_ends;
 }
 
 liboai::Conversation::Conversation(Conversation&& old) noexcept {
-	this->_conversation = std::move(old._conversation);
+	this->_messages = std::move(old._messages);
+	this->_arena = std::move(old._arena);
+	this->_arena_garbage = old._arena_garbage;
+	this->_names = std::move(old._names);
+	this->_function_call = std::move(old._function_call);
 	this->_functions = std::move(old._functions);
 	this->_last_resp_is_fc = old._last_resp_is_fc;
-
-	old._conversation = nlohmann::json::object();
+	this->_body_cache = std::move(old._body_cache);
+	this->_body_cache_ends = std::move(old._body_cache_ends);
+
+	old._messages.clear();
+	old._arena.clear();
+	old._arena_garbage = 0;
+	old._body_cache.clear();
+	old._body_cache_ends.clear();
+	old._function_call = std::nullopt;
 	old._functions = nlohmann::json::object();
+	old._json_stale = true;
 }
 
 liboai::Conversation::Conversation(std::string_view system_data) {
-	this->_conversation["messages"] = nlohmann::json::array();
 	auto result = this->SetSystemData(system_data);
 }
 
 liboai::Conversation::Conversation(std::string_view system_data, std::string_view user_data) {
-	this->_conversation["messages"] = nlohmann::json::array();
 	auto result = this->SetSystemData(system_data);
 	result = this->AddUserData(user_data);
 }
 
 liboai::Conversation::Conversation(std::string_view system_data, std::initializer_list<std::string_view> user_data) {
-	this->_conversation["messages"] = nlohmann::json::array();
 	auto result = this->SetSystemData(system_data);
-	
+
 	for (auto& data : user_data) {
 		auto result = this->AddUserData(data);
 	}
 }
 
 liboai::Conversation::Conversation(std::initializer_list<std::string_view> user_data) {
-	this->_conversation["messages"] = nlohmann::json::array();
-
 	for (auto& data : user_data) {
 		auto result = this->AddUserData(data);
 	}
 }
 
 liboai::Conversation::Conversation(const std::vector<std::string>& user_data) {
-	this->_conversation["messages"] = nlohmann::json::array();
-	
 	for (auto& data : user_data) {
 		auto result = this->AddUserData(data);
 	}
 }
 
 liboai::Conversation& liboai::Conversation::operator=(const Conversation& other) {
-	this->_conversation = other._conversation;
+	this->_messages = other._messages;
+	this->_arena = other._arena;
+	this->_arena_garbage = other._arena_garbage;
+	this->_names = other._names;
+	this->_function_call = other._function_call;
 	this->_functions = other._functions;
 	this->_last_resp_is_fc = other._last_resp_is_fc;
+	this->_body_cache = other._body_cache;
+	this->_body_cache_ends = other._body_cache_ends;
+	this->_json_stale = true;
 	return *this;
 }
 
 liboai::Conversation& liboai::Conversation::operator=(Conversation&& old) noexcept {
-	this->_conversation = std::move(old._conversation);
+	this->_messages = std::move(old._messages);
+	this->_arena = std::move(old._arena);
+	this->_arena_garbage = old._arena_garbage;
+	this->_names = std::move(old._names);
+	this->_function_call = std::move(old._function_call);
 	this->_functions = std::move(old._functions);
 	this->_last_resp_is_fc = old._last_resp_is_fc;
-
-	old._conversation = nlohmann::json::object();
+	this->_body_cache = std::move(old._body_cache);
+	this->_body_cache_ends = std::move(old._body_cache_ends);
+	this->_json_stale = true;
+
+	old._messages.clear();
+	old._arena.clear();
+	old._arena_garbage = 0;
+	old._body_cache.clear();
+	old._body_cache_ends.clear();
+	old._function_call = std::nullopt;
 	old._functions = nlohmann::json::object();
+	old._json_stale = true;
 
 	return *this;
 }
 
 bool liboai::Conversation::ChangeFirstSystemMessage(std::string_view new_data) & noexcept(false) {
-	if (!new_data.empty() && !this->_conversation["messages"].empty()) {
-		if (this->_conversation["messages"][0]["role"].get<std::string>() == "system") {
-			this->_conversation["messages"][0]["content"] = new_data;
+	if (!new_data.empty() && !this->_messages.empty()) {
+		Message& first = this->_messages.front();
+		if (first.role == Role::System) {
+			this->Release(first.content);
+			first.content = this->Store(new_data);
+			first.content_kind = ContentKind::Text;
+			this->InvalidateBodyCache(0);
+			this->_json_stale = true;
 			return true; // System message changed successfuly
 		}
 		return false; // First message is not a system message
@@ -89,12 +123,12 @@ bool liboai::Conversation::SetSystemData(std::string_view data) & noexcept(false
 	if (!data.empty()) {
 		// if system is not set already - only one system message shall exist in any
 		// conversation
-		for (auto& message : this->_conversation["messages"].items()) {
-			if (message.value()["role"].get<std::string>() == "system") {
+		for (auto& message : this->_messages) {
+			if (message.role == Role::System) {
 				return false; // system already set
 			}
 		}
-		this->_conversation["messages"].push_back({ { "role", "system" }, {"content", data} });
+		this->PushMessage(Role::System, data);
 		return true; // system set successfully
 	}
 	return false; // data is empty
@@ -102,10 +136,10 @@ bool liboai::Conversation::SetSystemData(std::string_view data) & noexcept(false
 
 bool liboai::Conversation::PopSystemData() & noexcept(false) {
 	// if conversation is non-empty
-	if (!this->_conversation["messages"].empty()) {
+	if (!this->_messages.empty()) {
 		// if first message is system
-		if (this->_conversation["messages"][0]["role"].get<std::string>() == "system") {
-			this->_conversation["messages"].erase(0);
+		if (this->_messages.front().role == Role::System) {
+			this->EraseMessage(0);
 			return true; // system message popped successfully
 		}
 		return false; // first message is not system
@@ -114,14 +148,9 @@ bool liboai::Conversation::PopSystemData() & noexcept(false) {
 }
 
 void liboai::Conversation::EraseExtra() {
-	if (_conversation["messages"].size() > _max_history_size) {
+	if (this->_messages.size() > this->_max_history_size) {
 		// Ensure the system message is preserved
-		auto first_msg = _conversation["messages"].begin();
-		if (first_msg != _conversation["messages"].end() && (*first_msg)["role"].get<std::string>() == "system") {
-			_conversation["messages"].erase(first_msg + 1);
-		} else {
-			_conversation["messages"].erase(first_msg);
-		}
+		this->EraseMessage(this->_messages.front().role == Role::System ? 1 : 0);
 	}
 }
 
@@ -129,7 +158,7 @@ bool liboai::Conversation::AddUserData(std::string_view data) & noexcept(false)
 	// if data provided is non-empty
 	if (!data.empty()) {
 		EraseExtra();
-		this->_conversation["messages"].push_back({ { "role", "user" }, {"content", data} });
+		this->PushMessage(Role::User, data);
 		return true; // user data added successfully
 	}
 	return false; // data is empty
@@ -139,13 +168,8 @@ bool liboai::Conversation::AddUserData(std::string_view data, std::string_view n
 	// if data provided is non-empty
 	if (!data.empty()) {
 		EraseExtra();
-		this->_conversation["messages"].push_back(
-			{
-				{"role", "user"},
-				{"content", data},
-				{"name", name}
-			}
-		);
+		this->PushMessage(Role::User, data);
+		this->_messages.back().name = this->Intern(name);
 		return true; // user data added successfully
 	}
 	return false; // data is empty
@@ -153,10 +177,10 @@ bool liboai::Conversation::AddUserData(std::string_view data, std::string_view n
 
 bool liboai::Conversation::PopUserData() & noexcept(false) {
 	// if conversation is not empty
-	if (!this->_conversation["messages"].empty()) {
+	if (!this->_messages.empty()) {
 		// if last message is user message
-		if (this->_conversation["messages"].back()["role"].get<std::string>() == "user") {
-			this->_conversation["messages"].erase(this->_conversation["messages"].end() - 1);
+		if (this->_messages.back().role == Role::User) {
+			this->EraseMessage(this->_messages.size() - 1);
 			return true; // user data popped successfully
 		}
 		return false; // last message is not user message
@@ -166,10 +190,11 @@ bool liboai::Conversation::PopUserData() & noexcept(false) {
 
 std::string liboai::Conversation::GetLastResponse() const & noexcept {
 	// if conversation is not empty
-	if (!this->_conversation["messages"].empty()) {
+	if (!this->_messages.empty()) {
 		// if last message is from assistant
-		if (this->_conversation["messages"].back()["role"].get<std::string>() == "assistant") {
-			return this->_conversation["messages"].back()["content"].get<std::string>();
+		const Message& last = this->_messages.back();
+		if (last.role == Role::Assistant && last.content_kind == ContentKind::Text) {
+			return std::string(this->View(last.content));
 		}
 	}
 	return ""; // no response found
@@ -180,31 +205,27 @@ bool liboai::Conversation::LastResponseIsFunctionCall() const & noexcept {
 }
 
 std::string liboai::Conversation::GetLastFunctionCallName() const & noexcept(false) {
-	if (this->_conversation.contains("function_call")) {
-		if (this->_conversation["function_call"].contains("name")) {
-			return this->_conversation["function_call"]["name"].get<std::string>();
-		}
+	if (this->_function_call && this->_function_call->name) {
+		return this->_function_call->name.value();
 	}
 
 	return "";
 }
 
 std::string liboai::Conversation::GetLastFunctionCallArguments() const & noexcept(false) {
-	if (this->_conversation.contains("function_call")) {
-		if (this->_conversation["function_call"].contains("arguments")) {
-			return this->_conversation["function_call"]["arguments"].get<std::string>();
-		}
+	if (this->_function_call && this->_function_call->arguments) {
+		return this->_function_call->arguments.value();
 	}
-	
+
 	return "";
 }
 
 bool liboai::Conversation::PopLastResponse() & noexcept(false) {
 	// if conversation is not empty
-	if (!this->_conversation["messages"].empty()) {
+	if (!this->_messages.empty()) {
 		// if last message is assistant message
-		if (this->_conversation["messages"].back()["role"].get<std::string>() == "assistant") {
-			this->_conversation["messages"].erase(this->_conversation["messages"].end() - 1);
+		if (this->_messages.back().role == Role::Assistant) {
+			this->EraseMessage(this->_messages.size() - 1);
 			return true; // assistant data popped successfully
 		}
 		return false; // last message is not assistant message
@@ -213,175 +234,96 @@ bool liboai::Conversation::PopLastResponse() & noexcept(false) {
 }
 
 bool liboai::Conversation::Update(std::string_view response) & noexcept(false) {
-	// reset "last response is function call" flag
-	if (this->_last_resp_is_fc) {
-		if (this->_conversation.contains("function_call")) {
-			this->_conversation.erase("function_call");
-		}
-		this->_last_resp_is_fc = false;
-	}
-	
 	// if response is non-empty
 	if (!response.empty()) {
-		nlohmann::json j = nlohmann::json::parse(response);
-		if (j.contains("choices")) { // top level, several messages
-			for (auto& choice : j["choices"].items()) {
-				if (choice.value().contains("message")) {
-					if (choice.value()["message"].contains("role") && choice.value()["message"].contains("content")) {
-						if (!choice.value()["message"]["content"].is_null()) {
-							EraseExtra();
-							this->_conversation["messages"].push_back(
-								{
-									{ "role",    choice.value()["message"]["role"]    },
-									{ "content", choice.value()["message"]["content"] }
-								}
-							);
-						}
-						else {
-							EraseExtra();
-							this->_conversation["messages"].push_back(
-								{
-									{ "role",    choice.value()["message"]["role"]    },
-									{ "content", "" }
-								}
-							);
-						}
-						
-						if (choice.value()["message"].contains("function_call")) {
-							// if a function_call is present in the response, the
-							// conversation is not updated as there is no assistant
-							// response to be added. However, we do add the function
-							// information
-							
-							this->_conversation["function_call"] = nlohmann::json::object();
-							if (choice.value()["message"]["function_call"].contains("name")) {
-								this->_conversation["function_call"]["name"] = choice.value()["message"]["function_call"]["name"];
-							}
-							if (choice.value()["message"]["function_call"].contains("arguments")) {
-								this->_conversation["function_call"]["arguments"] = choice.value()["message"]["function_call"]["arguments"];
-							}
-							
-							this->_last_resp_is_fc = true;
-						}
+		return this->UpdateFromJSON(nlohmann::json::parse(response));
+	}
 
-						return true; // conversation updated successfully
-					}
-					else {
-						return false; // response is not valid
-					}
-				}
-				else {
-					return false; // no response found
-				}
-			}
-		}
-		else if (j.contains("message")) { // mid level, single message
-			if (j["message"].contains("role") && j["message"].contains("content")) {
-				if (j["message"]["content"].is_null()) {
-					EraseExtra();
-					this->_conversation["messages"].push_back(
-						{
-							{ "role",    j["message"]["role"]    },
-							{ "content", j["message"]["content"] }
-						}
-					);
-				}
-				else {
-					EraseExtra();
-					this->_conversation["messages"].push_back(
-						{
-							{ "role",    j["message"]["role"] },
-							{ "content", "" }
-						}
-					);
-				}
+	// reset "last response is function call" flag
+	this->ResetFunctionCall();
+	return false; // response is empty
+}
 
-				if (j["message"].contains("function_call")) {
-					// if a function_call is present in the response, the
-					// conversation is not updated as there is no assistant
-					// response to be added. However, we do add the function
-					// information
-					
-					this->_conversation["function_call"] = nlohmann::json::object();
-					if (j["message"]["function_call"].contains("name")) {
-						this->_conversation["function_call"]["name"] = j["message"]["function_call"]["name"];
-					}
-					if (j["message"]["function_call"].contains("arguments")) {
-						this->_conversation["function_call"]["arguments"] = j["message"]["function_call"]["arguments"];
-					}
+bool liboai::Conversation::Update(const Response& response) & noexcept(false) {
+	// use the response's own (possibly lazily parsed) JSON rather
+	// than parsing its content a second time
+	return this->UpdateFromJSON(response.GetJSON());
+}
 
-					this->_last_resp_is_fc = true;
-				}
+void liboai::Conversation::ResetFunctionCall() noexcept {
+	if (this->_last_resp_is_fc) {
+		this->_function_call = std::nullopt;
+		this->_last_resp_is_fc = false;
+		this->_json_stale = true;
+	}
+}
+
+bool liboai::Conversation::UpdateFromJSON(const nlohmann::json& j) {
+	// reset "last response is function call" flag
+	this->ResetFunctionCall();
 
-				return true; // conversation updated successfully
+	if (j.is_object()) {
+		const nlohmann::json* message = nullptr;
+		if (j.contains("choices")) { // top level, several messages
+			if (!j["choices"].is_array() || j["choices"].empty()) {
+				return false; // no choices found
 			}
-			else {
-				return false; // response is not valid
+			if (!j["choices"][0].contains("message")) {
+				return false; // no response found
 			}
+			message = &j["choices"][0]["message"];
+		}
+		else if (j.contains("message")) { // mid level, single message
+			message = &j["message"];
 		}
 		else if (j.contains("role") && j.contains("content")) { // low level, single message
-			if (j["message"]["content"].is_null()) {
-				EraseExtra();
-				this->_conversation["messages"].push_back(
-					{
-						{ "role",    j["message"]["role"]    },
-						{ "content", j["message"]["content"] }
-					}
-				);
-			}
-			else {
-				EraseExtra();
-				this->_conversation["messages"].push_back(
-					{
-						{ "role",    j["message"]["role"] },
-						{ "content", "" }
-					}
-				);
-			}
-			
-			if (j["message"].contains("function_call")) {
-				// if a function_call is present in the response, the
-				// conversation is not updated as there is no assistant
-				// response to be added. However, we do add the function
-				// information
-				this->_conversation["function_call"] = nlohmann::json::object();
-				if (j["message"]["function_call"].contains("name")) {
-					this->_conversation["function_call"]["name"] = j["message"]["function_call"]["name"];
-				}
-				if (j["message"]["function_call"].contains("arguments")) {
-					this->_conversation["function_call"]["arguments"] = j["message"]["function_call"]["arguments"];
-				}
-
-				this->_last_resp_is_fc = true;
-			}
-
-			return true; // conversation updated successfully
+			message = &j;
 		}
 		else {
 			return false; // invalid response
 		}
-	}
-	return false; // response is empty
-}
 
-bool liboai::Conversation::Update(const Response& response) & noexcept(false) {
-	return this->Update(response.content);
+		if (!message->contains("role") || !message->contains("content")) {
+			return false; // response is not valid
+		}
+
+		EraseExtra();
+		const nlohmann::json& content = (*message)["content"];
+		this->PushMessage(Role::User, content.is_string() ? content.get_ref<const std::string&>() : std::string_view());
+		this->SetRole(this->_messages.back(), (*message)["role"]);
+
+		if (message->contains("function_call")) {
+			// if a function_call is present in the response, the
+			// conversation is not updated as there is no assistant
+			// response to be added. However, we do add the function
+			// information
+			const nlohmann::json& function_call = (*message)["function_call"];
+
+			this->_function_call = FunctionCall{};
+			if (function_call.contains("name") && function_call["name"].is_string()) {
+				this->_function_call->name = function_call["name"].get<std::string>();
+			}
+			if (function_call.contains("arguments") && function_call["arguments"].is_string()) {
+				this->_function_call->arguments = function_call["arguments"].get<std::string>();
+			}
+
+			this->_last_resp_is_fc = true;
+		}
+
+		return true; // conversation updated successfully
+	}
+	return false; // response is not an object
 }
 
 std::string liboai::Conversation::Export() const & noexcept(false) {
 	nlohmann::json j;
-	
-	if (!this->_conversation.empty()) {
-		j["messages"] = this->_conversation["messages"];
+	j["messages"] = this->GetJSON()["messages"];
 
-		if (this->_functions) {
-			j["functions"] = this->_functions.value()["functions"];
-		}
-
-		return j.dump(4); // conversation exported successfully
+	if (this->_functions) {
+		j["functions"] = this->_functions.value()["functions"];
 	}
 
-	return ""; // conversation is empty
+	return j.dump(4); // conversation exported successfully
 }
 
 bool liboai::Conversation::Import(std::string_view json) & noexcept(false) {
@@ -389,7 +331,15 @@ bool liboai::Conversation::Import(std::string_view json) & noexcept(false) {
 		nlohmann::json j = nlohmann::json::parse(json);
 
 		if (j.contains("messages")) {
-			this->_conversation["messages"] = j["messages"];
+			this->_messages.clear();
+			this->_arena.clear();
+			this->_arena_garbage = 0;
+			this->InvalidateBodyCache(0);
+			this->_json_stale = true;
+
+			for (auto& message : j["messages"]) {
+				this->PushMessage(message);
+			}
 
 			if (j.contains("functions")) {
 				this->_functions = nlohmann::json();
@@ -398,10 +348,10 @@ bool liboai::Conversation::Import(std::string_view json) & noexcept(false) {
 
 			return true; // conversation imported successfully
 		}
-		
+
 		return false; // no messages found
 	}
-	
+
 	return false; // json is empty
 }
 
@@ -411,7 +361,7 @@ bool liboai::Conversation::AppendStreamData(std::string data) & noexcept(false)
 		bool completed = false;
 		return this->ParseStreamData(data, delta, completed);
 	}
-	
+
 	return false; // data is empty
 }
 
@@ -419,19 +369,19 @@ bool liboai::Conversation::AppendStreamData(std::string data, std::string& delta
 	if (!data.empty()) {
 		return this->ParseStreamData(data, delta, completed);
 	}
-	
+
 	return false;
 }
 
 
 bool liboai::Conversation::SetFunctions(Functions functions) & noexcept(false) {
 	nlohmann::json j = functions.GetJSON();
-	
+
 	if (!j.empty() && j.contains("functions") && j["functions"].size() > 0) {
 		this->_functions = std::move(j);
 		return true; // functions set successfully
 	}
-	
+
 	return false; // functions are empty
 }
 
@@ -440,11 +390,35 @@ void liboai::Conversation::PopFunctions() & noexcept(false) {
 }
 
 std::string liboai::Conversation::GetRawConversation() const & noexcept {
-	return this->_conversation.dump(4);
+	return this->GetJSON().dump(4);
 }
 
 const nlohmann::json& liboai::Conversation::GetJSON() const & noexcept {
-	return this->_conversation;
+	// the JSON form is only built when asked for, and then
+	// kept until the conversation next changes
+	if (this->_json_stale) {
+		nlohmann::json messages = nlohmann::json::array();
+		for (auto& message : this->_messages) {
+			messages.push_back(this->MessageJSON(message, true));
+		}
+
+		this->_json = nlohmann::json::object();
+		this->_json["messages"] = std::move(messages);
+
+		if (this->_function_call) {
+			this->_json["function_call"] = nlohmann::json::object();
+			if (this->_function_call->name) {
+				this->_json["function_call"]["name"] = this->_function_call->name.value();
+			}
+			if (this->_function_call->arguments) {
+				this->_json["function_call"]["arguments"] = this->_function_call->arguments.value();
+			}
+		}
+
+		this->_json_stale = false;
+	}
+
+	return this->_json;
 }
 
 std::string liboai::Conversation::GetRawFunctions() const & noexcept {
@@ -455,127 +429,348 @@ const nlohmann::json& liboai::Conversation::GetFunctionsJSON() const & noexcept
 	return this->_functions.value();
 }
 
-std::vector<std::string> liboai::Conversation::SplitStreamedData(std::string data) const noexcept(false) {
-	// remove all instances of the string "data: " from the string
-	this->RemoveStrings(data, "data: ");
+liboai::Conversation::Role liboai::Conversation::ParseRole(std::string_view role) noexcept {
+	if (role == "system")    { return Role::System; }
+	if (role == "user")      { return Role::User; }
+	if (role == "assistant") { return Role::Assistant; }
+	if (role == "function")  { return Role::Function; }
+	if (role == "tool")      { return Role::Tool; }
+	return Role::Other;
+}
 
-	/*
-		Splits the streamed data into a vector of strings
-		via delimiter of two newlines.
+std::string_view liboai::Conversation::RoleName(const Message& message) const noexcept {
+	switch (message.role) {
+		case Role::System:    return "system";
+		case Role::User:      return "user";
+		case Role::Assistant: return "assistant";
+		case Role::Function:  return "function";
+		case Role::Tool:      return "tool";
+		default:              return this->_names[message.role_name];
+	}
+}
 
-		For instance, a string of "Hello\n\nWorld" would
-		be split into a vector of {"Hello", "World"}, and
-		a string of "Hello World" would be split into
-		a vector of {"Hello World"}.
-	*/
-	if (!data.empty()) {
-		std::vector<std::string> split_data;
-		std::string temp;
-		std::istringstream iss(data);
-		while (std::getline(iss, temp)) {
-			if (temp.empty()) {
-				split_data.push_back(temp);
+void liboai::Conversation::SetRole(Message& message, const nlohmann::json& role) {
+	std::string_view name = role.is_string() ? std::string_view(role.get_ref<const std::string&>()) : std::string_view();
+	message.role = ParseRole(name);
+	message.role_name = message.role == Role::Other ? this->Intern(name) : Message::npos;
+	this->_json_stale = true;
+}
+
+uint32_t liboai::Conversation::Intern(std::string_view name) {
+	// names are few (roles, function and author names), so a
+	// linear search beats hashing
+	for (uint32_t i = 0; i < this->_names.size(); ++i) {
+		if (this->_names[i] == name) {
+			return i;
+		}
+	}
+
+	this->_names.emplace_back(name);
+	return static_cast<uint32_t>(this->_names.size() - 1);
+}
+
+liboai::Conversation::Span liboai::Conversation::Store(std::string_view data) {
+	Span span{ this->_arena.size(), data.size() };
+	this->_arena.append(data.data(), data.size());
+	return span;
+}
+
+void liboai::Conversation::Release(const Span& span) noexcept {
+	this->_arena_garbage += span.length;
+}
+
+void liboai::Conversation::AppendContent(Message& message, std::string_view delta) {
+	if (message.content_kind != ContentKind::Text) {
+		message.content = Span{ this->_arena.size(), 0 };
+		message.content_kind = ContentKind::Text;
+	}
+	else if (message.content.offset + message.content.length != this->_arena.size()) {
+		// something was stored after this message; move its content
+		// to the end of the arena so that it can grow in place
+		Span moved = this->Store(this->View(message.content));
+		this->Release(message.content);
+		message.content = moved;
+	}
+
+	this->_arena.append(delta.data(), delta.size());
+	message.content.length += delta.size();
+	this->_json_stale = true;
+}
+
+void liboai::Conversation::PushMessage(Role role, std::string_view content) {
+	Message message;
+	message.role = role;
+	message.content = this->Store(content);
+	this->_messages.push_back(std::move(message));
+	this->_json_stale = true;
+}
+
+void liboai::Conversation::PushMessage(const nlohmann::json& json) {
+	if (!json.is_object()) {
+		return; // not a message
+	}
+
+	Message message;
+	message.content_kind = ContentKind::Absent;
+	nlohmann::json extra = nlohmann::json::object();
+
+	for (auto& [key, value] : json.items()) {
+		if (key == "role" && value.is_string()) {
+			this->SetRole(message, value);
+		}
+		else if (key == "content" && value.is_string()) {
+			message.content = this->Store(value.get_ref<const std::string&>());
+			message.content_kind = ContentKind::Text;
+		}
+		else if (key == "content" && value.is_null()) {
+			message.content_kind = ContentKind::Null;
+		}
+		else if (key == "name" && value.is_string()) {
+			message.name = this->Intern(value.get_ref<const std::string&>());
+		}
+		else if (key == "function_call" && value.is_object() && value.size() == value.count("name") + value.count("arguments")
+			&& (!value.contains("name") || value["name"].is_string()) && (!value.contains("arguments") || value["arguments"].is_string())) {
+			message.has_function_call = true;
+			if (value.contains("name")) {
+				message.function_name = this->Intern(value["name"].get_ref<const std::string&>());
 			}
-			else {
-				split_data.push_back(temp);
+			if (value.contains("arguments")) {
+				message.function_arguments = this->Store(value["arguments"].get_ref<const std::string&>());
+				message.has_function_arguments = true;
 			}
 		}
+		else if (key == "tool_call_id" && value.is_string()) {
+			message.tool_call_id = this->Store(value.get_ref<const std::string&>());
+			message.has_tool_call_id = true;
+		}
+		else if (key == "pending" && value.is_boolean()) {
+			message.pending = value.get<bool>();
+		}
+		else {
+			// anything without a native slot (e.g. tool_calls or
+			// non-text content) is kept as-is
+			extra[key] = value;
+		}
+	}
+
+	if (!extra.empty()) {
+		message.extra = std::make_shared<const nlohmann::json>(std::move(extra));
+	}
+
+	this->_messages.push_back(std::move(message));
+	this->_json_stale = true;
+}
 
-		// remove empty strings from the vector
-		split_data.erase(std::remove_if(split_data.begin(), split_data.end(), [](const std::string& s) { return s.empty(); }), split_data.end());
+void liboai::Conversation::EraseMessage(size_t index) {
+	const Message& message = this->_messages[index];
+	this->Release(message.content);
+	this->Release(message.function_arguments);
+	this->Release(message.tool_call_id);
+	this->_messages.erase(this->_messages.begin() + index);
+	this->EraseFromBodyCache(index);
+	this->_json_stale = true;
 
-		return split_data;
+	// trimmed messages leave holes in the arena; reclaim them once
+	// they make up most of it so memory stays proportional to the
+	// live history
+	if (this->_arena_garbage > 4096 && this->_arena_garbage > this->_arena.size() / 2) {
+		this->CompactArena();
 	}
+}
+
+void liboai::Conversation::CompactArena() {
+	std::string arena;
+	arena.reserve(this->_arena.size() - this->_arena_garbage);
+
+	auto move = [&](Span& span) {
+		std::string_view data = this->View(span);
+		span.offset = arena.size();
+		arena.append(data.data(), data.size());
+	};
 
-	return {};
+	for (auto& message : this->_messages) {
+		move(message.content);
+		move(message.function_arguments);
+		move(message.tool_call_id);
+	}
+
+	this->_arena = std::move(arena);
+	this->_arena_garbage = 0;
 }
 
-void liboai::Conversation::RemoveStrings(std::string& s, std::string_view p) const noexcept(false) {
-	std::string::size_type i = s.find(p);
-	while (i != std::string::npos) {
-		s.erase(i, p.length());
-		i = s.find(p, i);
+nlohmann::json liboai::Conversation::MessageJSON(const Message& message, bool include_pending) const {
+	nlohmann::json j = message.extra ? *message.extra : nlohmann::json::object();
+
+	j["role"] = this->RoleName(message);
+	if (message.content_kind == ContentKind::Text) {
+		j["content"] = this->View(message.content);
+	}
+	else if (message.content_kind == ContentKind::Null) {
+		j["content"] = nullptr;
 	}
+	if (message.name != Message::npos) {
+		j["name"] = this->_names[message.name];
+	}
+	if (message.has_function_call) {
+		j["function_call"] = nlohmann::json::object();
+		if (message.function_name != Message::npos) {
+			j["function_call"]["name"] = this->_names[message.function_name];
+		}
+		if (message.has_function_arguments) {
+			j["function_call"]["arguments"] = this->View(message.function_arguments);
+		}
+	}
+	if (message.has_tool_call_id) {
+		j["tool_call_id"] = this->View(message.tool_call_id);
+	}
+	if (include_pending && message.pending) {
+		j["pending"] = true;
+	}
+
+	return j;
 }
 
-std::vector<std::string> liboai::Conversation::SplitFullStreamedData(std::string data) const noexcept(false) {
-	if (data.empty()) {
-		return {};
+void liboai::Conversation::SerializeMessage(std::string& out, const Message& message) const {
+	out += "{\"role\":";
+	JsonConstructor::write_string(out, this->RoleName(message));
+
+	if (message.content_kind == ContentKind::Text) {
+		out += ",\"content\":";
+		JsonConstructor::write_string(out, this->View(message.content));
 	}
-	
-	std::vector<std::string> split_data;
-	std::string temp;
-	std::istringstream iss(data);
-	while (std::getline(iss, temp)) {
-		if (temp.empty()) {
-			split_data.push_back(temp);
+	else if (message.content_kind == ContentKind::Null) {
+		out += ",\"content\":null";
+	}
+	if (message.name != Message::npos) {
+		out += ",\"name\":";
+		JsonConstructor::write_string(out, this->_names[message.name]);
+	}
+	if (message.has_function_call) {
+		out += ",\"function_call\":{";
+		if (message.function_name != Message::npos) {
+			out += "\"name\":";
+			JsonConstructor::write_string(out, this->_names[message.function_name]);
 		}
-		else {
-			split_data.push_back(temp);
+		if (message.has_function_arguments) {
+			out += message.function_name != Message::npos ? ",\"arguments\":" : "\"arguments\":";
+			JsonConstructor::write_string(out, this->View(message.function_arguments));
+		}
+		out.push_back('}');
+	}
+	if (message.has_tool_call_id) {
+		out += ",\"tool_call_id\":";
+		JsonConstructor::write_string(out, this->View(message.tool_call_id));
+	}
+	if (message.extra) {
+		for (auto& [key, value] : message.extra->items()) {
+			out.push_back(',');
+			JsonConstructor::write_string(out, key);
+			out.push_back(':');
+			out += value.dump();
 		}
 	}
 
-	// remove empty strings from the vector
-	split_data.erase(std::remove_if(split_data.begin(), split_data.end(), [](const std::string& s) { return s.empty(); }), split_data.end());
+	out.push_back('}');
+}
 
-	return split_data;
+std::string liboai::Conversation::SerializeMessages() const {
+	// extend the cached prefix with any messages settled since the
+	// last request; a message still being streamed is not cached
+	size_t settled = this->_body_cache_ends.size();
+	for (; settled < this->_messages.size() && !this->_messages[settled].pending; ++settled) {
+		if (settled > 0) {
+			this->_body_cache.push_back(',');
+		}
+		this->SerializeMessage(this->_body_cache, this->_messages[settled]);
+		this->_body_cache_ends.push_back(this->_body_cache.size());
+	}
+
+	std::string out;
+	out.reserve(this->_body_cache.size() + 2);
+	out.push_back('[');
+	out += this->_body_cache;
+	for (size_t i = settled; i < this->_messages.size(); ++i) {
+		if (i > 0) {
+			out.push_back(',');
+		}
+		this->SerializeMessage(out, this->_messages[i]);
+	}
+	out.push_back(']');
+
+	return out;
 }
 
-bool liboai::Conversation::ParseStreamData(std::string data, std::string& delta_content, bool& completed){
-	if (!_last_incomplete_buffer.empty()) {
-		data = _last_incomplete_buffer + data;
-		_last_incomplete_buffer.clear();
+void liboai::Conversation::InvalidateBodyCache(size_t index) noexcept {
+	if (index < this->_body_cache_ends.size()) {
+		this->_body_cache.resize(index > 0 ? this->_body_cache_ends[index - 1] : 0);
+		this->_body_cache_ends.resize(index);
 	}
+}
 
-	std::vector<std::string> data_lines = SplitFullStreamedData(data);
+void liboai::Conversation::EraseFromBodyCache(size_t index) {
+	size_t cached = this->_body_cache_ends.size();
+	if (index >= cached) {
+		return;
+	}
 
-	if (data_lines.empty()){
-		return false;
+	// cut the message out along with the comma separating it from
+	// its neighbour, then shift the offsets of those after it
+	size_t begin = index > 0 ? this->_body_cache_ends[index - 1] : 0;
+	size_t end = this->_body_cache_ends[index];
+	if (index == 0 && cached > 1) {
+		++end;
 	}
-	
+
+	size_t removed = end - begin;
+	this->_body_cache.erase(begin, removed);
+	this->_body_cache_ends.erase(this->_body_cache_ends.begin() + index);
+	for (size_t i = index; i < this->_body_cache_ends.size(); ++i) {
+		this->_body_cache_ends[i] -= removed;
+	}
+}
+
+bool liboai::Conversation::ParseStreamData(std::string data, std::string& delta_content, bool& completed){
+	// chunks may split events anywhere; the parser holds on to
+	// any partial event until the rest of it arrives
+	this->_stream_parser.Append(data);
+
 	// create an empty message at the end of the conversation,
 	// marked as "pending" to indicate that the response is
 	// still being processed. This flag will be removed once
 	// the response is processed. If the marking already
 	// exists, keep appending to the same message.
-	if (this->_conversation["messages"].empty() || !this->_conversation["messages"].back().contains("pending")) {
-		this->_conversation["messages"].push_back(
-			{
-				{ "role",    "" },
-				{ "content", "" },
-				{ "pending", true }
-			}
-		);
+	if (this->_messages.empty() || !this->_messages.back().pending) {
+		this->PushMessage(Role::Other, "");
+		this->_messages.back().role_name = this->Intern("");
+		this->_messages.back().pending = true;
 	}
 
-	for (auto& line : data_lines){
-		if (line.find("data: [DONE]") == std::string::npos) {
+	SseEvent event;
+	while (this->_stream_parser.Next(event)) {
+		if (event.data != "[DONE]") {
 			/*
 				j should have content in the form of:
 					{"id":"chatcmpl-7SKOck29emvbBbDS6cHg5xwnRrsLO","object":"chat.completion.chunk","created":1686985942,"model":"gpt-3.5-turbo-0613","choices":[{"index":0,"delta":{"content":"."},"finish_reason":null}]}
 				where "delta" may be empty
 			*/
-			this->RemoveStrings(line, "data: ");
-
-			nlohmann::json j;
-			try {
-				j = nlohmann::json::parse(line);
-			} catch (const std::exception& e) {
-				_last_incomplete_buffer = line;
-				continue;
+			nlohmann::json j = liboai::JsonParser::Parse(event.data, false);
+			if (j.is_discarded()) {
+				continue; // not a JSON event - skip it
 			}
 
 			if (j.contains("choices")) {
 				if (j["choices"][0].contains("delta")) {
 					if (!j["choices"][0]["delta"].empty() && !j["choices"][0]["delta"].is_null()) {
 						if (j["choices"][0]["delta"].contains("role")) {
-							this->_conversation["messages"].back()["role"] = j["choices"][0]["delta"]["role"];
+							this->SetRole(this->_messages.back(), j["choices"][0]["delta"]["role"]);
 						}
 
 						if (j["choices"][0]["delta"].contains("content")) {
-							if (!j["choices"][0]["delta"]["content"].empty() && !j["choices"][0]["delta"]["content"].is_null()) {
-								std::string stream_content =  j["choices"][0]["delta"]["content"].get<std::string>();
-								this->_conversation["messages"].back()["content"] = this->_conversation["messages"].back()["content"].get<std::string>() + stream_content;
+							if (j["choices"][0]["delta"]["content"].is_string()) {
+								// appended in place at the end of the arena, so
+								// streaming a long response stays linear
+								const std::string& stream_content = j["choices"][0]["delta"]["content"].get_ref<const std::string&>();
+								this->AppendContent(this->_messages.back(), stream_content);
 								delta_content += stream_content;
 							}
 
@@ -584,33 +779,34 @@ bool liboai::Conversation::ParseStreamData(std::string data, std::string& delta_
 							// previously set function_call field in the
 							// conversation
 							if (this->_last_resp_is_fc) {
-								if (this->_conversation.contains("function_call")) {
-									this->_conversation.erase("function_call");
-								}
+								this->_function_call = std::nullopt;
 								this->_last_resp_is_fc = false;
 							}
 						}
 
 						if (j["choices"][0]["delta"].contains("function_call")) {
-							if (!j["choices"][0]["delta"]["function_call"].empty() && !j["choices"][0]["delta"]["function_call"].is_null()) {
-								if (j["choices"][0]["delta"]["function_call"].contains("name")) {
-									if (!j["choices"][0]["delta"]["function_call"]["name"].empty() && !j["choices"][0]["delta"]["function_call"]["name"].is_null()) {
-										if (!this->_conversation["messages"].back().contains("function_call")) {
-											this->_conversation["function_call"] = { { "name", j["choices"][0]["delta"]["function_call"]["name"] } };
-											this->_last_resp_is_fc = true;
-										}
+							const nlohmann::json& function_call = j["choices"][0]["delta"]["function_call"];
+							if (!function_call.empty() && !function_call.is_null()) {
+								if (function_call.contains("name")) {
+									if (function_call["name"].is_string()) {
+										this->_function_call = FunctionCall{ function_call["name"].get<std::string>(), std::nullopt };
+										this->_last_resp_is_fc = true;
 									}
 								}
-								else if (j["choices"][0]["delta"]["function_call"].contains("arguments")) {
-									if (!j["choices"][0]["delta"]["function_call"]["arguments"].empty() && !j["choices"][0]["delta"]["function_call"]["arguments"].is_null()) {
-										if (!this->_conversation["function_call"].contains("arguments")) {
-											this->_conversation["function_call"].push_back({ "arguments", j["choices"][0]["delta"]["function_call"]["arguments"] });
+								else if (function_call.contains("arguments")) {
+									if (function_call["arguments"].is_string()) {
+										if (!this->_function_call) {
+											this->_function_call = FunctionCall{};
+										}
+										if (!this->_function_call->arguments) {
+											this->_function_call->arguments = function_call["arguments"].get<std::string>();
 										}
 										else {
-											this->_conversation["function_call"]["arguments"] = this->_conversation["function_call"]["arguments"].get<std::string>() + j["choices"][0]["delta"]["function_call"]["arguments"].get<std::string>();
+											this->_function_call->arguments->append(function_call["arguments"].get_ref<const std::string&>());
 										}
 									}
 								}
+								this->_json_stale = true;
 							}
 						}
 					}
@@ -620,8 +816,11 @@ bool liboai::Conversation::ParseStreamData(std::string data, std::string& delta_
 			}
 		} else {
 			// the response is complete, erase the "pending" flag
-			this->_conversation["messages"].back().erase("pending");
+			this->_messages.back().pending = false;
+			this->_json_stale = true;
+			this->_stream_parser.Reset();
 			completed = true;
+			break;
 		}
 	}
 
@@ -630,7 +829,98 @@ bool liboai::Conversation::ParseStreamData(std::string data, std::string& delta_
 
 
 
-liboai::Response liboai::ChatCompletion::create(const std::string& model, Conversation& conversation, std::optional<std::string> function_call, std::optional<float> temperature, std::optional<float> top_p, std::optional<uint16_t> n, std::optional<ChatStreamCallback> stream, std::optional<std::vector<std::string>> stop, std::optional<uint16_t> max_tokens, std::optional<float> presence_penalty, std::optional<float> frequency_penalty, std::optional<std::unordered_map<std::string, int8_t>> logit_bias, std::optional<std::string> user) const& noexcept(false) {
+namespace {
+	class ChatCompletionReader final : public liboai::SaxReader {
+		public:
+			explicit ChatCompletionReader(liboai::ChatCompletionResult& result) : result_(result) {}
+
+		protected:
+			void OnEnter(bool array) override {
+				if (array) {
+					return;
+				}
+
+				if (this->At({ "choices", "#" })) {
+					this->result_.choices.emplace_back();
+				}
+				else if (this->At({ "choices", "#", "message", "tool_calls", "#" })) {
+					this->Message().tool_calls.emplace_back();
+				}
+				else if (this->At({ "choices", "#", "message", "function_call" })) {
+					this->Message().function_call.emplace();
+				}
+			}
+
+			void OnString(std::string& value) override {
+				if (this->Depth() == 1) {
+					std::string_view key = this->Key();
+					if (key == "id")                      { this->result_.id = std::move(value); }
+					else if (key == "object")             { this->result_.object = std::move(value); }
+					else if (key == "model")              { this->result_.model = std::move(value); }
+					else if (key == "system_fingerprint") { this->result_.system_fingerprint = std::move(value); }
+				}
+				else if (this->At({ "choices", "#", "finish_reason" })) {
+					this->result_.choices.back().finish_reason = std::move(value);
+				}
+				else if (this->At({ "choices", "#", "message", "role" })) {
+					this->Message().role = std::move(value);
+				}
+				else if (this->At({ "choices", "#", "message", "content" })) {
+					this->Message().content = std::move(value);
+				}
+				else if (this->At({ "choices", "#", "message", "function_call", "*" })) {
+					this->Field(*this->Message().function_call, value);
+				}
+				else if (this->At({ "choices", "#", "message", "tool_calls", "#", "id" })) {
+					this->Message().tool_calls.back().id = std::move(value);
+				}
+				else if (this->At({ "choices", "#", "message", "tool_calls", "#", "type" })) {
+					this->Message().tool_calls.back().type = std::move(value);
+				}
+				else if (this->At({ "choices", "#", "message", "tool_calls", "#", "function", "*" })) {
+					this->Field(this->Message().tool_calls.back().function, value);
+				}
+			}
+
+			void OnNumber(double value) override {
+				if (this->At({ "created" })) {
+					this->result_.created = static_cast<int64_t>(value);
+				}
+				else if (this->At({ "choices", "#", "index" })) {
+					this->result_.choices.back().index = static_cast<uint32_t>(value);
+				}
+				else {
+					this->ReadUsage(this->result_.usage, value);
+				}
+			}
+
+		private:
+			liboai::ChatCompletionResult::Message& Message() {
+				return this->result_.choices.back().message;
+			}
+
+			void Field(liboai::ChatCompletionResult::FunctionCall& function, std::string& value) {
+				if (this->Key() == "name") {
+					function.name = std::move(value);
+				}
+				else if (this->Key() == "arguments") {
+					function.arguments = std::move(value);
+				}
+			}
+
+			liboai::ChatCompletionResult& result_;
+	};
+}
+
+liboai::ChatCompletionResult liboai::ChatCompletionResult::Parse(std::string_view json) noexcept(false) {
+	ChatCompletionResult result;
+	ChatCompletionReader reader(result);
+	reader.Parse(json);
+	return result;
+}
+
+template <class _Mode>
+typename _Mode::Result liboai::ChatCompletion::Create(_Mode mode, const std::string& model, Conversation& conversation, std::optional<std::string> function_call, std::optional<float> temperature, std::optional<float> top_p, std::optional<uint16_t> n, std::optional<ChatStreamCallback> stream, std::optional<std::vector<std::string>> stop, std::optional<uint16_t> max_tokens, std::optional<float> presence_penalty, std::optional<float> frequency_penalty, std::optional<std::unordered_map<std::string, int8_t>> logit_bias, std::optional<std::string> user) const {
 	liboai::JsonConstructor jcon;
 	jcon.push_back("model", model);
 	jcon.push_back("temperature", std::move(temperature));
@@ -664,32 +954,31 @@ liboai::Response liboai::ChatCompletion::create(const std::string& model, Conver
 		jcon.push_back("stream", _sscb);
 	}
 
-	if (conversation.GetJSON().contains("messages")) {
-		jcon.push_back("messages", conversation.GetJSON()["messages"]);
-	}
+	jcon.push_back_raw("messages", conversation.SerializeMessages());
 	
 	if (conversation.HasFunctions()) {
 		jcon.push_back("functions", conversation.GetFunctionsJSON()["functions"]);
 	}
 
-	Response res;
-	res = this->Request(
-		Method::HTTP_POST, this->openai_root_, "/chat/completions", "application/json",
+	return this->Send(
+		mode, Method::HTTP_POST, this->openai_root_, "/chat/completions", "application/json",
 		this->auth_.GetAuthorizationHeaders(),
 		netimpl::components::Body {
-			jcon.dump()
+			jcon.release()
 		},
 		_sscb ? netimpl::components::WriteCallback{std::move(_sscb)} : netimpl::components::WriteCallback{},
 		this->auth_.GetProxies(),
 		this->auth_.GetProxyAuth(),
 		this->auth_.GetMaxTimeout()
 	);
+}
 
-	return res;
+liboai::Response liboai::ChatCompletion::create(const std::string& model, Conversation& conversation, std::optional<std::string> function_call, std::optional<float> temperature, std::optional<float> top_p, std::optional<uint16_t> n, std::optional<ChatStreamCallback> stream, std::optional<std::vector<std::string>> stop, std::optional<uint16_t> max_tokens, std::optional<float> presence_penalty, std::optional<float> frequency_penalty, std::optional<std::unordered_map<std::string, int8_t>> logit_bias, std::optional<std::string> user) const& noexcept(false) {
+	return this->Create(Synchronous{}, model, conversation, std::move(function_call), std::move(temperature), std::move(top_p), std::move(n), std::move(stream), std::move(stop), std::move(max_tokens), std::move(presence_penalty), std::move(frequency_penalty), std::move(logit_bias), std::move(user));
 }
 
 liboai::FutureResponse liboai::ChatCompletion::create_async(const std::string& model, Conversation& conversation, std::optional<std::string> function_call, std::optional<float> temperature, std::optional<float> top_p, std::optional<uint16_t> n, std::optional<ChatStreamCallback> stream, std::optional<std::vector<std::string>> stop, std::optional<uint16_t> max_tokens, std::optional<float> presence_penalty, std::optional<float> frequency_penalty, std::optional<std::unordered_map<std::string, int8_t>> logit_bias, std::optional<std::string> user) const& noexcept(false) {
-	return std::async(std::launch::async, &liboai::ChatCompletion::create, this, model, std::ref(conversation), function_call, temperature, top_p, n, stream, stop, max_tokens, presence_penalty, frequency_penalty, logit_bias, user);
+	return this->Create(Asynchronous{}, model, conversation, std::move(function_call), std::move(temperature), std::move(top_p), std::move(n), std::move(stream), std::move(stop), std::move(max_tokens), std::move(presence_penalty), std::move(frequency_penalty), std::move(logit_bias), std::move(user));
 }
 
 namespace liboai {
@@ -1,6 +1,7 @@
 #include "../include/components/completions.h"
 
-liboai::Response liboai::Completions::create(const std::string& model_id, std::optional<std::string> prompt, std::optional<std::string> suffix, std::optional<uint16_t> max_tokens, std::optional<float> temperature, std::optional<float> top_p, std::optional<uint16_t> n, std::optional<std::function<bool(std::string, intptr_t)>> stream, std::optional<uint8_t> logprobs, std::optional<bool> echo, std::optional<std::vector<std::string>> stop, std::optional<float> presence_penalty, std::optional<float> frequency_penalty, std::optional<uint16_t> best_of, std::optional<std::unordered_map<std::string, int8_t>> logit_bias, std::optional<std::string> user) const & noexcept(false) {
+template <class _Mode>
+typename _Mode::Result liboai::Completions::Create(_Mode mode, const std::string& model_id, std::optional<std::string> prompt, std::optional<std::string> suffix, std::optional<uint16_t> max_tokens, std::optional<float> temperature, std::optional<float> top_p, std::optional<uint16_t> n, std::optional<std::function<bool(std::string, intptr_t)>> stream, std::optional<uint8_t> logprobs, std::optional<bool> echo, std::optional<std::vector<std::string>> stop, std::optional<float> presence_penalty, std::optional<float> frequency_penalty, std::optional<uint16_t> best_of, std::optional<std::unordered_map<std::string, int8_t>> logit_bias, std::optional<std::string> user) const {
 	liboai::JsonConstructor jcon;
 	jcon.push_back("model", model_id);
 	jcon.push_back("prompt", std::move(prompt));
@@ -19,22 +20,23 @@ liboai::Response liboai::Completions::create(const std::string& model_id, std::o
 	jcon.push_back("logit_bias", std::move(logit_bias));
 	jcon.push_back("user", std::move(user));
 
-	Response res;
-	res = this->Request(
-		Method::HTTP_POST, this->openai_root_, "/completions", "application/json",
+	return this->Send(
+		mode, Method::HTTP_POST, this->openai_root_, "/completions", "application/json",
 		this->auth_.GetAuthorizationHeaders(),
 		netimpl::components::Body {
-			jcon.dump()
+			jcon.release()
 		},
-		stream ? netimpl::components::WriteCallback{std::move(stream.value())} : netimpl::components::WriteCallback{},
+		stream ? SseParser::Framed(std::move(stream.value())) : netimpl::components::WriteCallback{},
 		this->auth_.GetProxies(),
 		this->auth_.GetProxyAuth(),
 		this->auth_.GetMaxTimeout()
 	);
+}
 
-	return res;
+liboai::Response liboai::Completions::create(const std::string& model_id, std::optional<std::string> prompt, std::optional<std::string> suffix, std::optional<uint16_t> max_tokens, std::optional<float> temperature, std::optional<float> top_p, std::optional<uint16_t> n, std::optional<std::function<bool(std::string, intptr_t)>> stream, std::optional<uint8_t> logprobs, std::optional<bool> echo, std::optional<std::vector<std::string>> stop, std::optional<float> presence_penalty, std::optional<float> frequency_penalty, std::optional<uint16_t> best_of, std::optional<std::unordered_map<std::string, int8_t>> logit_bias, std::optional<std::string> user) const & noexcept(false) {
+	return this->Create(Synchronous{}, model_id, std::move(prompt), std::move(suffix), std::move(max_tokens), std::move(temperature), std::move(top_p), std::move(n), std::move(stream), std::move(logprobs), std::move(echo), std::move(stop), std::move(presence_penalty), std::move(frequency_penalty), std::move(best_of), std::move(logit_bias), std::move(user));
 }
 
 liboai::FutureResponse liboai::Completions::create_async(const std::string& model_id, std::optional<std::string> prompt, std::optional<std::string> suffix, std::optional<uint16_t> max_tokens, std::optional<float> temperature, std::optional<float> top_p, std::optional<uint16_t> n, std::optional<std::function<bool(std::string, intptr_t)>> stream, std::optional<uint8_t> logprobs, std::optional<bool> echo, std::optional<std::vector<std::string>> stop, std::optional<float> presence_penalty, std::optional<float> frequency_penalty, std::optional<uint16_t> best_of, std::optional<std::unordered_map<std::string, int8_t>> logit_bias, std::optional<std::string> user) const & noexcept(false) {
-	return std::async(std::launch::async, &liboai::Completions::create, this, model_id, prompt, suffix, max_tokens, temperature, top_p, n, stream, logprobs, echo, stop, presence_penalty, frequency_penalty, best_of, logit_bias, user);
+	return this->Create(Asynchronous{}, model_id, std::move(prompt), std::move(suffix), std::move(max_tokens), std::move(temperature), std::move(top_p), std::move(n), std::move(stream), std::move(logprobs), std::move(echo), std::move(stop), std::move(presence_penalty), std::move(frequency_penalty), std::move(best_of), std::move(logit_bias), std::move(user));
 }
@@ -1,6 +1,7 @@
 #include "../include/components/edits.h"
 
-liboai::Response liboai::Edits::create(const std::string& model_id, std::optional<std::string> input, std::optional<std::string> instruction, std::optional<uint16_t> n, std::optional<float> temperature, std::optional<float> top_p) const & noexcept(false) {
+template <class _Mode>
+typename _Mode::Result liboai::Edits::Create(_Mode mode, const std::string& model_id, std::optional<std::string> input, std::optional<std::string> instruction, std::optional<uint16_t> n, std::optional<float> temperature, std::optional<float> top_p) const {
 	liboai::JsonConstructor jcon;
 	jcon.push_back("model", model_id);
 	jcon.push_back("input", std::move(input));
@@ -9,21 +10,22 @@ liboai::Response liboai::Edits::create(const std::string& model_id, std::optiona
 	jcon.push_back("temperature", std::move(temperature));
 	jcon.push_back("top_p", std::move(top_p));
 
-	Response res;
-	res = this->Request(
-		Method::HTTP_POST, this->openai_root_, "/edits", "application/json",
+	return this->Send(
+		mode, Method::HTTP_POST, this->openai_root_, "/edits", "application/json",
 		this->auth_.GetAuthorizationHeaders(),
 		netimpl::components::Body {
-			jcon.dump()
+			jcon.release()
 		},
 		this->auth_.GetProxies(),
 		this->auth_.GetProxyAuth(),
 		this->auth_.GetMaxTimeout()
 	);
+}
 
-	return res;
+liboai::Response liboai::Edits::create(const std::string& model_id, std::optional<std::string> input, std::optional<std::string> instruction, std::optional<uint16_t> n, std::optional<float> temperature, std::optional<float> top_p) const & noexcept(false) {
+	return this->Create(Synchronous{}, model_id, std::move(input), std::move(instruction), std::move(n), std::move(temperature), std::move(top_p));
 }
 
 liboai::FutureResponse liboai::Edits::create_async(const std::string& model_id, std::optional<std::string> input, std::optional<std::string> instruction, std::optional<uint16_t> n, std::optional<float> temperature, std::optional<float> top_p) const & noexcept(false) {
-	return std::async(std::launch::async, &liboai::Edits::create, this, model_id, input, instruction, n, temperature, top_p);
+	return this->Create(Asynchronous{}, model_id, std::move(input), std::move(instruction), std::move(n), std::move(temperature), std::move(top_p));
 }
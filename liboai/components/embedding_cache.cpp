@@ -0,0 +1,422 @@
+#include "../include/components/embedding_cache.h"
+#include "../include/core/hash.h"
+#include <cstring>
+
+#if defined(_WIN32)
+	#ifndef WIN32_LEAN_AND_MEAN
+		#define WIN32_LEAN_AND_MEAN
+	#endif
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/file.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif
+
+namespace {
+	constexpr char kMagic[8] = { 'L', 'I', 'B', 'O', 'A', 'I', 'E', 'C' };
+	constexpr uint32_t kVersion = 1;
+	constexpr uint32_t kByteOrder = 0x01020304;
+	constexpr uint32_t kRecordMagic = 0x4345524C; // "LREC"
+	constexpr uint64_t kAlignment = 64;
+	constexpr uint64_t kMinCapacity = 1 << 20;
+
+	struct FileHeader {
+		char magic[8];
+		uint32_t version;
+		uint32_t byte_order;
+		uint8_t reserved[48];
+	};
+
+	/*
+		Each record is a header followed by its values, padded so
+		that every record - and so every vector - starts on a
+		64-byte boundary of the mapping.
+	*/
+	struct RecordHeader {
+		uint32_t magic;
+		uint32_t count;
+		uint64_t key[2];
+		uint64_t checksum; // of the values, seeded with the key
+		uint8_t reserved[32];
+	};
+
+	static_assert(sizeof(FileHeader) == kAlignment, "file header must keep records aligned");
+	static_assert(sizeof(RecordHeader) == kAlignment, "record header must keep vectors aligned");
+
+	uint64_t RecordSize(uint64_t count) noexcept {
+		return sizeof(RecordHeader) + (count * sizeof(float) + kAlignment - 1) / kAlignment * kAlignment;
+	}
+
+	uint64_t Checksum(const uint64_t key[2], const float* values, uint32_t count) noexcept {
+		uint64_t hash[2];
+		liboai::Hash::Murmur3(values, count * sizeof(float), key[0] ^ key[1] ^ count, hash);
+		return hash[0];
+	}
+
+	[[noreturn]] void Fail(const std::string& what) {
+		throw liboai::exception::OpenAIException(
+			what,
+			liboai::exception::EType::E_FILEERROR,
+			"liboai::EmbeddingCache"
+		);
+	}
+}
+
+/*
+	The platform file and mapping handles. The mapping is always
+	of the whole file, which is grown in large steps ahead of the
+	records and trimmed back to them when the cache is closed.
+*/
+struct liboai::EmbeddingCache::File {
+	#if defined(_WIN32)
+		HANDLE file = INVALID_HANDLE_VALUE, mapping = nullptr;
+
+		void Open(const std::filesystem::path& path) {
+			// no sharing: one process writes a cache at a time
+			this->file = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (this->file == INVALID_HANDLE_VALUE) {
+				Fail("Failed to open embedding cache " + path.string() + "; it may already be in use");
+			}
+		}
+
+		uint64_t Size() const {
+			LARGE_INTEGER size;
+			if (!GetFileSizeEx(this->file, &size)) {
+				Fail("Failed to read embedding cache size");
+			}
+			return static_cast<uint64_t>(size.QuadPart);
+		}
+
+		void Resize(uint64_t size) {
+			LARGE_INTEGER position;
+			position.QuadPart = static_cast<LONGLONG>(size);
+			if (!SetFilePointerEx(this->file, position, nullptr, FILE_BEGIN) || !SetEndOfFile(this->file)) {
+				Fail("Failed to resize embedding cache");
+			}
+		}
+
+		uint8_t* Map(uint64_t size) {
+			this->mapping = CreateFileMappingW(this->file, nullptr, PAGE_READWRITE, static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), nullptr);
+			void* view = this->mapping ? MapViewOfFile(this->mapping, FILE_MAP_ALL_ACCESS, 0, 0, static_cast<SIZE_T>(size)) : nullptr;
+			if (!view) {
+				Fail("Failed to map embedding cache");
+			}
+			return static_cast<uint8_t*>(view);
+		}
+
+		void Unmap(uint8_t* map, uint64_t size) noexcept {
+			if (map) {
+				UnmapViewOfFile(map);
+			}
+			if (this->mapping) {
+				CloseHandle(this->mapping);
+				this->mapping = nullptr;
+			}
+		}
+
+		void Sync(uint8_t* map, uint64_t size) {
+			if ((map && !FlushViewOfFile(map, static_cast<SIZE_T>(size))) || !FlushFileBuffers(this->file)) {
+				Fail("Failed to flush embedding cache");
+			}
+		}
+
+		void Close() noexcept {
+			if (this->file != INVALID_HANDLE_VALUE) {
+				CloseHandle(this->file);
+				this->file = INVALID_HANDLE_VALUE;
+			}
+		}
+	#else
+		int fd = -1;
+
+		void Open(const std::filesystem::path& path) {
+			this->fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+			if (this->fd < 0) {
+				Fail("Failed to open embedding cache " + path.string());
+			}
+
+			// one process writes a cache at a time
+			if (::flock(this->fd, LOCK_EX | LOCK_NB) != 0) {
+				this->Close();
+				Fail("Embedding cache " + path.string() + " is already in use");
+			}
+		}
+
+		uint64_t Size() const {
+			struct stat info;
+			if (::fstat(this->fd, &info) != 0) {
+				Fail("Failed to read embedding cache size");
+			}
+			return static_cast<uint64_t>(info.st_size);
+		}
+
+		void Resize(uint64_t size) {
+			if (::ftruncate(this->fd, static_cast<off_t>(size)) != 0) {
+				Fail("Failed to resize embedding cache");
+			}
+		}
+
+		uint8_t* Map(uint64_t size) {
+			void* map = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, this->fd, 0);
+			if (map == MAP_FAILED) {
+				Fail("Failed to map embedding cache");
+			}
+			return static_cast<uint8_t*>(map);
+		}
+
+		void Unmap(uint8_t* map, uint64_t size) noexcept {
+			if (map) {
+				::munmap(map, size);
+			}
+		}
+
+		void Sync(uint8_t* map, uint64_t size) {
+			if ((map && ::msync(map, size, MS_SYNC) != 0) || ::fsync(this->fd) != 0) {
+				Fail("Failed to flush embedding cache");
+			}
+		}
+
+		void Close() noexcept {
+			if (this->fd >= 0) {
+				::close(this->fd);
+				this->fd = -1;
+			}
+		}
+	#endif
+};
+
+liboai::EmbeddingCache::EmbeddingCache(const std::filesystem::path& path) noexcept(false) : file_(std::make_unique<File>()) {
+	this->file_->Open(path);
+
+	try {
+		uint64_t size = this->file_->Size();
+		if (size == 0) {
+			this->file_->Resize(kMinCapacity);
+			this->map_ = this->file_->Map(kMinCapacity);
+			this->capacity_ = kMinCapacity;
+
+			FileHeader header{};
+			std::memcpy(header.magic, kMagic, sizeof(kMagic));
+			header.version = kVersion;
+			header.byte_order = kByteOrder;
+			std::memcpy(this->map_, &header, sizeof(header));
+			this->end_ = sizeof(FileHeader);
+		}
+		else {
+			if (size < sizeof(FileHeader)) {
+				Fail(path.string() + " is not an embedding cache");
+			}
+
+			this->map_ = this->file_->Map(size);
+			this->capacity_ = size;
+
+			FileHeader header;
+			std::memcpy(&header, this->map_, sizeof(header));
+			if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion) {
+				Fail(path.string() + " is not an embedding cache");
+			}
+			if (header.byte_order != kByteOrder) {
+				Fail(path.string() + " was written on a machine of different byte order");
+			}
+
+			this->Recover();
+		}
+	}
+	catch (...) {
+		this->file_->Unmap(this->map_, this->capacity_);
+		this->file_->Close();
+		throw;
+	}
+}
+
+liboai::EmbeddingCache::~EmbeddingCache() {
+	this->file_->Unmap(this->map_, this->capacity_);
+	try {
+		// drop the unused space reserved past the last record
+		if (this->end_ != 0) {
+			this->file_->Resize(this->end_);
+		}
+	}
+	catch (...) {}
+	this->file_->Close();
+}
+
+void liboai::EmbeddingCache::Recover() {
+	uint64_t offset = sizeof(FileHeader);
+	while (offset + sizeof(RecordHeader) <= this->capacity_) {
+		RecordHeader header;
+		std::memcpy(&header, this->map_ + offset, sizeof(header));
+		if (header.magic != kRecordMagic || header.count == 0 || offset + RecordSize(header.count) > this->capacity_) {
+			break;
+		}
+
+		const float* values = reinterpret_cast<const float*>(this->map_ + offset + sizeof(RecordHeader));
+		if (Checksum(header.key, values, header.count) != header.checksum) {
+			break;
+		}
+
+		Key key{ { header.key[0], header.key[1] } };
+		if (this->Find(key) == 0) {
+			this->Insert(key, offset);
+		}
+		offset += RecordSize(header.count);
+	}
+	this->end_ = offset;
+
+	// anything past the last intact record was reserved but never
+	// written, or was cut short by a crash; clear the latter so it
+	// cannot be mistaken for a record once new ones are appended
+	if (offset + sizeof(uint32_t) <= this->capacity_) {
+		uint32_t magic;
+		std::memcpy(&magic, this->map_ + offset, sizeof(magic));
+		if (magic != 0) {
+			std::memset(this->map_ + offset, 0, this->capacity_ - offset);
+		}
+	}
+}
+
+void liboai::EmbeddingCache::Reserve(uint64_t size) {
+	if (size <= this->capacity_) {
+		return;
+	}
+
+	uint64_t capacity = std::max({ size, this->capacity_ * 2, kMinCapacity });
+	this->file_->Unmap(this->map_, this->capacity_);
+	this->map_ = nullptr;
+	this->capacity_ = 0;
+
+	this->file_->Resize(capacity);
+	this->map_ = this->file_->Map(capacity);
+	this->capacity_ = capacity;
+}
+
+liboai::EmbeddingCache::Key liboai::EmbeddingCache::KeyOf(std::string_view model, uint32_t dimensions, std::string_view input) {
+	std::string data;
+	data.reserve(model.size() + sizeof(dimensions) + input.size() + 1);
+	data.append(model.data(), model.size());
+	data.push_back('\0');
+	data.append(reinterpret_cast<const char*>(&dimensions), sizeof(dimensions));
+	data.append(input.data(), input.size());
+
+	Key key;
+	liboai::Hash::Murmur3(data.data(), data.size(), 0, key.hash);
+	return key;
+}
+
+uint64_t liboai::EmbeddingCache::Find(const Key& key) const noexcept {
+	if (this->index_.empty()) {
+		return 0;
+	}
+
+	size_t mask = this->index_.size() - 1;
+	for (size_t i = key.hash[0] & mask;; i = (i + 1) & mask) {
+		const Slot& slot = this->index_[i];
+		if (slot.offset == 0) {
+			return 0;
+		}
+		if (slot.key == key) {
+			return slot.offset;
+		}
+	}
+}
+
+void liboai::EmbeddingCache::Insert(const Key& key, uint64_t offset) {
+	// keep the table at most half full so that probes stay short
+	if ((this->entries_ + 1) * 2 > this->index_.size()) {
+		std::vector<Slot> old = std::move(this->index_);
+		this->index_.assign(std::max<size_t>(64, old.size() * 2), Slot{});
+
+		size_t mask = this->index_.size() - 1;
+		for (const Slot& slot : old) {
+			if (slot.offset != 0) {
+				size_t i = slot.key.hash[0] & mask;
+				while (this->index_[i].offset != 0) {
+					i = (i + 1) & mask;
+				}
+				this->index_[i] = slot;
+			}
+		}
+	}
+
+	size_t mask = this->index_.size() - 1;
+	size_t i = key.hash[0] & mask;
+	while (this->index_[i].offset != 0) {
+		i = (i + 1) & mask;
+	}
+	this->index_[i] = Slot{ key, offset };
+	++this->entries_;
+}
+
+bool liboai::EmbeddingCache::Lookup(std::string_view model, uint32_t dimensions, std::string_view input, std::vector<float>& out) const {
+	Key key = KeyOf(model, dimensions, input);
+
+	std::shared_lock<std::shared_mutex> lock(this->mutex_);
+	uint64_t offset = this->Find(key);
+	if (offset == 0 || !this->map_) {
+		this->misses_.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	RecordHeader header;
+	std::memcpy(&header, this->map_ + offset, sizeof(header));
+	const float* values = reinterpret_cast<const float*>(this->map_ + offset + sizeof(RecordHeader));
+	out.assign(values, values + header.count);
+
+	this->hits_.fetch_add(1, std::memory_order_relaxed);
+	return true;
+}
+
+void liboai::EmbeddingCache::Store(std::string_view model, uint32_t dimensions, std::string_view input, Span<const float> embedding) noexcept(false) {
+	if (embedding.empty()) {
+		return;
+	}
+
+	Key key = KeyOf(model, dimensions, input);
+
+	std::unique_lock<std::shared_mutex> lock(this->mutex_);
+	if (this->Find(key) != 0) {
+		return;
+	}
+
+	uint64_t size = RecordSize(embedding.size());
+	this->Reserve(this->end_ + size);
+
+	RecordHeader header{};
+	header.magic = kRecordMagic;
+	header.count = static_cast<uint32_t>(embedding.size());
+	header.key[0] = key.hash[0];
+	header.key[1] = key.hash[1];
+	header.checksum = Checksum(header.key, embedding.data(), header.count);
+
+	// values first, header last, so that a record is only ever
+	// seen complete by Recover() after an orderly shutdown
+	uint8_t* record = this->map_ + this->end_;
+	std::memcpy(record + sizeof(RecordHeader), embedding.data(), embedding.size() * sizeof(float));
+	std::memset(record + sizeof(RecordHeader) + embedding.size() * sizeof(float), 0, size - sizeof(RecordHeader) - embedding.size() * sizeof(float));
+	std::memcpy(record, &header, sizeof(header));
+
+	this->Insert(key, this->end_);
+	this->end_ += size;
+}
+
+void liboai::EmbeddingCache::Flush() noexcept(false) {
+	std::unique_lock<std::shared_mutex> lock(this->mutex_);
+	this->file_->Sync(this->map_, this->capacity_);
+}
+
+liboai::EmbeddingCache::Stats liboai::EmbeddingCache::GetStats() const noexcept {
+	std::shared_lock<std::shared_mutex> lock(this->mutex_);
+
+	Stats stats;
+	stats.hits = this->hits_.load(std::memory_order_relaxed);
+	stats.misses = this->misses_.load(std::memory_order_relaxed);
+	stats.entries = this->entries_;
+	stats.bytes = this->end_ - sizeof(FileHeader);
+	return stats;
+}
@@ -1,26 +1,541 @@
 #include "../include/components/embeddings.h"
+#include "../include/components/embedding_cache.h"
+#include <atomic>
+#include <mutex>
+#include <cstring>
+#include <algorithm>
 
-liboai::Response liboai::Embeddings::create(const std::string& model_id, std::optional<std::string> input, std::optional<std::string> user) const & noexcept(false) {
+namespace {
+	class EmbeddingReader final : public liboai::SaxReader {
+		public:
+			explicit EmbeddingReader(liboai::EmbeddingResult& result) : result_(result) {}
+
+		protected:
+			void OnEnter(bool array) override {
+				if (!array && this->At({ "data", "#" })) {
+					this->result_.data.emplace_back();
+				}
+				else if (array && this->At({ "data", "#", "embedding" })) {
+					// vector values go straight into place without any
+					// further path matching; every vector in a response
+					// has the same dimension, so size from the last one
+					this->vector_ = &this->result_.data.back().embedding;
+					this->vector_->reserve(this->dimension_);
+				}
+			}
+
+			void OnLeave(bool array) override {
+				if (array && this->vector_) {
+					this->dimension_ = this->vector_->size();
+					this->vector_ = nullptr;
+				}
+			}
+
+			void OnNumber(double value) override {
+				if (this->vector_) {
+					this->vector_->push_back(static_cast<float>(value));
+				}
+				else if (this->At({ "data", "#", "index" })) {
+					this->result_.data.back().index = static_cast<uint32_t>(value);
+				}
+				else {
+					this->ReadUsage(this->result_.usage, value);
+				}
+			}
+
+			void OnString(std::string& value) override {
+				if (this->At({ "data", "#", "embedding" })) {
+					// encoding_format "base64": little-endian float32 values
+					std::vector<float>& embedding = this->result_.data.back().embedding;
+					size_t count = liboai::Base64::FloatCount(value);
+					embedding.resize(count == liboai::Base64::npos ? 0 : count);
+					if (count == liboai::Base64::npos || !liboai::Base64::DecodeFloats(value, embedding.data(), count)) {
+						throw liboai::exception::OpenAIException(
+							"Embedding is not valid base64",
+							liboai::exception::EType::E_FAILURETOPARSE,
+							"liboai::EmbeddingResult::Parse()"
+						);
+					}
+					this->dimension_ = count;
+				}
+				else if (this->At({ "object" })) {
+					this->result_.object = std::move(value);
+				}
+				else if (this->At({ "model" })) {
+					this->result_.model = std::move(value);
+				}
+			}
+
+		private:
+			liboai::EmbeddingResult& result_;
+			std::vector<float>* vector_ = nullptr;
+			size_t dimension_ = 0;
+	};
+}
+
+liboai::EmbeddingResult liboai::EmbeddingResult::Parse(std::string_view json) noexcept(false) {
+	EmbeddingResult result;
+	EmbeddingReader reader(result);
+	reader.Parse(json);
+	return result;
+}
+
+class liboai::EmbeddingMatrix::Reader final : public liboai::SaxReader {
+	public:
+		explicit Reader(EmbeddingMatrix& matrix) : matrix_(matrix) {}
+
+		void Finish() {
+			// responses list their vectors in index order; only
+			// reorder the rows if this one did not
+			bool ordered = true;
+			for (size_t i = 0; i < this->indices_.size(); ++i) {
+				ordered = ordered && this->indices_[i] == i;
+			}
+			if (ordered) {
+				return;
+			}
+
+			std::vector<size_t> rows(this->indices_.size());
+			for (size_t i = 0; i < rows.size(); ++i) {
+				rows[i] = i;
+			}
+			std::sort(rows.begin(), rows.end(), [this](size_t a, size_t b) { return this->indices_[a] < this->indices_[b]; });
+
+			EmbeddingMatrix sorted(this->matrix_.rows_, this->matrix_.dimensions_);
+			for (size_t i = 0; i < rows.size(); ++i) {
+				std::memcpy(sorted.Row(i).data(), this->matrix_.Row(rows[i]).data(), this->matrix_.stride_ * sizeof(float));
+			}
+			this->matrix_ = std::move(sorted);
+		}
+
+	protected:
+		void OnEnter(bool array) override {
+			if (!array && this->At({ "data", "#" })) {
+				this->index_ = this->indices_.size();
+				this->has_row_ = false;
+			}
+			else if (array && this->At({ "data", "#", "embedding" })) {
+				this->row_ = true;
+				this->has_row_ = true;
+				this->column_ = 0;
+				if (this->matrix_.dimensions_ != 0) {
+					this->matrix_.Reserve(this->matrix_.rows_ + 1);
+				}
+			}
+		}
+
+		void OnLeave(bool array) override {
+			if (array && this->row_) {
+				this->row_ = false;
+				this->EndRow();
+			}
+			else if (!array && this->has_row_ && this->At({ "data", "#" })) {
+				this->indices_.push_back(this->index_);
+			}
+		}
+
+		void OnNumber(double value) override {
+			if (this->row_) {
+				if (this->matrix_.dimensions_ == 0) {
+					this->first_.push_back(static_cast<float>(value));
+				}
+				else if (this->column_ < this->matrix_.dimensions_) {
+					this->matrix_.data_[this->matrix_.rows_ * this->matrix_.stride_ + this->column_++] = static_cast<float>(value);
+				}
+				else {
+					this->Mismatch();
+				}
+			}
+			else if (this->At({ "data", "#", "index" })) {
+				this->index_ = static_cast<size_t>(value);
+			}
+		}
+
+		void OnString(std::string& value) override {
+			if (!this->At({ "data", "#", "embedding" })) {
+				return;
+			}
+
+			// encoding_format "base64": the payload is decoded
+			// straight into the row it belongs to
+			size_t count = liboai::Base64::FloatCount(value);
+			if (count == liboai::Base64::npos) {
+				this->Invalid();
+			}
+
+			this->has_row_ = true;
+			float* row;
+			if (this->matrix_.dimensions_ == 0) {
+				this->first_.resize(count);
+				row = this->first_.data();
+			}
+			else if (count == this->matrix_.dimensions_) {
+				this->matrix_.Reserve(this->matrix_.rows_ + 1);
+				row = this->matrix_.data_.get() + this->matrix_.rows_ * this->matrix_.stride_;
+				this->column_ = count;
+			}
+			else {
+				this->Mismatch();
+			}
+
+			if (!liboai::Base64::DecodeFloats(value, row, count)) {
+				this->Invalid();
+			}
+			this->EndRow();
+		}
+
+	private:
+		void EndRow() {
+			if (this->matrix_.dimensions_ == 0) {
+				// the first row fixes the dimension of the rest
+				if (this->first_.empty()) {
+					this->Mismatch();
+				}
+				this->matrix_.dimensions_ = this->first_.size();
+				this->matrix_.stride_ = StrideOf(this->first_.size());
+				this->matrix_.Reserve(8);
+				std::copy(this->first_.begin(), this->first_.end(), this->matrix_.data_.get());
+				this->column_ = this->first_.size();
+			}
+			else if (this->column_ != this->matrix_.dimensions_) {
+				this->Mismatch();
+			}
+
+			float* row = this->matrix_.data_.get() + this->matrix_.rows_ * this->matrix_.stride_;
+			std::fill(row + this->matrix_.dimensions_, row + this->matrix_.stride_, 0.0f);
+			++this->matrix_.rows_;
+		}
+
+		[[noreturn]] void Mismatch() {
+			throw liboai::exception::OpenAIException(
+				"Embedding vectors differ in dimension",
+				liboai::exception::EType::E_FAILURETOPARSE,
+				"liboai::EmbeddingMatrix::Parse()"
+			);
+		}
+
+		[[noreturn]] void Invalid() {
+			throw liboai::exception::OpenAIException(
+				"Embedding is not valid base64",
+				liboai::exception::EType::E_FAILURETOPARSE,
+				"liboai::EmbeddingMatrix::Parse()"
+			);
+		}
+
+		EmbeddingMatrix& matrix_;
+		std::vector<float> first_;
+		std::vector<size_t> indices_;
+		size_t index_ = 0, column_ = 0;
+		bool row_ = false, has_row_ = false;
+};
+
+liboai::EmbeddingMatrix::EmbeddingMatrix(size_t rows, size_t dimensions) : dimensions_(dimensions), stride_(StrideOf(dimensions)) {
+	this->Reserve(rows);
+	if (rows != 0) {
+		std::fill(this->data_.get(), this->data_.get() + rows * this->stride_, 0.0f);
+	}
+	this->rows_ = rows;
+}
+
+liboai::EmbeddingMatrix::EmbeddingMatrix(const EmbeddingMatrix& other) : dimensions_(other.dimensions_), stride_(other.stride_) {
+	this->Reserve(other.rows_);
+	if (other.rows_ != 0) {
+		std::memcpy(this->data_.get(), other.data_.get(), other.rows_ * other.stride_ * sizeof(float));
+	}
+	this->rows_ = other.rows_;
+}
+
+liboai::EmbeddingMatrix& liboai::EmbeddingMatrix::operator=(const EmbeddingMatrix& other) {
+	if (this != &other) {
+		*this = EmbeddingMatrix(other);
+	}
+	return *this;
+}
+
+void liboai::EmbeddingMatrix::Reserve(size_t rows) {
+	if (rows <= this->capacity_ || this->stride_ == 0) {
+		return;
+	}
+
+	size_t capacity = std::max(rows, this->capacity_ * 2);
+	std::unique_ptr<float[], Free> data(static_cast<float*>(
+		::operator new(capacity * this->stride_ * sizeof(float), std::align_val_t(alignment))
+	));
+	if (this->rows_ != 0) {
+		std::memcpy(data.get(), this->data_.get(), this->rows_ * this->stride_ * sizeof(float));
+	}
+
+	this->data_ = std::move(data);
+	this->capacity_ = capacity;
+}
+
+liboai::EmbeddingMatrix liboai::EmbeddingMatrix::Parse(std::string_view json) noexcept(false) {
+	EmbeddingMatrix matrix;
+	Reader reader(matrix);
+	reader.Parse(json);
+	reader.Finish();
+	return matrix;
+}
+
+struct liboai::Embeddings::BatchJob {
+	// request settings, captured once so that batches can be sent
+	// from the engine's loop thread
+	std::string root, model;
+	std::optional<std::string> user;
+	bool base64 = true;
+	std::optional<uint32_t> dimensions;
+	EmbeddingCache* cache = nullptr;
+	netimpl::components::Header headers;
+	netimpl::components::Proxies proxies;
+	netimpl::components::ProxyAuthentication proxy_auth;
+	netimpl::components::Timeout timeout{ 0 };
+
+	std::vector<std::string> owned; // inputs of an asynchronous job
+	const std::vector<std::string>* inputs = nullptr;
+	std::vector<size_t> order;                      // indices of the inputs to send
+	std::vector<std::pair<size_t, size_t>> batches; // [begin, end) ranges of order
+
+	std::atomic<size_t> next = 0, remaining = 0;
+	std::mutex mutex; // guards usage and failed
+	EmbeddingBatchResult result;
+	std::promise<EmbeddingBatchResult> promise;
+};
+
+std::future<liboai::EmbeddingBatchResult> liboai::Embeddings::StartBatches(std::shared_ptr<BatchJob> job, const std::string& model_id, const EmbeddingBatchOptions& options) const {
+	if (options.max_inputs == 0 || options.max_tokens == 0 || options.max_bytes == 0 || options.concurrency == 0) {
+		throw liboai::exception::OpenAIException(
+			"Batch limits and concurrency must be non-zero",
+			liboai::exception::EType::E_BADREQUEST,
+			"liboai::Embeddings::create(const std::string&, const std::vector<std::string>&, ...)"
+		);
+	}
+
+	job->root = this->openai_root_;
+	job->model = model_id;
+	job->user = options.user;
+	job->base64 = options.base64;
+	job->dimensions = options.dimensions;
+	job->cache = options.cache;
+	job->headers = this->auth_.GetAuthorizationHeaders();
+	job->proxies = this->auth_.GetProxies();
+	job->proxy_auth = this->auth_.GetProxyAuth();
+	job->timeout = this->auth_.GetMaxTimeout();
+
+	const std::vector<std::string>& inputs = *job->inputs;
+	job->result.items.resize(inputs.size());
+	job->order.reserve(inputs.size());
+
+	// the API rejects empty inputs along with the rest of their
+	// request, so they are failed here instead of being sent;
+	// inputs already in the cache are not sent either
+	for (size_t i = 0; i < inputs.size(); ++i) {
+		if (inputs[i].empty()) {
+			job->result.items[i].error = std::make_exception_ptr(liboai::exception::OpenAIException(
+				"Input must not be empty",
+				liboai::exception::EType::E_BADREQUEST,
+				"liboai::Embeddings::create(const std::string&, const std::vector<std::string>&, ...)"
+			));
+			++job->result.failed;
+		}
+		else if (!job->cache || !job->cache->Lookup(model_id, options.dimensions.value_or(0), inputs[i], job->result.items[i].embedding)) {
+			job->order.push_back(i);
+		}
+	}
+
+	// greedily fill each batch up to whichever limit is hit first;
+	// an input over the limits on its own is sent by itself
+	size_t begin = 0, tokens = 0, bytes = 0;
+	for (size_t i = 0; i < job->order.size(); ++i) {
+		const std::string& input = inputs[job->order[i]];
+		size_t input_tokens = options.count_tokens ? options.count_tokens(input) : (input.size() + 2) / 3;
+		size_t input_bytes = input.size();
+
+		if (i > begin && (i - begin >= options.max_inputs || tokens + input_tokens > options.max_tokens || bytes + input_bytes > options.max_bytes)) {
+			job->batches.emplace_back(begin, i);
+			begin = i;
+			tokens = bytes = 0;
+		}
+		tokens += input_tokens;
+		bytes += input_bytes;
+	}
+	if (begin < job->order.size()) {
+		job->batches.emplace_back(begin, job->order.size());
+	}
+
+	std::future<EmbeddingBatchResult> future = job->promise.get_future();
+	job->remaining = job->batches.size();
+	if (job->batches.empty()) {
+		job->promise.set_value(std::move(job->result));
+		return future;
+	}
+
+	// each completed batch dispatches the next, keeping at most
+	// 'concurrency' requests in flight
+	for (size_t i = 0; i < std::min(options.concurrency, job->batches.size()); ++i) {
+		DispatchBatches(job);
+	}
+
+	return future;
+}
+
+void liboai::Embeddings::DispatchBatches(const std::shared_ptr<BatchJob>& job) {
+	while (true) {
+		size_t batch = job->next.fetch_add(1, std::memory_order_relaxed);
+		if (batch >= job->batches.size()) {
+			return;
+		}
+
+		try {
+			auto [begin, end] = job->batches[batch];
+			std::vector<std::string_view> input;
+			input.reserve(end - begin);
+			for (size_t i = begin; i < end; ++i) {
+				input.push_back((*job->inputs)[job->order[i]]);
+			}
+
+			liboai::JsonConstructor jcon;
+			jcon.push_back("model", job->model);
+			jcon.push_back("input", input);
+			if (job->user) {
+				jcon.push_back("user", job->user.value());
+			}
+			if (job->base64) {
+				jcon.push_back("encoding_format", "base64");
+			}
+			if (job->dimensions) {
+				jcon.push_back("dimensions", job->dimensions.value());
+			}
+
+			Network::RequestAsync(
+				[job, batch](FutureResponse response) {
+					CompleteBatch(job, batch, std::move(response));
+				},
+				Method::HTTP_POST, job->root, "/embeddings", "application/json",
+				job->headers,
+				netimpl::components::Body {
+					jcon.release()
+				},
+				netimpl::components::Proxies(job->proxies),
+				netimpl::components::ProxyAuthentication(job->proxy_auth),
+				netimpl::components::Timeout(job->timeout)
+			);
+			return;
+		}
+		catch (...) {
+			// the batch was never handed to the engine; fail it and
+			// move on to the next one in its place
+			FailBatch(*job, batch, std::current_exception());
+			if (FinishBatch(*job)) {
+				return;
+			}
+		}
+	}
+}
+
+void liboai::Embeddings::CompleteBatch(const std::shared_ptr<BatchJob>& job, size_t batch, FutureResponse response) {
+	auto [begin, end] = job->batches[batch];
+
+	try {
+		EmbeddingResult result = response.get().As<EmbeddingResult>();
+		for (EmbeddingResult::Embedding& embedding : result.data) {
+			if (embedding.index < end - begin) {
+				job->result.items[job->order[begin + embedding.index]].embedding = std::move(embedding.embedding);
+			}
+		}
+
+		size_t missing = 0;
+		for (size_t i = begin; i < end; ++i) {
+			EmbeddingBatchResult::Item& item = job->result.items[job->order[i]];
+			if (item.embedding.empty()) {
+				item.error = std::make_exception_ptr(liboai::exception::OpenAIException(
+					"No embedding was returned for this input",
+					liboai::exception::EType::E_APIERROR,
+					"liboai::Embeddings::create(const std::string&, const std::vector<std::string>&, ...)"
+				));
+				++missing;
+			}
+			else if (job->cache) {
+				try {
+					job->cache->Store(job->model, job->dimensions.value_or(0), (*job->inputs)[job->order[i]], Span<const float>(item.embedding.data(), item.embedding.size()));
+				}
+				catch (...) {
+					// a cache that cannot be written to only costs
+					// future requests; this embedding is still good
+				}
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(job->mutex);
+		job->result.usage.prompt_tokens += result.usage.prompt_tokens;
+		job->result.usage.completion_tokens += result.usage.completion_tokens;
+		job->result.usage.total_tokens += result.usage.total_tokens;
+		job->result.failed += missing;
+	}
+	catch (...) {
+		FailBatch(*job, batch, std::current_exception());
+	}
+
+	if (!FinishBatch(*job)) {
+		DispatchBatches(job);
+	}
+}
+
+void liboai::Embeddings::FailBatch(BatchJob& job, size_t batch, std::exception_ptr error) {
+	auto [begin, end] = job.batches[batch];
+	for (size_t i = begin; i < end; ++i) {
+		job.result.items[job.order[i]].error = error;
+	}
+
+	std::lock_guard<std::mutex> lock(job.mutex);
+	job.result.failed += end - begin;
+}
+
+bool liboai::Embeddings::FinishBatch(BatchJob& job) {
+	if (job.remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+		return false;
+	}
+
+	job.promise.set_value(std::move(job.result));
+	return true;
+}
+
+liboai::EmbeddingBatchResult liboai::Embeddings::create(const std::string& model_id, const std::vector<std::string>& inputs, const EmbeddingBatchOptions& options) const & noexcept(false) {
+	auto job = std::make_shared<BatchJob>();
+	job->inputs = &inputs;
+	return this->StartBatches(std::move(job), model_id, options).get();
+}
+
+std::future<liboai::EmbeddingBatchResult> liboai::Embeddings::create_async(const std::string& model_id, std::vector<std::string> inputs, const EmbeddingBatchOptions& options) const & noexcept(false) {
+	auto job = std::make_shared<BatchJob>();
+	job->owned = std::move(inputs);
+	job->inputs = &job->owned;
+	return this->StartBatches(std::move(job), model_id, options);
+}
+
+template <class _Mode>
+typename _Mode::Result liboai::Embeddings::Create(_Mode mode, const std::string& model_id, std::optional<std::string> input, std::optional<std::string> user, std::optional<std::string> encoding_format) const {
 	liboai::JsonConstructor jcon;
 	jcon.push_back("model", model_id);
 	jcon.push_back("input", std::move(input));
 	jcon.push_back("user", std::move(user));
+	jcon.push_back("encoding_format", std::move(encoding_format));
 
-	Response res;
-	res = this->Request(
-		Method::HTTP_POST, this->openai_root_, "/embeddings", "application/json",
+	return this->Send(
+		mode, Method::HTTP_POST, this->openai_root_, "/embeddings", "application/json",
 		this->auth_.GetAuthorizationHeaders(),
 		netimpl::components::Body {
-			jcon.dump()
+			jcon.release()
 		},
 		this->auth_.GetProxies(),
 		this->auth_.GetProxyAuth(),
 		this->auth_.GetMaxTimeout()
 	);
+}
 
-	return res;
+liboai::Response liboai::Embeddings::create(const std::string& model_id, std::optional<std::string> input, std::optional<std::string> user, std::optional<std::string> encoding_format) const & noexcept(false) {
+	return this->Create(Synchronous{}, model_id, std::move(input), std::move(user), std::move(encoding_format));
 }
 
-liboai::FutureResponse liboai::Embeddings::create_async(const std::string& model_id, std::optional<std::string> input, std::optional<std::string> user) const & noexcept(false) {
-	return std::async(std::launch::async, &liboai::Embeddings::create, this, model_id, input, user);
+liboai::FutureResponse liboai::Embeddings::create_async(const std::string& model_id, std::optional<std::string> input, std::optional<std::string> user, std::optional<std::string> encoding_format) const & noexcept(false) {
+	return this->Create(Asynchronous{}, model_id, std::move(input), std::move(user), std::move(encoding_format));
 }
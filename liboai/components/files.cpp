@@ -1,23 +1,26 @@
 #include "../include/components/files.h"
 
-liboai::Response liboai::Files::list() const & noexcept(false) {
-	Response res;
-	res = this->Request(
-		Method::HTTP_GET, this->openai_root_, "/files", "application/json",
+template <class _Mode>
+typename _Mode::Result liboai::Files::List(_Mode mode) const {
+	return this->Send(
+		mode, Method::HTTP_GET, this->openai_root_, "/files", "application/json",
 		this->auth_.GetAuthorizationHeaders(),
 		this->auth_.GetProxies(),
 		this->auth_.GetProxyAuth(),
 		this->auth_.GetMaxTimeout()
 	);
+}
 
-	return res;
+liboai::Response liboai::Files::list() const & noexcept(false) {
+	return this->List(Synchronous{});
 }
 
 liboai::FutureResponse liboai::Files::list_async() const & noexcept(false) {
-	return std::async(std::launch::async, &liboai::Files::list, this);
+	return this->List(Asynchronous{});
 }
 
-liboai::Response liboai::Files::create(const std::filesystem::path& file, const std::string& purpose) const & noexcept(false) {
+template <class _Mode>
+typename _Mode::Result liboai::Files::Create(_Mode mode, const std::filesystem::path& file, const std::string& purpose) const {
 	if (!this->Validate(file)) {
 		throw liboai::exception::OpenAIException(
 			"File path provided is non-existent, is not a file, or is empty.",
@@ -31,55 +34,60 @@ liboai::Response liboai::Files::create(const std::filesystem::path& file, const
 		{ "file", netimpl::components::File{file.generic_string()} }
 	};
 	
-	Response res;
-	res = this->Request(
-		Method::HTTP_POST, this->openai_root_, "/files", "multipart/form-data",
+	return this->Send(
+		mode, Method::HTTP_POST, this->openai_root_, "/files", "multipart/form-data",
 		this->auth_.GetAuthorizationHeaders(),
 		std::move(form),
 		this->auth_.GetProxies(),
 		this->auth_.GetProxyAuth(),
 		this->auth_.GetMaxTimeout()
 	);
+}
 
-	return res;
+liboai::Response liboai::Files::create(const std::filesystem::path& file, const std::string& purpose) const & noexcept(false) {
+	return this->Create(Synchronous{}, file, purpose);
 }
 
 liboai::FutureResponse liboai::Files::create_async(const std::filesystem::path& file, const std::string& purpose) const & noexcept(false) {
-	return std::async(std::launch::async, &liboai::Files::create, this, file, purpose);
+	return this->Create(Asynchronous{}, file, purpose);
 }
 
-liboai::Response liboai::Files::remove(const std::string& file_id) const & noexcept(false) {
-	Response res;
-	res = this->Request(
-		Method::HTTP_DELETE, this->openai_root_, "/files/" + file_id, "application/json",
+template <class _Mode>
+typename _Mode::Result liboai::Files::Remove(_Mode mode, const std::string& file_id) const {
+	return this->Send(
+		mode, Method::HTTP_DELETE, this->openai_root_, "/files/" + file_id, "application/json",
 		this->auth_.GetAuthorizationHeaders(),
 		this->auth_.GetProxies(),
 		this->auth_.GetProxyAuth(),
 		this->auth_.GetMaxTimeout()
 	);
+}
 
-	return res;
+liboai::Response liboai::Files::remove(const std::string& file_id) const & noexcept(false) {
+	return this->Remove(Synchronous{}, file_id);
 }
 
 liboai::FutureResponse liboai::Files::remove_async(const std::string& file_id) const & noexcept(false) {
-	return std::async(std::launch::async, &liboai::Files::remove, this, file_id);
+	return this->Remove(Asynchronous{}, file_id);
 }
 
-liboai::Response liboai::Files::retrieve(const std::string& file_id) const & {
-	Response res;
-	res = this->Request(
-		Method::HTTP_GET, this->openai_root_, "/files/" + file_id, "application/json",
+template <class _Mode>
+typename _Mode::Result liboai::Files::Retrieve(_Mode mode, const std::string& file_id) const {
+	return this->Send(
+		mode, Method::HTTP_GET, this->openai_root_, "/files/" + file_id, "application/json",
 		this->auth_.GetAuthorizationHeaders(),
 		this->auth_.GetProxies(),
 		this->auth_.GetProxyAuth(),
 		this->auth_.GetMaxTimeout()
 	);
+}
 
-	return res;
+liboai::Response liboai::Files::retrieve(const std::string& file_id) const & {
+	return this->Retrieve(Synchronous{}, file_id);
 }
 
 liboai::FutureResponse liboai::Files::retrieve_async(const std::string& file_id) const & noexcept(false) {
-	return std::async(std::launch::async, &liboai::Files::retrieve, this, file_id);
+	return this->Retrieve(Asynchronous{}, file_id);
 }
 
 bool liboai::Files::download(const std::string& file_id, const std::string& save_to) const & noexcept(false) {
@@ -91,5 +99,9 @@ bool liboai::Files::download(const std::string& file_id, const std::string& save
 }
 
 std::future<bool> liboai::Files::download_async(const std::string& file_id, const std::string& save_to) const & noexcept(false) {
-	return std::async(std::launch::async, &liboai::Files::download, this, file_id, save_to);
+	return Network::DownloadAsync(
+		save_to,
+		("https://api.openai.com/v1/files/" + file_id + "/content"),
+		this->auth_.GetAuthorizationHeaders()
+	);
 }
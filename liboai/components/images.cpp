@@ -1,6 +1,7 @@
 #include "../include/components/images.h"
 
-liboai::Response liboai::Images::create(const std::string& prompt, std::optional<uint8_t> n, std::optional<std::string> size, std::optional<std::string> response_format, std::optional<std::string> user) const & noexcept(false) {
+template <class _Mode>
+typename _Mode::Result liboai::Images::Create(_Mode mode, const std::string& prompt, std::optional<uint8_t> n, std::optional<std::string> size, std::optional<std::string> response_format, std::optional<std::string> user) const {
 	liboai::JsonConstructor jcon;
 	jcon.push_back("prompt", prompt);
 	jcon.push_back("n", std::move(n));
@@ -8,26 +9,28 @@ liboai::Response liboai::Images::create(const std::string& prompt, std::optional
 	jcon.push_back("response_format", std::move(response_format));
 	jcon.push_back("user", std::move(user));
 
-	Response res;
-	res = this->Request(
-		Method::HTTP_POST, this->openai_root_, "/images/generations", "application/json",
+	return this->Send(
+		mode, Method::HTTP_POST, this->openai_root_, "/images/generations", "application/json",
 		this->auth_.GetAuthorizationHeaders(),
 		netimpl::components::Body {
-			jcon.dump()
+			jcon.release()
 		},
 		this->auth_.GetProxies(),
 		this->auth_.GetProxyAuth(),
 		this->auth_.GetMaxTimeout()
 	);
+}
 
-	return res;
+liboai::Response liboai::Images::create(const std::string& prompt, std::optional<uint8_t> n, std::optional<std::string> size, std::optional<std::string> response_format, std::optional<std::string> user) const & noexcept(false) {
+	return this->Create(Synchronous{}, prompt, std::move(n), std::move(size), std::move(response_format), std::move(user));
 }
 
 liboai::FutureResponse liboai::Images::create_async(const std::string& prompt, std::optional<uint8_t> n, std::optional<std::string> size, std::optional<std::string> response_format, std::optional<std::string> user) const & noexcept(false) {
-	return std::async(std::launch::async, &liboai::Images::create, this, prompt, n, size, response_format, user);
+	return this->Create(Asynchronous{}, prompt, std::move(n), std::move(size), std::move(response_format), std::move(user));
 }
 
-liboai::Response liboai::Images::create_edit(const std::filesystem::path& image, const std::string& prompt, std::optional<std::filesystem::path> mask, std::optional<uint8_t> n, std::optional<std::string> size, std::optional<std::string> response_format, std::optional<std::string> user) const & noexcept(false) {
+template <class _Mode>
+typename _Mode::Result liboai::Images::CreateEdit(_Mode mode, const std::filesystem::path& image, const std::string& prompt, std::optional<std::filesystem::path> mask, std::optional<uint8_t> n, std::optional<std::string> size, std::optional<std::string> response_format, std::optional<std::string> user) const {
 	if (!this->Validate(image)) {
 		throw liboai::exception::OpenAIException(
 			"File path provided is non-existent, is not a file, or is empty.",
@@ -56,24 +59,26 @@ liboai::Response liboai::Images::create_edit(const std::filesystem::path& image,
 	if (response_format) { form.parts.push_back({ "response_format", response_format.value() }); }
 	if (user) { form.parts.push_back({ "user", user.value() }); }
 	
-	Response res;
-	res = this->Request(
-		Method::HTTP_POST, this->openai_root_, "/images/edits", "multipart/form-data",
+	return this->Send(
+		mode, Method::HTTP_POST, this->openai_root_, "/images/edits", "multipart/form-data",
 		this->auth_.GetAuthorizationHeaders(),
 		std::move(form),
 		this->auth_.GetProxies(),
 		this->auth_.GetProxyAuth(),
 		this->auth_.GetMaxTimeout()
 	);
+}
 
-	return res;
+liboai::Response liboai::Images::create_edit(const std::filesystem::path& image, const std::string& prompt, std::optional<std::filesystem::path> mask, std::optional<uint8_t> n, std::optional<std::string> size, std::optional<std::string> response_format, std::optional<std::string> user) const & noexcept(false) {
+	return this->CreateEdit(Synchronous{}, image, prompt, std::move(mask), std::move(n), std::move(size), std::move(response_format), std::move(user));
 }
 
 liboai::FutureResponse liboai::Images::create_edit_async(const std::filesystem::path& image, const std::string& prompt, std::optional<std::filesystem::path> mask, std::optional<uint8_t> n, std::optional<std::string> size, std::optional<std::string> response_format, std::optional<std::string> user) const & noexcept(false) {
-	return std::async(std::launch::async, &liboai::Images::create_edit, this, image, prompt, mask, n, size, response_format, user);
+	return this->CreateEdit(Asynchronous{}, image, prompt, std::move(mask), std::move(n), std::move(size), std::move(response_format), std::move(user));
 }
 
-liboai::Response liboai::Images::create_variation(const std::filesystem::path& image, std::optional<uint8_t> n, std::optional<std::string> size, std::optional<std::string> response_format, std::optional<std::string> user) const & noexcept(false) {
+template <class _Mode>
+typename _Mode::Result liboai::Images::CreateVariation(_Mode mode, const std::filesystem::path& image, std::optional<uint8_t> n, std::optional<std::string> size, std::optional<std::string> response_format, std::optional<std::string> user) const {
 	if (!this->Validate(image)) {
 		throw liboai::exception::OpenAIException(
 			"File path provided is non-existent, is not a file, or is empty.",
@@ -91,19 +96,20 @@ liboai::Response liboai::Images::create_variation(const std::filesystem::path& i
 	if (response_format) { form.parts.push_back({ "response_format", response_format.value() }); }
 	if (user) { form.parts.push_back({ "user", user.value() }); }
 	
-	Response res;
-	res = this->Request(
-		Method::HTTP_POST, this->openai_root_, "/images/variations", "multipart/form-data",
+	return this->Send(
+		mode, Method::HTTP_POST, this->openai_root_, "/images/variations", "multipart/form-data",
 		this->auth_.GetAuthorizationHeaders(),
 		std::move(form),
 		this->auth_.GetProxies(),
 		this->auth_.GetProxyAuth(),
 		this->auth_.GetMaxTimeout()
 	);
+}
 
-	return res;
+liboai::Response liboai::Images::create_variation(const std::filesystem::path& image, std::optional<uint8_t> n, std::optional<std::string> size, std::optional<std::string> response_format, std::optional<std::string> user) const & noexcept(false) {
+	return this->CreateVariation(Synchronous{}, image, std::move(n), std::move(size), std::move(response_format), std::move(user));
 }
 
 liboai::FutureResponse liboai::Images::create_variation_async(const std::filesystem::path& image, std::optional<uint8_t> n, std::optional<std::string> size, std::optional<std::string> response_format, std::optional<std::string> user) const & noexcept(false) {
-	return std::async(std::launch::async, &liboai::Images::create_variation, this, image, n, size, response_format, user);
+	return this->CreateVariation(Asynchronous{}, image, std::move(n), std::move(size), std::move(response_format), std::move(user));
 }
@@ -1,35 +1,39 @@
 #include "../include/components/models.h"
 
-liboai::Response liboai::Models::list() const & noexcept(false) {
-	Response res;
-	res = this->Request(
-		Method::HTTP_GET, this->openai_root_, "/models", "application/json",
+template <class _Mode>
+typename _Mode::Result liboai::Models::List(_Mode mode) const {
+	return this->Send(
+		mode, Method::HTTP_GET, this->openai_root_, "/models", "application/json",
 		this->auth_.GetAuthorizationHeaders(),
 		this->auth_.GetProxies(),
 		this->auth_.GetProxyAuth(),
 		this->auth_.GetMaxTimeout()
 	);
+}
 
-	return res;
+liboai::Response liboai::Models::list() const & noexcept(false) {
+	return this->List(Synchronous{});
 }
 
 liboai::FutureResponse liboai::Models::list_async() const & noexcept(false) {
-	return std::async(std::launch::async, &liboai::Models::list, this);
+	return this->List(Asynchronous{});
 }
 
-liboai::Response liboai::Models::retrieve(const std::string& model) const & noexcept(false) {
-	Response res;
-	res = this->Request(
-		Method::HTTP_GET, this->openai_root_, "/models/" + model, "application/json",
+template <class _Mode>
+typename _Mode::Result liboai::Models::Retrieve(_Mode mode, const std::string& model) const {
+	return this->Send(
+		mode, Method::HTTP_GET, this->openai_root_, "/models/" + model, "application/json",
 		this->auth_.GetAuthorizationHeaders(),
 		this->auth_.GetProxies(),
 		this->auth_.GetProxyAuth(),
 		this->auth_.GetMaxTimeout()
 	);
+}
 
-	return res;
+liboai::Response liboai::Models::retrieve(const std::string& model) const & noexcept(false) {
+	return this->Retrieve(Synchronous{}, model);
 }
 
 liboai::FutureResponse liboai::Models::retrieve_async(const std::string& model) const & noexcept(false) {
-	return std::async(std::launch::async, &liboai::Models::retrieve, this, model);
+	return this->Retrieve(Asynchronous{}, model);
 }
@@ -1,25 +1,75 @@
 #include "../include/components/moderations.h"
 
-liboai::Response liboai::Moderations::create(const std::string& input, std::optional<std::string> model) const & noexcept(false) {
+namespace {
+	class ModerationReader final : public liboai::SaxReader {
+		public:
+			explicit ModerationReader(liboai::ModerationResult& result) : result_(result) {}
+
+		protected:
+			void OnEnter(bool array) override {
+				if (!array && this->At({ "results", "#" })) {
+					this->result_.results.emplace_back();
+				}
+			}
+
+			void OnBoolean(bool value) override {
+				if (this->At({ "results", "#", "flagged" })) {
+					this->result_.results.back().flagged = value;
+				}
+				else if (this->At({ "results", "#", "categories", "*" })) {
+					this->result_.results.back().categories.emplace(this->Key(), value);
+				}
+			}
+
+			void OnNumber(double value) override {
+				if (this->At({ "results", "#", "category_scores", "*" })) {
+					this->result_.results.back().category_scores.emplace(this->Key(), value);
+				}
+			}
+
+			void OnString(std::string& value) override {
+				if (this->At({ "id" })) {
+					this->result_.id = std::move(value);
+				}
+				else if (this->At({ "model" })) {
+					this->result_.model = std::move(value);
+				}
+			}
+
+		private:
+			liboai::ModerationResult& result_;
+	};
+}
+
+liboai::ModerationResult liboai::ModerationResult::Parse(std::string_view json) noexcept(false) {
+	ModerationResult result;
+	ModerationReader reader(result);
+	reader.Parse(json);
+	return result;
+}
+
+template <class _Mode>
+typename _Mode::Result liboai::Moderations::Create(_Mode mode, const std::string& input, std::optional<std::string> model) const {
 	liboai::JsonConstructor jcon;
 	jcon.push_back("input", input);
 	jcon.push_back("model", std::move(model));
 	
-	Response res;
-	res = this->Request(
-		Method::HTTP_POST, this->openai_root_, "/moderations", "application/json",
+	return this->Send(
+		mode, Method::HTTP_POST, this->openai_root_, "/moderations", "application/json",
 		this->auth_.GetAuthorizationHeaders(),
 		netimpl::components::Body {
-			jcon.dump()
+			jcon.release()
 		},
 		this->auth_.GetProxies(),
 		this->auth_.GetProxyAuth(),
 		this->auth_.GetMaxTimeout()
 	);
+}
 
-	return res;
+liboai::Response liboai::Moderations::create(const std::string& input, std::optional<std::string> model) const & noexcept(false) {
+	return this->Create(Synchronous{}, input, std::move(model));
 }
 
 liboai::FutureResponse liboai::Moderations::create_async(const std::string& input, std::optional<std::string> model) const & noexcept(false) {
-	return std::async(std::launch::async, &liboai::Moderations::create, this, input, model);
+	return this->Create(Asynchronous{}, input, std::move(model));
 }
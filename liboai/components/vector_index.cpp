@@ -0,0 +1,751 @@
+#include "../include/components/vector_index.h"
+#include <cstring>
+#include <cmath>
+#include <fstream>
+#include <thread>
+#include <algorithm>
+#include <utility>
+
+#if defined(__x86_64__) || defined(_M_X64)
+	#define LIBOAI_VECTOR_X86
+	#include <immintrin.h>
+	#if defined(_MSC_VER) && !defined(__clang__)
+		#include <intrin.h>
+		#define LIBOAI_TARGET_AVX2
+		#define LIBOAI_TARGET_AVX512
+	#else
+		#define LIBOAI_TARGET_AVX2 __attribute__((target("avx2,fma,f16c")))
+		#define LIBOAI_TARGET_AVX512 __attribute__((target("avx512f")))
+	#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+	#define LIBOAI_VECTOR_NEON
+	#include <arm_neon.h>
+#endif
+
+#if defined(_WIN32)
+	#ifndef WIN32_LEAN_AND_MEAN
+		#define WIN32_LEAN_AND_MEAN
+	#endif
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif
+
+namespace {
+	constexpr char kMagic[8] = { 'L', 'I', 'B', 'O', 'A', 'I', 'V', 'I' };
+	constexpr uint32_t kVersion = 1;
+	constexpr uint32_t kByteOrder = 0x01020304;
+
+	// rows are padded to a multiple of this many elements, so that
+	// the kernels below never need to handle a tail
+	constexpr size_t kBlock = 64;
+
+	// a thread is worth starting for about this many bytes of rows
+	constexpr size_t kBytesPerThread = 4 << 20;
+
+	struct FileHeader {
+		char magic[8];
+		uint32_t version;
+		uint32_t byte_order;
+		uint32_t dimensions;
+		uint32_t metric;
+		uint32_t storage;
+		uint32_t reserved0;
+		uint64_t rows;
+		uint8_t reserved[24];
+	};
+
+	static_assert(sizeof(FileHeader) == 64, "file header must keep rows aligned");
+
+	[[noreturn]] void Fail(const std::string& what, liboai::exception::EType type, const char* where) {
+		throw liboai::exception::OpenAIException(what, type, where);
+	}
+
+	size_t ElementSize(liboai::VectorIndex::Storage storage) noexcept {
+		switch (storage) {
+			case liboai::VectorIndex::Storage::F16: return sizeof(uint16_t);
+			case liboai::VectorIndex::Storage::I8: return sizeof(int8_t);
+			default: return sizeof(float);
+		}
+	}
+
+	/*
+		IEEE half-precision conversions, rounding to nearest even,
+		after Fabian Giesen's public domain float_to_half_fast3_rtne
+		and half_to_float.
+	*/
+	uint32_t Bits(float value) noexcept {
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	float Float(uint32_t bits) noexcept {
+		float value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	uint16_t ToHalf(float value) noexcept {
+		const uint32_t infinity = 255u << 23, overflow = (127u + 16u) << 23;
+		const float denormal = Float(((127u - 15u) + (23u - 10u) + 1u) << 23);
+
+		uint32_t bits = Bits(value);
+		uint32_t sign = bits & 0x80000000u;
+		bits ^= sign;
+
+		uint16_t half;
+		if (bits >= overflow) {
+			half = bits > infinity ? 0x7E00 : 0x7C00;
+		}
+		else if (bits < (113u << 23)) {
+			half = static_cast<uint16_t>(Bits(Float(bits) + denormal) - Bits(denormal));
+		}
+		else {
+			uint32_t odd = (bits >> 13) & 1;
+			bits += ((15u - 127u) << 23) + 0xFFF;
+			bits += odd;
+			half = static_cast<uint16_t>(bits >> 13);
+		}
+		return static_cast<uint16_t>(half | (sign >> 16));
+	}
+
+	float FromHalf(uint16_t half) noexcept {
+		const float magic = Float(113u << 23);
+		const uint32_t exponent_mask = 0x7C00u << 13;
+
+		uint32_t bits = (half & 0x7FFFu) << 13;
+		uint32_t exponent = exponent_mask & bits;
+		bits += (127u - 15u) << 23;
+		if (exponent == exponent_mask) {
+			bits += (128u - 16u) << 23;
+		}
+		else if (exponent == 0) {
+			bits += 1u << 23;
+			bits = Bits(Float(bits) - magic);
+		}
+		return Float(bits | (static_cast<uint32_t>(half & 0x8000u) << 16));
+	}
+
+	/*
+		Each kernel returns the dot product of a float query with one
+		stored row of n elements, n being a multiple of kBlock.
+	*/
+	using Kernel = float (*)(const float* query, const uint8_t* row, size_t n);
+
+	float DotF32Scalar(const float* q, const uint8_t* row, size_t n) {
+		const float* v = reinterpret_cast<const float*>(row);
+		float sum[4] = {};
+		for (size_t i = 0; i < n; i += 4) {
+			sum[0] += q[i] * v[i];
+			sum[1] += q[i + 1] * v[i + 1];
+			sum[2] += q[i + 2] * v[i + 2];
+			sum[3] += q[i + 3] * v[i + 3];
+		}
+		return (sum[0] + sum[1]) + (sum[2] + sum[3]);
+	}
+
+	float DotF16Scalar(const float* q, const uint8_t* row, size_t n) {
+		const uint16_t* v = reinterpret_cast<const uint16_t*>(row);
+		float sum = 0.0f;
+		for (size_t i = 0; i < n; ++i) {
+			sum += q[i] * FromHalf(v[i]);
+		}
+		return sum;
+	}
+
+	float DotI8Scalar(const float* q, const uint8_t* row, size_t n) {
+		const int8_t* v = reinterpret_cast<const int8_t*>(row);
+		float sum = 0.0f;
+		for (size_t i = 0; i < n; ++i) {
+			sum += q[i] * static_cast<float>(v[i]);
+		}
+		return sum;
+	}
+
+#if defined(LIBOAI_VECTOR_X86)
+	bool HasAvx2() noexcept {
+		#if defined(_MSC_VER) && !defined(__clang__)
+			int info[4];
+			__cpuid(info, 0);
+			if (info[0] < 7) {
+				return false;
+			}
+
+			// FMA, F16C, and the OS saving the YMM registers
+			__cpuid(info, 1);
+			if ((info[2] & (1 << 12)) == 0 || (info[2] & (1 << 29)) == 0 || (info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (_xgetbv(0) & 6) != 6) {
+				return false;
+			}
+
+			__cpuidex(info, 7, 0);
+			return (info[1] & (1 << 5)) != 0;
+		#else
+			return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && __builtin_cpu_supports("f16c");
+		#endif
+	}
+
+	bool HasAvx512() noexcept {
+		#if defined(_MSC_VER) && !defined(__clang__)
+			if (!HasAvx2()) {
+				return false;
+			}
+
+			// the OS must also save the opmask and ZMM registers
+			int info[4];
+			__cpuidex(info, 7, 0);
+			return (info[1] & (1 << 16)) != 0 && (_xgetbv(0) & 0xE6) == 0xE6;
+		#else
+			return __builtin_cpu_supports("avx512f");
+		#endif
+	}
+
+	LIBOAI_TARGET_AVX2 float Sum(__m256 v) {
+		__m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+		s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+		s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+		return _mm_cvtss_f32(s);
+	}
+
+	LIBOAI_TARGET_AVX2 float DotF32Avx2(const float* q, const uint8_t* row, size_t n) {
+		const float* v = reinterpret_cast<const float*>(row);
+		__m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps(), a2 = _mm256_setzero_ps(), a3 = _mm256_setzero_ps();
+		for (size_t i = 0; i < n; i += 32) {
+			a0 = _mm256_fmadd_ps(_mm256_loadu_ps(q + i), _mm256_load_ps(v + i), a0);
+			a1 = _mm256_fmadd_ps(_mm256_loadu_ps(q + i + 8), _mm256_load_ps(v + i + 8), a1);
+			a2 = _mm256_fmadd_ps(_mm256_loadu_ps(q + i + 16), _mm256_load_ps(v + i + 16), a2);
+			a3 = _mm256_fmadd_ps(_mm256_loadu_ps(q + i + 24), _mm256_load_ps(v + i + 24), a3);
+		}
+		return Sum(_mm256_add_ps(_mm256_add_ps(a0, a1), _mm256_add_ps(a2, a3)));
+	}
+
+	LIBOAI_TARGET_AVX2 float DotF16Avx2(const float* q, const uint8_t* row, size_t n) {
+		const __m128i* v = reinterpret_cast<const __m128i*>(row);
+		__m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps(), a2 = _mm256_setzero_ps(), a3 = _mm256_setzero_ps();
+		for (size_t i = 0; i < n; i += 32, v += 4) {
+			a0 = _mm256_fmadd_ps(_mm256_loadu_ps(q + i), _mm256_cvtph_ps(_mm_load_si128(v)), a0);
+			a1 = _mm256_fmadd_ps(_mm256_loadu_ps(q + i + 8), _mm256_cvtph_ps(_mm_load_si128(v + 1)), a1);
+			a2 = _mm256_fmadd_ps(_mm256_loadu_ps(q + i + 16), _mm256_cvtph_ps(_mm_load_si128(v + 2)), a2);
+			a3 = _mm256_fmadd_ps(_mm256_loadu_ps(q + i + 24), _mm256_cvtph_ps(_mm_load_si128(v + 3)), a3);
+		}
+		return Sum(_mm256_add_ps(_mm256_add_ps(a0, a1), _mm256_add_ps(a2, a3)));
+	}
+
+	LIBOAI_TARGET_AVX2 float DotI8Avx2(const float* q, const uint8_t* row, size_t n) {
+		const __m128i* v = reinterpret_cast<const __m128i*>(row);
+		__m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps(), a2 = _mm256_setzero_ps(), a3 = _mm256_setzero_ps();
+		for (size_t i = 0; i < n; i += 32, v += 2) {
+			__m128i lo = _mm_load_si128(v), hi = _mm_load_si128(v + 1);
+			a0 = _mm256_fmadd_ps(_mm256_loadu_ps(q + i), _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(lo)), a0);
+			a1 = _mm256_fmadd_ps(_mm256_loadu_ps(q + i + 8), _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_unpackhi_epi64(lo, lo))), a1);
+			a2 = _mm256_fmadd_ps(_mm256_loadu_ps(q + i + 16), _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(hi)), a2);
+			a3 = _mm256_fmadd_ps(_mm256_loadu_ps(q + i + 24), _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_unpackhi_epi64(hi, hi))), a3);
+		}
+		return Sum(_mm256_add_ps(_mm256_add_ps(a0, a1), _mm256_add_ps(a2, a3)));
+	}
+
+	LIBOAI_TARGET_AVX512 float Sum(__m512 v) {
+		// summed as two halves through memory: GCC wrongly warns of an
+		// uninitialized value within _mm512_reduce_add_ps() and the
+		// 512-bit extracts, and _mm512_extractf32x8_ps() needs AVX512DQ
+		alignas(64) float lanes[16];
+		_mm512_store_ps(lanes, v);
+		return Sum(_mm256_add_ps(_mm256_load_ps(lanes), _mm256_load_ps(lanes + 8)));
+	}
+
+	LIBOAI_TARGET_AVX512 float DotF32Avx512(const float* q, const uint8_t* row, size_t n) {
+		const float* v = reinterpret_cast<const float*>(row);
+		__m512 a0 = _mm512_setzero_ps(), a1 = _mm512_setzero_ps(), a2 = _mm512_setzero_ps(), a3 = _mm512_setzero_ps();
+		for (size_t i = 0; i < n; i += 64) {
+			a0 = _mm512_fmadd_ps(_mm512_loadu_ps(q + i), _mm512_load_ps(v + i), a0);
+			a1 = _mm512_fmadd_ps(_mm512_loadu_ps(q + i + 16), _mm512_load_ps(v + i + 16), a1);
+			a2 = _mm512_fmadd_ps(_mm512_loadu_ps(q + i + 32), _mm512_load_ps(v + i + 32), a2);
+			a3 = _mm512_fmadd_ps(_mm512_loadu_ps(q + i + 48), _mm512_load_ps(v + i + 48), a3);
+		}
+		return Sum(_mm512_add_ps(_mm512_add_ps(a0, a1), _mm512_add_ps(a2, a3)));
+	}
+
+	// GCC warns of an uninitialized '__Y' within the AVX-512 widening
+	// conversions, which pass an undefined vector as the merge source
+	// of an unmasked operation; the warning is a false positive
+	#if defined(__GNUC__) && !defined(__clang__)
+		#pragma GCC diagnostic push
+		#pragma GCC diagnostic ignored "-Wuninitialized"
+		#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+	#endif
+
+	LIBOAI_TARGET_AVX512 float DotF16Avx512(const float* q, const uint8_t* row, size_t n) {
+		const __m256i* v = reinterpret_cast<const __m256i*>(row);
+		__m512 a0 = _mm512_setzero_ps(), a1 = _mm512_setzero_ps(), a2 = _mm512_setzero_ps(), a3 = _mm512_setzero_ps();
+		for (size_t i = 0; i < n; i += 64, v += 4) {
+			a0 = _mm512_fmadd_ps(_mm512_loadu_ps(q + i), _mm512_cvtph_ps(_mm256_load_si256(v)), a0);
+			a1 = _mm512_fmadd_ps(_mm512_loadu_ps(q + i + 16), _mm512_cvtph_ps(_mm256_load_si256(v + 1)), a1);
+			a2 = _mm512_fmadd_ps(_mm512_loadu_ps(q + i + 32), _mm512_cvtph_ps(_mm256_load_si256(v + 2)), a2);
+			a3 = _mm512_fmadd_ps(_mm512_loadu_ps(q + i + 48), _mm512_cvtph_ps(_mm256_load_si256(v + 3)), a3);
+		}
+		return Sum(_mm512_add_ps(_mm512_add_ps(a0, a1), _mm512_add_ps(a2, a3)));
+	}
+
+	LIBOAI_TARGET_AVX512 float DotI8Avx512(const float* q, const uint8_t* row, size_t n) {
+		const __m128i* v = reinterpret_cast<const __m128i*>(row);
+		__m512 a0 = _mm512_setzero_ps(), a1 = _mm512_setzero_ps(), a2 = _mm512_setzero_ps(), a3 = _mm512_setzero_ps();
+		for (size_t i = 0; i < n; i += 64, v += 4) {
+			a0 = _mm512_fmadd_ps(_mm512_loadu_ps(q + i), _mm512_cvtepi32_ps(_mm512_cvtepi8_epi32(_mm_load_si128(v))), a0);
+			a1 = _mm512_fmadd_ps(_mm512_loadu_ps(q + i + 16), _mm512_cvtepi32_ps(_mm512_cvtepi8_epi32(_mm_load_si128(v + 1))), a1);
+			a2 = _mm512_fmadd_ps(_mm512_loadu_ps(q + i + 32), _mm512_cvtepi32_ps(_mm512_cvtepi8_epi32(_mm_load_si128(v + 2))), a2);
+			a3 = _mm512_fmadd_ps(_mm512_loadu_ps(q + i + 48), _mm512_cvtepi32_ps(_mm512_cvtepi8_epi32(_mm_load_si128(v + 3))), a3);
+		}
+		return Sum(_mm512_add_ps(_mm512_add_ps(a0, a1), _mm512_add_ps(a2, a3)));
+	}
+
+	#if defined(__GNUC__) && !defined(__clang__)
+		#pragma GCC diagnostic pop
+	#endif
+#endif
+
+#if defined(LIBOAI_VECTOR_NEON)
+	float DotF32Neon(const float* q, const uint8_t* row, size_t n) {
+		const float* v = reinterpret_cast<const float*>(row);
+		float32x4_t a0 = vdupq_n_f32(0), a1 = vdupq_n_f32(0), a2 = vdupq_n_f32(0), a3 = vdupq_n_f32(0);
+		for (size_t i = 0; i < n; i += 16) {
+			a0 = vfmaq_f32(a0, vld1q_f32(q + i), vld1q_f32(v + i));
+			a1 = vfmaq_f32(a1, vld1q_f32(q + i + 4), vld1q_f32(v + i + 4));
+			a2 = vfmaq_f32(a2, vld1q_f32(q + i + 8), vld1q_f32(v + i + 8));
+			a3 = vfmaq_f32(a3, vld1q_f32(q + i + 12), vld1q_f32(v + i + 12));
+		}
+		return vaddvq_f32(vaddq_f32(vaddq_f32(a0, a1), vaddq_f32(a2, a3)));
+	}
+
+	float DotF16Neon(const float* q, const uint8_t* row, size_t n) {
+		const uint16_t* v = reinterpret_cast<const uint16_t*>(row);
+		float32x4_t a0 = vdupq_n_f32(0), a1 = vdupq_n_f32(0);
+		for (size_t i = 0; i < n; i += 8) {
+			float16x8_t h = vreinterpretq_f16_u16(vld1q_u16(v + i));
+			a0 = vfmaq_f32(a0, vld1q_f32(q + i), vcvt_f32_f16(vget_low_f16(h)));
+			a1 = vfmaq_f32(a1, vld1q_f32(q + i + 4), vcvt_high_f32_f16(h));
+		}
+		return vaddvq_f32(vaddq_f32(a0, a1));
+	}
+
+	float DotI8Neon(const float* q, const uint8_t* row, size_t n) {
+		const int8_t* v = reinterpret_cast<const int8_t*>(row);
+		float32x4_t a0 = vdupq_n_f32(0), a1 = vdupq_n_f32(0), a2 = vdupq_n_f32(0), a3 = vdupq_n_f32(0);
+		for (size_t i = 0; i < n; i += 16) {
+			int8x16_t b = vld1q_s8(v + i);
+			int16x8_t lo = vmovl_s8(vget_low_s8(b)), hi = vmovl_high_s8(b);
+			a0 = vfmaq_f32(a0, vld1q_f32(q + i), vcvtq_f32_s32(vmovl_s16(vget_low_s16(lo))));
+			a1 = vfmaq_f32(a1, vld1q_f32(q + i + 4), vcvtq_f32_s32(vmovl_high_s16(lo)));
+			a2 = vfmaq_f32(a2, vld1q_f32(q + i + 8), vcvtq_f32_s32(vmovl_s16(vget_low_s16(hi))));
+			a3 = vfmaq_f32(a3, vld1q_f32(q + i + 12), vcvtq_f32_s32(vmovl_high_s16(hi)));
+		}
+		return vaddvq_f32(vaddq_f32(vaddq_f32(a0, a1), vaddq_f32(a2, a3)));
+	}
+#endif
+
+	/*
+		The kernel for each storage type, chosen once for the
+		processor the library is running on.
+	*/
+	struct Kernels {
+		Kernel dot[3];
+
+		Kernels() noexcept : dot{ DotF32Scalar, DotF16Scalar, DotI8Scalar } {
+			#if defined(LIBOAI_VECTOR_X86)
+				if (HasAvx512()) {
+					this->dot[0] = DotF32Avx512;
+					this->dot[1] = DotF16Avx512;
+					this->dot[2] = DotI8Avx512;
+				}
+				else if (HasAvx2()) {
+					this->dot[0] = DotF32Avx2;
+					this->dot[1] = DotF16Avx2;
+					this->dot[2] = DotI8Avx2;
+				}
+			#elif defined(LIBOAI_VECTOR_NEON)
+				this->dot[0] = DotF32Neon;
+				this->dot[1] = DotF16Neon;
+				this->dot[2] = DotI8Neon;
+			#endif
+		}
+	};
+
+	Kernel KernelFor(liboai::VectorIndex::Storage storage) noexcept {
+		static const Kernels kernels;
+		return kernels.dot[static_cast<uint32_t>(storage)];
+	}
+
+	bool Better(const liboai::VectorIndex::Match& a, const liboai::VectorIndex::Match& b) noexcept {
+		return a.score > b.score || (a.score == b.score && a.id < b.id);
+	}
+
+	// scales vector to unit length; zero vectors are left as they are
+	void Normalize(float* vector, size_t n) noexcept {
+		double norm = 0.0;
+		for (size_t i = 0; i < n; ++i) {
+			norm += static_cast<double>(vector[i]) * vector[i];
+		}
+		if (norm > 0.0) {
+			float scale = static_cast<float>(1.0 / std::sqrt(norm));
+			for (size_t i = 0; i < n; ++i) {
+				vector[i] *= scale;
+			}
+		}
+	}
+}
+
+/*
+	A read-only mapping of a saved index.
+*/
+struct liboai::VectorIndex::Mapping {
+	const uint8_t* data = nullptr;
+	uint64_t size = 0;
+
+	#if defined(_WIN32)
+		HANDLE file = INVALID_HANDLE_VALUE, mapping = nullptr;
+
+		explicit Mapping(const std::filesystem::path& path) {
+			this->file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			LARGE_INTEGER size;
+			if (this->file == INVALID_HANDLE_VALUE || !GetFileSizeEx(this->file, &size)) {
+				this->Close();
+				Fail("Failed to open vector index " + path.string(), liboai::exception::EType::E_FILEERROR, "liboai::VectorIndex::Load()");
+			}
+			this->size = static_cast<uint64_t>(size.QuadPart);
+
+			this->mapping = this->size ? CreateFileMappingW(this->file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+			void* view = this->mapping ? MapViewOfFile(this->mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+			if (!view) {
+				this->Close();
+				Fail("Failed to map vector index " + path.string(), liboai::exception::EType::E_FILEERROR, "liboai::VectorIndex::Load()");
+			}
+			this->data = static_cast<const uint8_t*>(view);
+		}
+
+		void Close() noexcept {
+			if (this->data) {
+				UnmapViewOfFile(this->data);
+			}
+			if (this->mapping) {
+				CloseHandle(this->mapping);
+			}
+			if (this->file != INVALID_HANDLE_VALUE) {
+				CloseHandle(this->file);
+			}
+		}
+	#else
+		explicit Mapping(const std::filesystem::path& path) {
+			int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+			struct stat info;
+			if (fd < 0 || ::fstat(fd, &info) != 0) {
+				if (fd >= 0) {
+					::close(fd);
+				}
+				Fail("Failed to open vector index " + path.string(), liboai::exception::EType::E_FILEERROR, "liboai::VectorIndex::Load()");
+			}
+			this->size = static_cast<uint64_t>(info.st_size);
+
+			// the mapping holds its own reference to the file
+			void* map = this->size ? ::mmap(nullptr, this->size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+			::close(fd);
+			if (map == MAP_FAILED) {
+				Fail("Failed to map vector index " + path.string(), liboai::exception::EType::E_FILEERROR, "liboai::VectorIndex::Load()");
+			}
+			this->data = static_cast<const uint8_t*>(map);
+		}
+
+		void Close() noexcept {
+			if (this->data) {
+				::munmap(const_cast<uint8_t*>(this->data), this->size);
+			}
+		}
+	#endif
+
+	~Mapping() { this->Close(); }
+	NON_COPYABLE(Mapping)
+	NON_MOVABLE(Mapping)
+};
+
+liboai::VectorIndex::VectorIndex(uint32_t dimensions, Metric metric, Storage storage) noexcept(false)
+	: dimensions_(dimensions), metric_(metric), storage_(storage) {
+	if (dimensions == 0 || static_cast<uint32_t>(storage) > static_cast<uint32_t>(Storage::I8) || static_cast<uint32_t>(metric) > static_cast<uint32_t>(Metric::COSINE)) {
+		Fail("Invalid vector index parameters", liboai::exception::EType::E_BADREQUEST, "liboai::VectorIndex::VectorIndex()");
+	}
+
+	this->padded_ = (dimensions + kBlock - 1) / kBlock * kBlock;
+	this->stride_ = this->padded_ * ElementSize(storage);
+}
+
+liboai::VectorIndex::VectorIndex(VectorIndex&& old) noexcept
+	: dimensions_(old.dimensions_), metric_(old.metric_), storage_(old.storage_),
+	  padded_(old.padded_), stride_(old.stride_),
+	  rows_(std::exchange(old.rows_, 0)), capacity_(std::exchange(old.capacity_, 0)),
+	  owned_(std::move(old.owned_)), data_(std::exchange(old.data_, nullptr)),
+	  scales_(std::move(old.scales_)), mapping_(std::move(old.mapping_)) {}
+
+liboai::VectorIndex& liboai::VectorIndex::operator=(VectorIndex&& old) noexcept {
+	if (this != &old) {
+		this->dimensions_ = old.dimensions_;
+		this->metric_ = old.metric_;
+		this->storage_ = old.storage_;
+		this->padded_ = old.padded_;
+		this->stride_ = old.stride_;
+		this->rows_ = std::exchange(old.rows_, 0);
+		this->capacity_ = std::exchange(old.capacity_, 0);
+		this->owned_ = std::move(old.owned_);
+		this->data_ = std::exchange(old.data_, nullptr);
+		this->scales_ = std::move(old.scales_);
+		this->mapping_ = std::move(old.mapping_);
+	}
+	return *this;
+}
+
+liboai::VectorIndex::~VectorIndex() = default;
+
+void liboai::VectorIndex::Reserve(size_t vectors) noexcept(false) {
+	if (vectors <= this->capacity_) {
+		return;
+	}
+
+	// a loaded index is copied out of its mapping on first growth
+	std::unique_ptr<uint8_t[], Free> owned(static_cast<uint8_t*>(::operator new(vectors * this->stride_, std::align_val_t(alignment))));
+	if (this->rows_ != 0) {
+		std::memcpy(owned.get(), this->data_, this->rows_ * this->stride_);
+	}
+	if (this->storage_ == Storage::I8) {
+		this->scales_.reserve(vectors);
+	}
+
+	this->owned_ = std::move(owned);
+	this->data_ = this->owned_.get();
+	this->capacity_ = vectors;
+	this->mapping_.reset();
+}
+
+void liboai::VectorIndex::Encode(const float* vector, uint8_t* row, float& scale) const noexcept {
+	scale = 1.0f;
+	switch (this->storage_) {
+		case Storage::F32:
+			std::memcpy(row, vector, this->padded_ * sizeof(float));
+			break;
+
+		case Storage::F16: {
+			uint16_t* out = reinterpret_cast<uint16_t*>(row);
+			for (size_t i = 0; i < this->padded_; ++i) {
+				// saturate rather than overflow to infinity
+				out[i] = ToHalf(std::clamp(vector[i], -65504.0f, 65504.0f));
+			}
+			break;
+		}
+
+		case Storage::I8: {
+			float max = 0.0f;
+			for (size_t i = 0; i < this->dimensions_; ++i) {
+				max = std::max(max, std::fabs(vector[i]));
+			}
+			scale = max > 0.0f ? max / 127.0f : 1.0f;
+
+			int8_t* out = reinterpret_cast<int8_t*>(row);
+			for (size_t i = 0; i < this->padded_; ++i) {
+				out[i] = static_cast<int8_t>(std::lrint(std::clamp(vector[i] / scale, -127.0f, 127.0f)));
+			}
+			break;
+		}
+	}
+}
+
+uint64_t liboai::VectorIndex::Add(Span<const float> vector) noexcept(false) {
+	if (vector.size() != this->dimensions_) {
+		Fail(
+			"Vector has " + std::to_string(vector.size()) + " dimensions; the index has " + std::to_string(this->dimensions_),
+			liboai::exception::EType::E_BADREQUEST,
+			"liboai::VectorIndex::Add()"
+		);
+	}
+
+	if (this->rows_ >= this->capacity_) {
+		this->Reserve(std::max<size_t>(64, this->rows_ * 2));
+	}
+
+	std::vector<float> padded(this->padded_, 0.0f);
+	std::copy(vector.begin(), vector.end(), padded.begin());
+	if (this->metric_ == Metric::COSINE) {
+		Normalize(padded.data(), this->dimensions_);
+	}
+
+	float scale;
+	this->Encode(padded.data(), this->owned_.get() + this->rows_ * this->stride_, scale);
+	if (this->storage_ == Storage::I8) {
+		this->scales_.push_back(scale);
+	}
+
+	return this->rows_++;
+}
+
+uint64_t liboai::VectorIndex::Add(const EmbeddingMatrix& matrix) noexcept(false) {
+	uint64_t first = this->rows_;
+	this->Reserve(this->rows_ + matrix.Rows());
+	for (size_t i = 0; i < matrix.Rows(); ++i) {
+		this->Add(matrix.Row(i));
+	}
+	return first;
+}
+
+uint64_t liboai::VectorIndex::Add(const EmbeddingResult& result) noexcept(false) {
+	uint64_t first = this->rows_;
+	this->Reserve(this->rows_ + result.data.size());
+	for (const EmbeddingResult::Embedding& embedding : result.data) {
+		this->Add(Span<const float>(embedding.embedding.data(), embedding.embedding.size()));
+	}
+	return first;
+}
+
+void liboai::VectorIndex::Scan(const float* query, size_t begin, size_t end, size_t k, std::vector<Match>& out) const noexcept {
+	Kernel dot = KernelFor(this->storage_);
+
+	// a heap of the best k so far, with the worst of them on top
+	out.clear();
+	for (size_t i = begin; i < end; ++i) {
+		float score = dot(query, this->data_ + i * this->stride_, this->padded_);
+		if (this->storage_ == Storage::I8) {
+			score *= this->scales_[i];
+		}
+		if (std::isnan(score)) {
+			continue;
+		}
+
+		Match match{ i, score };
+		if (out.size() < k) {
+			out.push_back(match);
+			std::push_heap(out.begin(), out.end(), Better);
+		}
+		else if (Better(match, out.front())) {
+			std::pop_heap(out.begin(), out.end(), Better);
+			out.back() = match;
+			std::push_heap(out.begin(), out.end(), Better);
+		}
+	}
+}
+
+std::vector<liboai::VectorIndex::Match> liboai::VectorIndex::Search(Span<const float> query, size_t k, size_t threads) const noexcept(false) {
+	if (query.size() != this->dimensions_) {
+		Fail(
+			"Query has " + std::to_string(query.size()) + " dimensions; the index has " + std::to_string(this->dimensions_),
+			liboai::exception::EType::E_BADREQUEST,
+			"liboai::VectorIndex::Search()"
+		);
+	}
+
+	k = std::min(k, this->rows_);
+	if (k == 0) {
+		return {};
+	}
+
+	std::vector<float> padded(this->padded_, 0.0f);
+	std::copy(query.begin(), query.end(), padded.begin());
+	if (this->metric_ == Metric::COSINE) {
+		Normalize(padded.data(), this->dimensions_);
+	}
+
+	if (threads == 0) {
+		threads = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), this->rows_ * this->stride_ / kBytesPerThread));
+	}
+	threads = std::min(threads, this->rows_);
+
+	// each thread keeps the best k of its own share of the rows
+	std::vector<std::vector<Match>> best(threads);
+	for (std::vector<Match>& matches : best) {
+		matches.reserve(k);
+	}
+
+	size_t share = (this->rows_ + threads - 1) / threads;
+	std::vector<std::thread> workers;
+	workers.reserve(threads - 1);
+	for (size_t t = 1; t < threads; ++t) {
+		workers.emplace_back([&, t] {
+			this->Scan(padded.data(), std::min(t * share, this->rows_), std::min((t + 1) * share, this->rows_), k, best[t]);
+		});
+	}
+	this->Scan(padded.data(), 0, std::min(share, this->rows_), k, best[0]);
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+
+	std::vector<Match> matches = std::move(best[0]);
+	for (size_t t = 1; t < threads; ++t) {
+		matches.insert(matches.end(), best[t].begin(), best[t].end());
+	}
+
+	k = std::min(k, matches.size());
+	std::partial_sort(matches.begin(), matches.begin() + k, matches.end(), Better);
+	matches.resize(k);
+	return matches;
+}
+
+void liboai::VectorIndex::Save(const std::filesystem::path& path) const noexcept(false) {
+	FileHeader header{};
+	std::memcpy(header.magic, kMagic, sizeof(kMagic));
+	header.version = kVersion;
+	header.byte_order = kByteOrder;
+	header.dimensions = this->dimensions_;
+	header.metric = static_cast<uint32_t>(this->metric_);
+	header.storage = static_cast<uint32_t>(this->storage_);
+	header.rows = this->rows_;
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	if (this->rows_ != 0) {
+		file.write(reinterpret_cast<const char*>(this->data_), static_cast<std::streamsize>(this->rows_ * this->stride_));
+	}
+	if (this->storage_ == Storage::I8) {
+		file.write(reinterpret_cast<const char*>(this->scales_.data()), static_cast<std::streamsize>(this->scales_.size() * sizeof(float)));
+	}
+	file.close();
+
+	if (!file) {
+		Fail("Failed to write vector index " + path.string(), liboai::exception::EType::E_FILEERROR, "liboai::VectorIndex::Save()");
+	}
+}
+
+liboai::VectorIndex liboai::VectorIndex::Load(const std::filesystem::path& path) noexcept(false) {
+	auto mapping = std::make_unique<Mapping>(path);
+
+	FileHeader header;
+	if (mapping->size < sizeof(header)) {
+		Fail(path.string() + " is not a vector index", liboai::exception::EType::E_FILEERROR, "liboai::VectorIndex::Load()");
+	}
+	std::memcpy(&header, mapping->data, sizeof(header));
+	if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion) {
+		Fail(path.string() + " is not a vector index", liboai::exception::EType::E_FILEERROR, "liboai::VectorIndex::Load()");
+	}
+	if (header.byte_order != kByteOrder) {
+		Fail(path.string() + " was written on a machine of different byte order", liboai::exception::EType::E_FILEERROR, "liboai::VectorIndex::Load()");
+	}
+	if (header.dimensions == 0 || header.metric > static_cast<uint32_t>(Metric::COSINE) || header.storage > static_cast<uint32_t>(Storage::I8)) {
+		Fail(path.string() + " is not a vector index", liboai::exception::EType::E_FILEERROR, "liboai::VectorIndex::Load()");
+	}
+
+	VectorIndex index(header.dimensions, static_cast<Metric>(header.metric), static_cast<Storage>(header.storage));
+
+	uint64_t rows = header.rows;
+	uint64_t scales = index.storage_ == Storage::I8 ? rows * sizeof(float) : 0;
+	if (rows > (mapping->size - sizeof(header)) / index.stride_ || mapping->size - sizeof(header) - rows * index.stride_ < scales) {
+		Fail(path.string() + " is truncated", liboai::exception::EType::E_FILEERROR, "liboai::VectorIndex::Load()");
+	}
+
+	const uint8_t* data = mapping->data + sizeof(header);
+	if (scales != 0) {
+		const float* begin = reinterpret_cast<const float*>(data + rows * index.stride_);
+		index.scales_.assign(begin, begin + rows);
+	}
+
+	index.data_ = data;
+	index.rows_ = static_cast<size_t>(rows);
+	index.mapping_ = std::move(mapping);
+	return index;
+}
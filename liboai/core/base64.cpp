@@ -0,0 +1,295 @@
+#include "../include/core/base64.h"
+#include <atomic>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+	#define LIBOAI_BASE64_AVX2
+	#include <immintrin.h>
+	#if defined(_MSC_VER) && !defined(__clang__)
+		#include <intrin.h>
+		#define LIBOAI_TARGET_AVX2
+	#else
+		#define LIBOAI_TARGET_AVX2 __attribute__((target("avx2")))
+	#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+	#define LIBOAI_BASE64_NEON
+	#include <arm_neon.h>
+#endif
+
+namespace {
+	std::atomic<bool> _simd{ true };
+
+	constexpr uint8_t kInvalid = 0xFF;
+
+	struct DecodeTable {
+		uint8_t values[256] = {};
+
+		constexpr DecodeTable() {
+			for (int i = 0; i < 256; ++i) {
+				values[i] = kInvalid;
+			}
+			for (int i = 0; i < 26; ++i) {
+				values['A' + i] = static_cast<uint8_t>(i);
+				values['a' + i] = static_cast<uint8_t>(26 + i);
+			}
+			for (int i = 0; i < 10; ++i) {
+				values['0' + i] = static_cast<uint8_t>(52 + i);
+			}
+			values['+'] = 62;
+			values['/'] = 63;
+		}
+	};
+
+	constexpr DecodeTable kTable;
+
+	// strips up to two '=' characters of padding from a whole
+	// number of quads, leaving the significant characters
+	size_t Significant(std::string_view in) noexcept {
+		size_t n = in.size();
+		if (n != 0 && n % 4 == 0 && in[n - 1] == '=') {
+			--n;
+			if (in[n - 1] == '=') {
+				--n;
+			}
+		}
+		return n;
+	}
+
+	bool DecodeScalar(const char* s, size_t n, uint8_t* o) noexcept {
+		const uint8_t* in = reinterpret_cast<const uint8_t*>(s);
+
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			uint32_t a = kTable.values[in[i]], b = kTable.values[in[i + 1]],
+				c = kTable.values[in[i + 2]], d = kTable.values[in[i + 3]];
+			if ((a | b | c | d) & 0x80) {
+				return false;
+			}
+
+			uint32_t v = (a << 18) | (b << 12) | (c << 6) | d;
+			o[0] = static_cast<uint8_t>(v >> 16);
+			o[1] = static_cast<uint8_t>(v >> 8);
+			o[2] = static_cast<uint8_t>(v);
+			o += 3;
+		}
+
+		// a final partial quad of two or three characters
+		size_t rem = n - i;
+		if (rem >= 2) {
+			uint32_t a = kTable.values[in[i]], b = kTable.values[in[i + 1]],
+				c = rem == 3 ? kTable.values[in[i + 2]] : 0;
+			if ((a | b | c) & 0x80) {
+				return false;
+			}
+
+			uint32_t v = (a << 18) | (b << 12) | (c << 6);
+			o[0] = static_cast<uint8_t>(v >> 16);
+			if (rem == 3) {
+				o[1] = static_cast<uint8_t>(v >> 8);
+			}
+		}
+
+		return true;
+	}
+
+#if defined(LIBOAI_BASE64_AVX2)
+	bool HasAvx2() noexcept {
+		#if defined(_MSC_VER) && !defined(__clang__)
+			int info[4];
+			__cpuid(info, 0);
+			if (info[0] < 7) {
+				return false;
+			}
+
+			// AVX2 also needs the OS to save the YMM registers
+			__cpuid(info, 1);
+			if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (_xgetbv(0) & 6) != 6) {
+				return false;
+			}
+
+			__cpuidex(info, 7, 0);
+			return (info[1] & (1 << 5)) != 0;
+		#else
+			return __builtin_cpu_supports("avx2");
+		#endif
+	}
+
+	/*
+		Decodes 32 characters into 24 bytes per iteration using the
+		nibble-lookup method of Wojciech Mula and Daniel Lemire:
+		each character's high and low nibbles index two tables whose
+		entries only intersect for invalid characters, and a third
+		table supplies the offset from character to 6-bit value.
+
+		Each iteration stores a full 32 bytes, so blocks are only
+		decoded while that much output space remains. Returns the
+		number of characters decoded, stopping early at a block that
+		holds an invalid character so the scalar decoder can reject it.
+	*/
+	LIBOAI_TARGET_AVX2 size_t DecodeAvx2(const char* s, size_t n, uint8_t* o, size_t out_size) noexcept {
+		const __m256i lut_lo = _mm256_setr_epi8(
+			0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+			0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A
+		);
+		const __m256i lut_hi = _mm256_setr_epi8(
+			0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+			0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10
+		);
+		const __m256i lut_roll = _mm256_setr_epi8(
+			0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+			0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0
+		);
+		const __m256i mask_2f = _mm256_set1_epi8(0x2F);
+		const __m256i pack_shuffle = _mm256_setr_epi8(
+			2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+			2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1
+		);
+		const __m256i pack_permute = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, -1, -1);
+
+		size_t i = 0, written = 0;
+		while (i + 32 <= n && written + 32 <= out_size) {
+			__m256i str = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+
+			const __m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(str, 4), mask_2f);
+			const __m256i lo_nibbles = _mm256_and_si256(str, mask_2f);
+			const __m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+			const __m256i lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+			if (!_mm256_testz_si256(lo, hi)) {
+				break;
+			}
+
+			// '/' shares its high nibble with '+'; step it back one entry
+			const __m256i eq_2f = _mm256_cmpeq_epi8(str, mask_2f);
+			const __m256i roll = _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(eq_2f, hi_nibbles));
+			str = _mm256_add_epi8(str, roll);
+
+			// pack four 6-bit values per 32-bit lane into 3 bytes,
+			// then the two lanes' 12 bytes into the low 24
+			const __m256i merged = _mm256_maddubs_epi16(str, _mm256_set1_epi32(0x01400140));
+			__m256i out = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+			out = _mm256_shuffle_epi8(out, pack_shuffle);
+			out = _mm256_permutevar8x32_epi32(out, pack_permute);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(o + written), out);
+
+			i += 32;
+			written += 24;
+		}
+
+		return i;
+	}
+#endif
+
+#if defined(LIBOAI_BASE64_NEON)
+	/*
+		Decodes 64 characters into 48 bytes per iteration. The
+		characters are de-interleaved into four vectors, one per
+		position in a quad, translated with the same nibble-lookup
+		tables as the x86 decoder, and re-interleaved on store.
+		Returns the number of characters decoded, stopping early at
+		a block that holds an invalid character.
+	*/
+	size_t DecodeNeon(const char* s, size_t n, uint8_t* o) noexcept {
+		static const uint8_t lut_lo_bytes[16] = {
+			0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A
+		};
+		static const uint8_t lut_hi_bytes[16] = {
+			0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10
+		};
+		static const uint8_t lut_roll_bytes[16] = {
+			0, 16, 19, 4, 191, 191, 185, 185, 0, 0, 0, 0, 0, 0, 0, 0
+		};
+
+		const uint8x16_t lut_lo = vld1q_u8(lut_lo_bytes);
+		const uint8x16_t lut_hi = vld1q_u8(lut_hi_bytes);
+		const uint8x16_t lut_roll = vld1q_u8(lut_roll_bytes);
+		const uint8x16_t mask_0f = vdupq_n_u8(0x0F);
+		const uint8x16_t char_2f = vdupq_n_u8(0x2F);
+
+		auto translate = [&](uint8x16_t str, uint8x16_t& invalid) {
+			const uint8x16_t hi_nibbles = vshrq_n_u8(str, 4);
+			const uint8x16_t lo_nibbles = vandq_u8(str, mask_0f);
+			invalid = vorrq_u8(invalid, vandq_u8(vqtbl1q_u8(lut_lo, lo_nibbles), vqtbl1q_u8(lut_hi, hi_nibbles)));
+
+			const uint8x16_t eq_2f = vceqq_u8(str, char_2f);
+			return vaddq_u8(str, vqtbl1q_u8(lut_roll, vaddq_u8(eq_2f, hi_nibbles)));
+		};
+
+		size_t i = 0;
+		for (; i + 64 <= n; i += 64) {
+			uint8x16x4_t str = vld4q_u8(reinterpret_cast<const uint8_t*>(s + i));
+
+			uint8x16_t invalid = vdupq_n_u8(0);
+			const uint8x16_t a = translate(str.val[0], invalid);
+			const uint8x16_t b = translate(str.val[1], invalid);
+			const uint8x16_t c = translate(str.val[2], invalid);
+			const uint8x16_t d = translate(str.val[3], invalid);
+			if (vmaxvq_u8(invalid) != 0) {
+				break;
+			}
+
+			uint8x16x3_t out;
+			out.val[0] = vorrq_u8(vshlq_n_u8(a, 2), vshrq_n_u8(b, 4));
+			out.val[1] = vorrq_u8(vshlq_n_u8(b, 4), vshrq_n_u8(c, 2));
+			out.val[2] = vorrq_u8(vshlq_n_u8(c, 6), d);
+			vst3q_u8(o + i / 4 * 3, out);
+		}
+
+		return i;
+	}
+#endif
+}
+
+size_t liboai::Base64::DecodedSize(std::string_view in) noexcept {
+	size_t n = Significant(in);
+	if (n % 4 == 1) {
+		return npos;
+	}
+	return n / 4 * 3 + (n % 4 == 0 ? 0 : n % 4 - 1);
+}
+
+bool liboai::Base64::Decode(std::string_view in, uint8_t* out) noexcept {
+	size_t n = Significant(in);
+	if (n % 4 == 1) {
+		return false;
+	}
+
+	size_t done = 0;
+	#if defined(LIBOAI_BASE64_AVX2)
+		static const bool avx2 = HasAvx2();
+		if (avx2 && _simd.load(std::memory_order_relaxed)) {
+			done = DecodeAvx2(in.data(), n, out, DecodedSize(in));
+		}
+	#elif defined(LIBOAI_BASE64_NEON)
+		if (_simd.load(std::memory_order_relaxed)) {
+			done = DecodeNeon(in.data(), n, out);
+		}
+	#endif
+
+	return DecodeScalar(in.data() + done, n - done, out + done / 4 * 3);
+}
+
+bool liboai::Base64::DecodeFloats(std::string_view in, float* out, size_t count) noexcept {
+	if (FloatCount(in) != count || !Decode(in, reinterpret_cast<uint8_t*>(out))) {
+		return false;
+	}
+
+	#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+		// the payload is little-endian
+		for (size_t i = 0; i < count; ++i) {
+			uint32_t bits;
+			std::memcpy(&bits, out + i, sizeof(bits));
+			bits = __builtin_bswap32(bits);
+			std::memcpy(out + i, &bits, sizeof(bits));
+		}
+	#endif
+
+	return true;
+}
+
+void liboai::Base64::SetSimd(bool enabled) noexcept {
+	_simd.store(enabled, std::memory_order_relaxed);
+}
+
+bool liboai::Base64::Simd() noexcept {
+	return _simd.load(std::memory_order_relaxed);
+}
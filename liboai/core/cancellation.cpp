@@ -0,0 +1,55 @@
+#include "../include/core/cancellation.h"
+#include "../include/core/netimpl.h"
+#include "../include/core/scope.h"
+
+namespace {
+	using Scopes = liboai::ScopeStack<liboai::CancellationScope>;
+}
+
+void liboai::CancellationToken::Cancel() noexcept {
+	if (!this->state_->cancelled.exchange(true, std::memory_order_acq_rel)) {
+		// transfers check the token whenever their loop runs; idle
+		// loops are woken so that they do so at once
+		netimpl::MultiEngine::Engine().Wake();
+		this->Notify();
+	}
+}
+
+bool liboai::CancellationToken::Wait(std::optional<std::chrono::steady_clock::time_point> until, const std::function<bool()>& done) const {
+	State& state = *this->state_;
+	auto over = [&state, &done]() { return state.cancelled.load(std::memory_order_acquire) || (done && done()); };
+
+	std::unique_lock<std::mutex> lock(state.mutex);
+	if (until) {
+		state.changed.wait_until(lock, until.value(), over);
+	}
+	else {
+		state.changed.wait(lock, over);
+	}
+	return !state.cancelled.load(std::memory_order_acquire);
+}
+
+void liboai::CancellationToken::Notify() const noexcept {
+	// taking the lock orders the notification after any waiter's
+	// check of its condition, so that none is missed
+	{
+		std::lock_guard<std::mutex> lock(this->state_->mutex);
+	}
+	this->state_->changed.notify_all();
+}
+
+std::optional<liboai::CancellationToken> liboai::CancellationToken::Current() noexcept {
+	if (const CancellationScope* scope = Scopes::Innermost()) {
+		return scope->token_;
+	}
+	return std::nullopt;
+}
+
+liboai::CancellationScope::CancellationScope(CancellationToken token) noexcept
+	: token_(std::move(token)), outer_(Scopes::Innermost()) {
+	Scopes::Innermost() = this;
+}
+
+liboai::CancellationScope::~CancellationScope() {
+	Scopes::Innermost() = this->outer_;
+}
@@ -0,0 +1,184 @@
+#include "../include/core/circuit_breaker.h"
+#include "../include/core/active.h"
+#include <algorithm>
+
+liboai::CircuitBreaker::CircuitBreaker(CircuitBreakerOptions options) noexcept : options_(options) {}
+
+std::string liboai::CircuitBreaker::KeyOf(std::string_view url) {
+	size_t start = url.find("://");
+	start = (start == std::string_view::npos) ? 0 : start + 3;
+
+	size_t path = std::min(url.find_first_of("/?#", start), url.size());
+	size_t end = std::min(url.find_first_of("?#", path), url.size());
+
+	// scheme and host are case-insensitive, the path is not
+	std::string key(url.substr(0, end));
+	std::transform(key.begin(), key.begin() + static_cast<ptrdiff_t>(path), key.begin(),
+		[](unsigned char c) { return static_cast<char>(std::tolower(c)); }
+	);
+	return key;
+}
+
+liboai::CircuitBreaker::Outcome liboai::CircuitBreaker::OutcomeOf(const netimpl::Session& session) noexcept {
+	if (session.Cancelled()) {
+		return Outcome::ABANDONED;
+	}
+
+	long status_code = session.StatusCode();
+	if (status_code != 0) {
+		return status_code >= 500 ? Outcome::FAILED : Outcome::SUCCEEDED;
+	}
+
+	// no response: the transfer failed, or was never made
+	return session.Result() != CURLE_OK ? Outcome::FAILED : Outcome::ABANDONED;
+}
+
+liboai::CircuitBreaker::Permit liboai::CircuitBreaker::Admit(std::string_view url) noexcept(false) {
+	Permit permit{ CircuitBreaker::KeyOf(url) };
+	std::optional<Transition> transition;
+	bool rejected = false;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex_);
+		auto found = this->circuits_.find(permit.key);
+		if (found != this->circuits_.end()) {
+			Entry& entry = found->second;
+			if (entry.circuit == Circuit::OPEN && std::chrono::steady_clock::now() - entry.opened >= this->options_.open_duration) {
+				entry.circuit = Circuit::HALF_OPEN;
+				entry.probe = ++this->periods_;
+				entry.probing = entry.probed = 0;
+				++this->stats_.half_opened;
+				transition = Transition{ permit.key, Circuit::OPEN, Circuit::HALF_OPEN, entry.failures };
+			}
+
+			if (entry.circuit == Circuit::HALF_OPEN && entry.probing + entry.probed < std::max<uint32_t>(1, this->options_.half_open_probes)) {
+				++entry.probing;
+				permit.probe = entry.probe;
+			}
+			else if (entry.circuit != Circuit::CLOSED) {
+				rejected = true;
+			}
+		}
+
+		++(rejected ? this->stats_.rejected : this->stats_.admitted);
+	}
+
+	this->Notify(transition);
+	if (rejected) {
+		throw liboai::exception::OpenAICircuitOpen(
+			"Circuit open for " + permit.key + "; failing fast",
+			liboai::exception::EType::E_CIRCUITOPEN,
+			"liboai::CircuitBreaker::Admit()"
+		);
+	}
+	return permit;
+}
+
+void liboai::CircuitBreaker::Report(const Permit& permit, Outcome outcome) noexcept {
+	std::optional<Transition> transition;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex_);
+		auto found = this->circuits_.find(permit.key);
+
+		if (permit.probe != 0) {
+			// a probe only counts towards the half-open period it was
+			// let through in
+			if (found == this->circuits_.end() || found->second.circuit != Circuit::HALF_OPEN || found->second.probe != permit.probe) {
+				return;
+			}
+
+			Entry& entry = found->second;
+			--entry.probing;
+			if (outcome == Outcome::SUCCEEDED && ++entry.probed >= std::max<uint32_t>(1, this->options_.half_open_probes)) {
+				++this->stats_.closed;
+				transition = Transition{ permit.key, Circuit::HALF_OPEN, Circuit::CLOSED, 0 };
+				this->circuits_.erase(found);
+			}
+			else if (outcome == Outcome::FAILED) {
+				entry.circuit = Circuit::OPEN;
+				entry.opened = std::chrono::steady_clock::now();
+				++entry.failures;
+				++this->stats_.opened;
+				transition = Transition{ permit.key, Circuit::HALF_OPEN, Circuit::OPEN, entry.failures };
+			}
+		}
+		else if (outcome == Outcome::SUCCEEDED) {
+			if (found != this->circuits_.end() && found->second.circuit == Circuit::CLOSED) {
+				this->circuits_.erase(found);
+			}
+		}
+		else if (outcome == Outcome::FAILED) {
+			if (found == this->circuits_.end()) {
+				found = this->circuits_.try_emplace(permit.key).first;
+			}
+
+			// attempts let through before the circuit opened may still
+			// be finishing; they do not count against it again
+			Entry& entry = found->second;
+			if (entry.circuit == Circuit::CLOSED && ++entry.failures >= std::max<uint32_t>(1, this->options_.failure_threshold)) {
+				entry.circuit = Circuit::OPEN;
+				entry.opened = std::chrono::steady_clock::now();
+				++this->stats_.opened;
+				transition = Transition{ permit.key, Circuit::CLOSED, Circuit::OPEN, entry.failures };
+			}
+		}
+	}
+
+	this->Notify(transition);
+}
+
+liboai::CircuitBreaker::Circuit liboai::CircuitBreaker::StateOf(std::string_view url) const {
+	std::string key = CircuitBreaker::KeyOf(url);
+
+	std::lock_guard<std::mutex> lock(this->mutex_);
+	auto found = this->circuits_.find(key);
+	if (found == this->circuits_.end()) {
+		return Circuit::CLOSED;
+	}
+
+	// an open circuit due to be probed reports as half-open, though
+	// it only turns so with the next attempt
+	const Entry& entry = found->second;
+	if (entry.circuit == Circuit::OPEN && std::chrono::steady_clock::now() - entry.opened >= this->options_.open_duration) {
+		return Circuit::HALF_OPEN;
+	}
+	return entry.circuit;
+}
+
+void liboai::CircuitBreaker::OnTransition(std::function<void(const Transition&)> listener) {
+	std::lock_guard<std::mutex> lock(this->mutex_);
+	this->listener_ = listener ? std::make_shared<const std::function<void(const Transition&)>>(std::move(listener)) : nullptr;
+}
+
+liboai::CircuitBreaker::Stats liboai::CircuitBreaker::GetStats() const noexcept {
+	std::lock_guard<std::mutex> lock(this->mutex_);
+	return this->stats_;
+}
+
+void liboai::CircuitBreaker::SetActive(std::shared_ptr<CircuitBreaker> breaker) noexcept {
+	ActiveInstance<CircuitBreaker>::Set(std::move(breaker));
+}
+
+std::shared_ptr<liboai::CircuitBreaker> liboai::CircuitBreaker::Active() noexcept {
+	return ActiveInstance<CircuitBreaker>::Get();
+}
+
+void liboai::CircuitBreaker::Notify(const std::optional<Transition>& transition) const noexcept {
+	if (!transition) {
+		return;
+	}
+
+	std::shared_ptr<const std::function<void(const Transition&)>> listener;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex_);
+		listener = this->listener_;
+	}
+
+	if (listener) {
+		try {
+			(*listener)(transition.value());
+		}
+		catch (...) {
+			// a listener's failure is its own
+		}
+	}
+}
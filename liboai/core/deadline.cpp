@@ -0,0 +1,37 @@
+#include "../include/core/deadline.h"
+#include "../include/core/scope.h"
+
+namespace {
+	using Scopes = liboai::ScopeStack<liboai::DeadlineScope>;
+}
+
+liboai::DeadlineScope::DeadlineScope(DeadlineOptions options) noexcept
+	: options_(options), outer_(Scopes::Innermost()) {
+	if (this->outer_) {
+		const DeadlineOptions& outer = this->outer_->options_;
+		if (!this->options_.connect) {
+			this->options_.connect = outer.connect;
+		}
+		if (!this->options_.first_byte) {
+			this->options_.first_byte = outer.first_byte;
+		}
+		if (!this->options_.idle) {
+			this->options_.idle = outer.idle;
+		}
+		if (outer.deadline && (!this->options_.deadline || outer.deadline.value() < this->options_.deadline.value())) {
+			this->options_.deadline = outer.deadline;
+		}
+	}
+	Scopes::Innermost() = this;
+}
+
+liboai::DeadlineScope::~DeadlineScope() {
+	Scopes::Innermost() = this->outer_;
+}
+
+std::optional<liboai::DeadlineOptions> liboai::DeadlineScope::Current() noexcept {
+	if (const DeadlineScope* scope = Scopes::Innermost()) {
+		return scope->options_;
+	}
+	return std::nullopt;
+}
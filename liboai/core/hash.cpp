@@ -0,0 +1,63 @@
+#include "../include/core/hash.h"
+#include <cstring>
+#include <algorithm>
+
+namespace {
+	uint64_t Rotl(uint64_t x, int r) noexcept {
+		return (x << r) | (x >> (64 - r));
+	}
+
+	uint64_t Mix(uint64_t k) noexcept {
+		k ^= k >> 33;
+		k *= 0xFF51AFD7ED558CCDull;
+		k ^= k >> 33;
+		k *= 0xC4CEB9FE1A85EC53ull;
+		k ^= k >> 33;
+		return k;
+	}
+}
+
+/*
+	MurmurHash3 by Austin Appleby, which is in the public domain.
+*/
+void liboai::Hash::Murmur3(const void* data, size_t length, uint64_t seed, uint64_t out[2]) noexcept {
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	const uint64_t c1 = 0x87C37B91114253D5ull, c2 = 0x4CF5AD432745937Full;
+	uint64_t h1 = seed, h2 = seed;
+
+	size_t blocks = length / 16;
+	for (size_t i = 0; i < blocks; ++i) {
+		uint64_t k1, k2;
+		std::memcpy(&k1, bytes + i * 16, 8);
+		std::memcpy(&k2, bytes + i * 16 + 8, 8);
+
+		k1 *= c1; k1 = Rotl(k1, 31); k1 *= c2; h1 ^= k1;
+		h1 = Rotl(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52DCE729;
+		k2 *= c2; k2 = Rotl(k2, 33); k2 *= c1; h2 ^= k2;
+		h2 = Rotl(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495AB5;
+	}
+
+	const uint8_t* tail = bytes + blocks * 16;
+	uint64_t k1 = 0, k2 = 0;
+	size_t rest = length & 15;
+	for (size_t i = rest; i > 8; --i) {
+		k2 ^= static_cast<uint64_t>(tail[i - 1]) << ((i - 9) * 8);
+	}
+	for (size_t i = std::min<size_t>(rest, 8); i > 0; --i) {
+		k1 ^= static_cast<uint64_t>(tail[i - 1]) << ((i - 1) * 8);
+	}
+	if (rest > 8) {
+		k2 *= c2; k2 = Rotl(k2, 33); k2 *= c1; h2 ^= k2;
+	}
+	if (rest > 0) {
+		k1 *= c1; k1 = Rotl(k1, 31); k1 *= c2; h1 ^= k1;
+	}
+
+	h1 ^= length; h2 ^= length;
+	h1 += h2; h2 += h1;
+	h1 = Mix(h1); h2 = Mix(h2);
+	h1 += h2; h2 += h1;
+
+	out[0] = h1;
+	out[1] = h2;
+}
@@ -0,0 +1,362 @@
+#include "../include/core/hedge_policy.h"
+#include "../include/core/active.h"
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <map>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+	using Clock = std::chrono::steady_clock;
+
+	/*
+		The most recent latencies of an endpoint, in milliseconds,
+		and the hedge delay last computed from them.
+	*/
+	struct Samples {
+		std::vector<double> latencies; // a ring once full
+		size_t next = 0;
+		uint32_t fresh = 0; // recorded since the delay was computed
+		std::optional<std::chrono::milliseconds> delay;
+	};
+}
+
+struct liboai::HedgePolicy::State {
+	HedgePolicyOptions options;
+
+	mutable std::mutex mutex;
+	std::condition_variable wake;
+	std::unordered_map<std::string, Samples> endpoints; // by the suffix that matched
+	std::multimap<Clock::time_point, std::function<void()>> timers;
+	std::thread thread; // started with the first timer
+	bool stop = false;
+	double credit = 0;  // hedges that may be sent
+	Stats stats;
+
+	const std::string* EndpointOf(std::string_view url) const noexcept {
+		for (const std::string& endpoint : this->options.endpoints) {
+			if (url.size() >= endpoint.size() && url.compare(url.size() - endpoint.size(), endpoint.size(), endpoint) == 0) {
+				return &endpoint;
+			}
+		}
+		return nullptr;
+	}
+
+	void Record(const std::string& endpoint, double latency) {
+		Samples& samples = this->endpoints[endpoint];
+		size_t window = std::max<size_t>(1, this->options.window);
+		if (samples.latencies.size() < window) {
+			samples.latencies.push_back(latency);
+		}
+		else {
+			samples.latencies[samples.next] = latency;
+			samples.next = (samples.next + 1) % window;
+		}
+		++samples.fresh;
+	}
+
+	std::optional<std::chrono::milliseconds> DelayOf(const std::string& endpoint) {
+		auto found = this->endpoints.find(endpoint);
+		if (found == this->endpoints.end() || found->second.latencies.size() < std::max<uint32_t>(1, this->options.min_samples)) {
+			return std::nullopt;
+		}
+
+		// the percentile is recomputed every few samples rather than
+		// on every request
+		Samples& samples = found->second;
+		if (!samples.delay || samples.fresh >= 8) {
+			std::vector<double> sorted = samples.latencies;
+			double percentile = std::clamp(this->options.percentile, 0.0, 1.0);
+			auto at = sorted.begin() + static_cast<ptrdiff_t>(percentile * static_cast<double>(sorted.size() - 1));
+			std::nth_element(sorted.begin(), at, sorted.end());
+			samples.delay = std::max(this->options.min_delay, std::chrono::milliseconds(static_cast<int64_t>(*at)));
+			samples.fresh = 0;
+		}
+		return samples.delay;
+	}
+
+	static void Run(std::shared_ptr<State> state);
+};
+
+/*
+	The attempts at one request, the first of which to succeed
+	answers it.
+*/
+struct liboai::HedgePolicy::Contest {
+	struct Attempt {
+		netimpl::Session* session = nullptr; // once launched, until done
+		Clock::time_point started;
+		bool done = false;
+	};
+
+	std::weak_ptr<State> state;
+	const std::string* endpoint = nullptr; // within the state's options
+	Launch launch;
+	netimpl::MultiEngine::Callback callback;
+	netimpl::components::Header* received = nullptr;
+
+	std::mutex mutex;
+	std::array<Attempt, 2> attempts;
+	size_t launched = 1; // attempts sent, or being sent
+	bool decided = false;
+
+	static void Start(const std::shared_ptr<Contest>& contest, size_t index);
+	static void Hedge(const std::shared_ptr<Contest>& contest);
+	void Finish(size_t index, std::future<liboai::Response> response, const netimpl::Session* session);
+};
+
+liboai::HedgePolicy::HedgePolicy(HedgePolicyOptions options) noexcept : state_(std::make_shared<State>()) {
+	this->state_->options = std::move(options);
+}
+
+liboai::HedgePolicy::~HedgePolicy() {
+	{
+		std::lock_guard<std::mutex> lock(this->state_->mutex);
+		this->state_->stop = true;
+	}
+	this->state_->wake.notify_all();
+
+	if (this->state_->thread.joinable()) {
+		// a hedge may drop the last reference to the policy from the
+		// policy's own thread, which then finishes on its own
+		if (this->state_->thread.get_id() == std::this_thread::get_id()) {
+			this->state_->thread.detach();
+		}
+		else {
+			this->state_->thread.join();
+		}
+	}
+}
+
+bool liboai::HedgePolicy::Covers(std::string_view url) const noexcept {
+	return this->state_->EndpointOf(url) != nullptr;
+}
+
+void liboai::HedgePolicy::Race(std::string_view url, Launch launch, netimpl::MultiEngine::Callback callback, netimpl::components::Header* received) {
+	State& state = *this->state_;
+
+	auto contest = std::make_shared<Contest>();
+	contest->state = this->state_;
+	contest->endpoint = state.EndpointOf(url);
+	contest->launch = std::move(launch);
+	contest->callback = std::move(callback);
+	contest->received = received;
+
+	std::optional<std::chrono::milliseconds> delay;
+	if (contest->endpoint) {
+		std::lock_guard<std::mutex> lock(state.mutex);
+		++state.stats.requests;
+		state.credit = std::min<double>(state.options.max_hedge_burst, state.credit + state.options.max_hedge_rate);
+		delay = state.DelayOf(*contest->endpoint);
+	}
+
+	Contest::Start(contest, 0);
+	if (!delay) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(state.mutex);
+		if (state.stop) {
+			return;
+		}
+
+		state.timers.emplace(Clock::now() + delay.value(), [contest]() { Contest::Hedge(contest); });
+		if (!state.thread.joinable()) {
+			state.thread = std::thread(&State::Run, this->state_);
+		}
+	}
+	state.wake.notify_all();
+}
+
+std::optional<std::chrono::milliseconds> liboai::HedgePolicy::Delay(std::string_view url) const {
+	const std::string* endpoint = this->state_->EndpointOf(url);
+	if (!endpoint) {
+		return std::nullopt;
+	}
+
+	std::lock_guard<std::mutex> lock(this->state_->mutex);
+	return this->state_->DelayOf(*endpoint);
+}
+
+liboai::HedgePolicy::Stats liboai::HedgePolicy::GetStats() const noexcept {
+	std::lock_guard<std::mutex> lock(this->state_->mutex);
+	return this->state_->stats;
+}
+
+void liboai::HedgePolicy::SetActive(std::shared_ptr<HedgePolicy> policy) noexcept {
+	ActiveInstance<HedgePolicy>::Set(std::move(policy));
+}
+
+std::shared_ptr<liboai::HedgePolicy> liboai::HedgePolicy::Active() noexcept {
+	return ActiveInstance<HedgePolicy>::Get();
+}
+
+void liboai::HedgePolicy::State::Run(std::shared_ptr<State> state) {
+	std::unique_lock<std::mutex> lock(state->mutex);
+	std::vector<std::function<void()>> due;
+
+	while (!state->stop) {
+		Clock::time_point now = Clock::now();
+		while (!state->timers.empty() && state->timers.begin()->first <= now) {
+			due.push_back(std::move(state->timers.begin()->second));
+			state->timers.erase(state->timers.begin());
+		}
+
+		if (!due.empty()) {
+			lock.unlock();
+			for (std::function<void()>& hedge : due) {
+				hedge();
+			}
+			due.clear();
+			lock.lock();
+			continue;
+		}
+
+		if (state->timers.empty()) {
+			state->wake.wait(lock);
+		}
+		else {
+			state->wake.wait_until(lock, state->timers.begin()->first);
+		}
+	}
+
+	// hedges not yet sent are dropped, outside the lock; their
+	// requests are answered by the attempts already out
+	auto dropped = std::move(state->timers);
+	lock.unlock();
+}
+
+void liboai::HedgePolicy::Contest::Start(const std::shared_ptr<Contest>& contest, size_t index) {
+	contest->attempts[index].started = Clock::now();
+
+	netimpl::Session* session = nullptr;
+	try {
+		session = contest->launch([contest, index](std::future<liboai::Response> response, const netimpl::Session& session) {
+			contest->Finish(index, std::move(response), &session);
+		});
+	}
+	catch (...) {
+		std::promise<liboai::Response> failed;
+		failed.set_exception(std::current_exception());
+		contest->Finish(index, failed.get_future(), nullptr);
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(contest->mutex);
+	Attempt& attempt = contest->attempts[index];
+	if (!attempt.done && session) {
+		attempt.session = session;
+
+		// the request may have been answered while this attempt was
+		// being sent
+		if (contest->decided) {
+			session->Cancel();
+		}
+	}
+}
+
+void liboai::HedgePolicy::Contest::Hedge(const std::shared_ptr<Contest>& contest) {
+	{
+		std::lock_guard<std::mutex> lock(contest->mutex);
+		if (contest->decided || contest->attempts[0].done) {
+			return;
+		}
+	}
+
+	std::shared_ptr<State> state = contest->state.lock();
+	if (!state) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(state->mutex);
+		if (state->credit < 1) {
+			++state->stats.throttled;
+			return;
+		}
+		state->credit -= 1;
+		++state->stats.hedged;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(contest->mutex);
+		if (contest->decided) {
+			return;
+		}
+		contest->launched = 2;
+	}
+
+	Contest::Start(contest, 1);
+}
+
+void liboai::HedgePolicy::Contest::Finish(size_t index, std::future<liboai::Response> response, const netimpl::Session* session) {
+	std::promise<liboai::Response> outcome;
+	bool succeeded = false;
+	try {
+		outcome.set_value(response.get());
+		succeeded = true;
+	}
+	catch (...) {
+		outcome.set_exception(std::current_exception());
+	}
+
+	double latency = std::chrono::duration<double, std::milli>(Clock::now() - this->attempts[index].started).count();
+	bool won = false;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->attempts[index].done = true;
+		this->attempts[index].session = nullptr;
+
+		if (!this->decided) {
+			bool running = false;
+			for (size_t i = 0; i < this->launched; ++i) {
+				running = running || !this->attempts[i].done;
+			}
+
+			// a failed attempt only answers the request once there is
+			// no other that may yet succeed
+			if (succeeded || !running) {
+				this->decided = won = true;
+				for (Attempt& other : this->attempts) {
+					if (!other.done && other.session) {
+						other.session->Cancel();
+					}
+				}
+			}
+		}
+	}
+
+	// late successes count towards the endpoint's latencies too;
+	// cancelled attempts do not, having been cut short
+	if (succeeded && this->endpoint) {
+		if (std::shared_ptr<State> state = this->state.lock()) {
+			std::lock_guard<std::mutex> lock(state->mutex);
+			state->Record(*this->endpoint, latency);
+			if (won && index == 1) {
+				++state->stats.hedge_wins;
+			}
+		}
+	}
+
+	if (!won) {
+		return;
+	}
+
+	if (this->received && session) {
+		try {
+			*this->received = session->ResponseHeader();
+		}
+		catch (...) {
+			// the limiter then goes by its own count
+		}
+	}
+
+	try {
+		this->callback(outcome.get_future());
+	}
+	catch (...) {
+		// exceptions must not escape into the loop thread
+	}
+}
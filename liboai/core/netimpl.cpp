@@ -1,5 +1,9 @@
 #include "../include/core/netimpl.h"
 
+#if defined(LIBOAI_OPENSSL)
+	#include <openssl/ssl.h>
+#endif
+
 liboai::netimpl::CurlHolder::CurlHolder() {
 	std::lock_guard<std::mutex> lock{ this->curl_easy_get_mutex_() };
 
@@ -36,10 +40,16 @@ liboai::netimpl::CurlHolder::CurlHolder() {
 		);
 	}
 
+	this->ApplyDefaults();
+}
+
+void liboai::netimpl::CurlHolder::ApplyDefaults() {
 	#if defined(LIBOAI_DEBUG)
 		curl_easy_setopt(this->curl_, CURLOPT_VERBOSE, 1L);
 	#endif
 
+	Share::Shared().Attach(this->curl_);
+
 	#if defined(LIBOAI_DISABLE_PEERVERIFY)
 		#if defined(LIBOAI_DEBUG)
 			_liboai_dbg(
@@ -73,6 +83,106 @@ liboai::netimpl::CurlHolder::~CurlHolder() {
 	}
 }
 
+liboai::netimpl::Share::Share() {
+	this->share_ = curl_share_init();
+	if (!this->share_) {
+		return;
+	}
+
+	CURLSHcode e[6]; memset(e, CURLSHcode::CURLSHE_OK, sizeof(e));
+	e[0] = curl_share_setopt(this->share_, CURLSHOPT_LOCKFUNC, Share::Lock);
+	e[1] = curl_share_setopt(this->share_, CURLSHOPT_UNLOCKFUNC, Share::Unlock);
+	e[2] = curl_share_setopt(this->share_, CURLSHOPT_USERDATA, this);
+	e[3] = curl_share_setopt(this->share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+	e[4] = curl_share_setopt(this->share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+	#if LIBCURL_VERSION_MAJOR > 7 || (LIBCURL_VERSION_MAJOR == 7 && LIBCURL_VERSION_MINOR >= 61)
+		e[5] = curl_share_setopt(this->share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_PSL);
+	#endif
+
+	// CURL_LOCK_DATA_CONNECT is deliberately not shared: cURL does not
+	// support one connection cache used from concurrent threads. Warm
+	// connections are kept by SessionPool and each multi loop instead.
+
+	for (CURLSHcode code : e) {
+		if (code != CURLSHE_OK) {
+			// a partially configured share is still usable, but without
+			// the lock callbacks it is not; fall back to per-handle caches
+			if (e[0] != CURLSHE_OK || e[1] != CURLSHE_OK || e[2] != CURLSHE_OK) {
+				curl_share_cleanup(this->share_);
+				this->share_ = nullptr;
+			}
+
+			#if defined(LIBOAI_DEBUG)
+				_liboai_dbg(
+					"[dbg] [@%s] curl_share_setopt() failed: %s.\n",
+					__func__, curl_share_strerror(code)
+				);
+			#endif
+			break;
+		}
+	}
+}
+
+void liboai::netimpl::Share::Attach(CURL* curl) noexcept {
+	if (this->Enabled()) {
+		curl_easy_setopt(curl, CURLOPT_SHARE, this->share_);
+	}
+
+	#if LIBCURL_VERSION_MAJOR > 7 || (LIBCURL_VERSION_MAJOR == 7 && LIBCURL_VERSION_MINOR >= 80)
+		if (this->track_resumption_) {
+			curl_easy_setopt(curl, CURLOPT_PREREQFUNCTION, Share::Prerequest);
+			curl_easy_setopt(curl, CURLOPT_PREREQDATA, curl);
+		}
+	#endif
+}
+
+void liboai::netimpl::Share::RecordTransfer(CURL* curl) noexcept {
+	long connects = 0;
+	if (curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &connects) == CURLE_OK) {
+		(connects == 0 ? this->connection_reuses_ : this->new_connections_).fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void liboai::netimpl::Share::Lock(CURL* /*handle*/, curl_lock_data data, curl_lock_access /*access*/, void* userptr) {
+	static_cast<Share*>(userptr)->locks_[data].lock();
+}
+
+void liboai::netimpl::Share::Unlock(CURL* /*handle*/, curl_lock_data data, void* userptr) {
+	static_cast<Share*>(userptr)->locks_[data].unlock();
+}
+
+int liboai::netimpl::Share::Prerequest(void* userptr, char* /*primary_ip*/, char* /*local_ip*/, int /*primary_port*/, int /*local_port*/) {
+	#if LIBCURL_VERSION_MAJOR > 7 || (LIBCURL_VERSION_MAJOR == 7 && LIBCURL_VERSION_MINOR >= 80)
+		// called once the connection is up, before the request is
+		// sent; only a transfer that connected anew has an appconnect
+		// time, and only over TLS
+		CURL* curl = static_cast<CURL*>(userptr);
+		curl_off_t appconnect = 0;
+		if (curl_easy_getinfo(curl, CURLINFO_APPCONNECT_TIME_T, &appconnect) != CURLE_OK || appconnect == 0) {
+			return CURL_PREREQFUNC_OK;
+		}
+
+		Share& share = Share::Shared();
+		share.tls_handshakes_.fetch_add(1, std::memory_order_relaxed);
+
+		#if defined(LIBOAI_OPENSSL)
+			// the live connection's SSL object says whether the
+			// handshake resumed a session
+			const curl_tlssessioninfo* session = nullptr;
+			if (curl_easy_getinfo(curl, CURLINFO_TLS_SSL_PTR, &session) == CURLE_OK && session && session->backend == CURLSSLBACKEND_OPENSSL && session->internals) {
+				if (SSL_session_reused(static_cast<SSL*>(session->internals))) {
+					share.tls_resumptions_.fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+		#endif
+
+		return CURL_PREREQFUNC_OK;
+	#else
+		(void)userptr;
+		return 0;
+	#endif
+}
+
 liboai::netimpl::Session::~Session() {	
 	if (this->headers) {
 		curl_slist_free_all(this->headers);
@@ -175,6 +285,14 @@ void liboai::netimpl::Session::Prepare() {
 	// accept all encoding types
 	e[5] = curl_easy_setopt(this->curl_, CURLOPT_ACCEPT_ENCODING, "");
 
+	if (MultiEngine::Engine().Http2()) {
+		// negotiated per connection via ALPN; peers without HTTP/2 get
+		// HTTP/1.1. PIPEWAIT prefers a stream on an existing connection
+		// over opening a new one.
+		curl_easy_setopt(this->curl_, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+		curl_easy_setopt(this->curl_, CURLOPT_PIPEWAIT, 1L);
+	}
+
 	#if LIBCURL_VERSION_MAJOR > 7 || (LIBCURL_VERSION_MAJOR == 7 && LIBCURL_VERSION_MINOR >= 71)
 		e[6] = curl_easy_setopt(this->curl_, CURLOPT_SSL_OPTIONS, CURLSSLOPT_NATIVE_CA);
 		
@@ -210,6 +328,19 @@ void liboai::netimpl::Session::Prepare() {
 		);
 	#endif
 
+	// requests made in a CancellationScope are aborted with its token,
+	// and those made in a DeadlineScope are held to its deadlines
+	this->token_ = CancellationToken::Current();
+	this->deadline_ = DeadlineScope::Current();
+	this->ApplyDeadline();
+
+	#if LIBCURL_VERSION_MAJOR > 7 || (LIBCURL_VERSION_MAJOR == 7 && LIBCURL_VERSION_MINOR >= 32)
+		// lets Cancel() abort the transfer from another thread
+		curl_easy_setopt(this->curl_, CURLOPT_XFERINFOFUNCTION, &Session::Progress);
+		curl_easy_setopt(this->curl_, CURLOPT_XFERINFODATA, this);
+		curl_easy_setopt(this->curl_, CURLOPT_NOPROGRESS, 0L);
+	#endif
+
 	ErrorCheck(e, 11, "liboai::netimpl::Session::Prepare()");
 }
 
@@ -277,6 +408,16 @@ void liboai::netimpl::Session::PrepareDownloadInternal() {
 		);
 	#endif
 		
+	this->token_ = CancellationToken::Current();
+	this->deadline_ = DeadlineScope::Current();
+	this->ApplyDeadline();
+
+	#if LIBCURL_VERSION_MAJOR > 7 || (LIBCURL_VERSION_MAJOR == 7 && LIBCURL_VERSION_MINOR >= 32)
+		curl_easy_setopt(this->curl_, CURLOPT_XFERINFOFUNCTION, &Session::Progress);
+		curl_easy_setopt(this->curl_, CURLOPT_XFERINFODATA, this);
+		curl_easy_setopt(this->curl_, CURLOPT_NOPROGRESS, 0L);
+	#endif
+
 	ErrorCheck(e, 7, "liboai::netimpl::Session::PrepareDownloadInternal()");
 }
 
@@ -288,11 +429,136 @@ CURLcode liboai::netimpl::Session::Perform() {
 		);
 	#endif
 
-	CURLcode e = curl_easy_perform(this->curl_);		
-	ErrorCheck(e, "liboai::netimpl::Session::Perform()");
+	// a watched transfer is carried by the engine, whose loops are
+	// woken when its token is cancelled or its timeouts fall due;
+	// curl_easy_perform() may not check in on it for up to a second
+	// while no data flows
+	CURLcode e = this->ResultOf((MultiEngine::Engine().Http2() || this->Watched())
+		? MultiEngine::Engine().Perform(*this)
+		: curl_easy_perform(this->curl_));
+	this->result_ = e;
+	this->CheckResult(e, "liboai::netimpl::Session::Perform()");
 	return e;
 }
 
+void liboai::netimpl::Session::CheckResult(CURLcode result, std::string_view where) const {
+	if (result == CURLE_ABORTED_BY_CALLBACK && this->Cancelled()) {
+		throw liboai::exception::OpenAIException(
+			"Request cancelled",
+			liboai::exception::EType::E_CONNECTIONERROR,
+			where
+		);
+	}
+	ErrorCheck(result, where);
+}
+
+CURLcode liboai::netimpl::Session::ResultOf(CURLcode result) const noexcept {
+	// a transfer aborted for its first-byte or idle timeout fails as
+	// one that reached cURL's own timeout would
+	if (result == CURLE_ABORTED_BY_CALLBACK && this->expired_ && !this->Cancelled()) {
+		return CURLE_OPERATION_TIMEDOUT;
+	}
+	return result;
+}
+
+int liboai::netimpl::Session::Progress(void* session, curl_off_t, curl_off_t dlnow, curl_off_t, curl_off_t ulnow) noexcept {
+	// a non-zero return aborts the transfer with CURLE_ABORTED_BY_CALLBACK
+	Session* self = static_cast<Session*>(session);
+	if (self->Cancelled()) {
+		return 1;
+	}
+
+	if (!self->deadline_) {
+		return 0;
+	}
+
+	// response headers count towards the first byte, though cURL
+	// only reports the body
+	const auto now = std::chrono::steady_clock::now();
+	curl_off_t transferred = ulnow + dlnow + static_cast<curl_off_t>(self->header_string_.size());
+	if (transferred != self->transferred_) {
+		self->transferred_ = transferred;
+		self->active_at_ = now;
+		self->awaiting_ = self->awaiting_ && dlnow == 0 && self->header_string_.empty();
+	}
+
+	std::optional<std::chrono::steady_clock::time_point> due = self->Due();
+	if (due && now >= due.value()) {
+		self->expired_ = true;
+		return 1;
+	}
+	return 0;
+}
+
+void liboai::netimpl::Session::ApplyDeadline() {
+	this->active_at_ = std::chrono::steady_clock::now();
+	this->transferred_ = 0;
+	this->awaiting_ = true;
+	this->expired_ = false;
+
+	if (!this->deadline_) {
+		return;
+	}
+
+	CURLcode e[2]; memset(e, CURLcode::CURLE_OK, sizeof(e));
+
+	if (this->deadline_->connect) {
+		e[0] = curl_easy_setopt(this->curl_, CURLOPT_CONNECTTIMEOUT_MS, static_cast<long>(this->deadline_->connect->count()));
+	}
+
+	// each attempt only has what is left until the deadline, within
+	// the timeout set for the request
+	if (this->deadline_->deadline) {
+		auto remaining = std::chrono::ceil<std::chrono::milliseconds>(this->deadline_->deadline.value() - this->active_at_).count();
+		if (remaining <= 0) {
+			ErrorCheck(CURLE_OPERATION_TIMEDOUT, "liboai::netimpl::Session::ApplyDeadline()");
+		}
+		if (this->timeout_ms_ > 0) {
+			remaining = std::min<decltype(remaining)>(remaining, this->timeout_ms_);
+		}
+		e[1] = curl_easy_setopt(this->curl_, CURLOPT_TIMEOUT_MS, static_cast<long>(remaining));
+	}
+
+	#if defined(LIBOAI_DEBUG)
+		_liboai_dbg(
+			"[dbg] [@%s] Applied deadlines for Session (0x%p).\n",
+			__func__, this
+		);
+	#endif
+
+	ErrorCheck(e, 2, "liboai::netimpl::Session::ApplyDeadline()");
+}
+
+bool liboai::netimpl::Session::Watched() const noexcept {
+	return this->token_ || (this->deadline_ && (this->deadline_->first_byte || this->deadline_->idle));
+}
+
+std::optional<std::chrono::steady_clock::time_point> liboai::netimpl::Session::Due() const noexcept {
+	if (!this->deadline_) {
+		return std::nullopt;
+	}
+
+	const std::optional<std::chrono::milliseconds>& limit = (this->awaiting_ && this->deadline_->first_byte)
+		? this->deadline_->first_byte
+		: this->deadline_->idle;
+	if (!limit) {
+		return std::nullopt;
+	}
+	return this->active_at_ + limit.value();
+}
+
+void liboai::netimpl::Session::Cancel() noexcept {
+	this->cancelled_.store(true, std::memory_order_relaxed);
+
+	// cURL checks in on the transfer whenever its loop runs; an idle
+	// loop is woken so that it does so at once
+	#if LIBCURL_VERSION_MAJOR > 7 || (LIBCURL_VERSION_MAJOR == 7 && LIBCURL_VERSION_MINOR >= 68)
+		if (CURLM* multi = this->multi_.load()) {
+			curl_multi_wakeup(multi);
+		}
+	#endif
+}
+
 liboai::Response liboai::netimpl::Session::BuildResponseObject() {
 	// holds error codes - all init to OK to prevent errors
 	// when checking unset values
@@ -342,6 +608,8 @@ liboai::Response liboai::netimpl::Session::BuildResponseObject() {
 
 	ErrorCheck(e, 3, "liboai::netimpl::Session::BuildResponseObject()");
 
+	Share::Shared().RecordTransfer(this->curl_);
+
 	// fill content
 	this->content = this->response_string_;
 	
@@ -364,6 +632,7 @@ liboai::Response liboai::netimpl::Session::BuildResponseObject() {
 
 liboai::Response liboai::netimpl::Session::Complete() {
 	this->hasBody = false;
+	this->write_.Finish();
 	
 	#if defined(LIBOAI_DEBUG)
 		_liboai_dbg(
@@ -375,6 +644,35 @@ liboai::Response liboai::netimpl::Session::Complete() {
 	return this->BuildResponseObject();
 }
 
+liboai::Response liboai::netimpl::Session::Resend() {
+	this->PrepareResend();
+
+	#if defined(LIBOAI_DEBUG)
+		_liboai_dbg(
+			"[dbg] [@%s] Called Perform().\n",
+			__func__
+		);
+	#endif
+
+	this->Perform();
+	return this->Complete();
+}
+
+void liboai::netimpl::Session::PrepareResend() {
+	// the handle keeps every option of the last request; only what
+	// the last response left behind is reset
+	this->status_code = 0;
+	this->result_ = CURLE_OK;
+	this->status_line.clear();
+	this->reason.clear();
+	this->url_str = this->url_;
+	this->response_string_.clear();
+	this->header_string_.clear();
+	this->response_header_.clear();
+	this->write_.delivered = 0;
+	this->ApplyDeadline();
+}
+
 liboai::Response liboai::netimpl::Session::CompleteDownload() {
 	// holds error codes - all init to OK to prevent errors
 	// when checking unset values
@@ -654,14 +952,23 @@ liboai::Response liboai::netimpl::Session::Download(std::ofstream& file) {
 
 void liboai::netimpl::Session::ClearContext() {
   if (curl_) {
+    // curl_easy_reset() keeps live connections and the session-ID
+    // cache but drops every option, including our defaults
     curl_easy_reset(curl_);
+    this->ApplyDefaults();
   }
   status_code = 0;
+  result_ = CURLE_OK;
+  cancelled_ = false;
+  token_.reset();
+  deadline_.reset();
+  timeout_ms_ = 0;
   elapsed = 0.0;
   status_line.clear();
   content.clear();
   url_str.clear();
   reason.clear();
+  body_ = std::string(); // don't keep large bodies alive in idle sessions
 
   if (this->headers) {
     curl_slist_free_all(this->headers);
@@ -701,7 +1008,10 @@ void liboai::netimpl::Session::ClearContext() {
   url_.clear();
   response_string_.clear();
   header_string_.clear();
+  response_header_.clear();
   write_ = netimpl::components::WriteCallback{};
+  proxies_ = netimpl::components::Proxies{};
+  proxyAuth_ = netimpl::components::ProxyAuthentication{};
 }
 
 void liboai::netimpl::Session::ParseResponseHeader(const std::string& headers, std::string* status_line, std::string* reason) {
@@ -716,6 +1026,10 @@ void liboai::netimpl::Session::ParseResponseHeader(const std::string& headers, s
 
     for (std::string& line : lines) {
         if (line.substr(0, 5) == "HTTP/") {
+            // only the final response's headers are kept, not those
+            // of redirects or interim responses
+            this->response_header_.clear();
+
             // set the status_line if it was given
             if ((status_line != nullptr) || (reason != nullptr)) {
                 line.resize(std::min<size_t>(line.size(), line.find_last_not_of("\t\n\r ") + 1));
@@ -737,13 +1051,13 @@ void liboai::netimpl::Session::ParseResponseHeader(const std::string& headers, s
                 }
             }
         }
-
-        if (line.length() > 0) {
+        else if (line.length() > 0) {
             const size_t found = line.find(':');
             if (found != std::string::npos) {
                 std::string value = line.substr(found + 1);
                 value.erase(0, value.find_first_not_of("\t "));
                 value.resize(std::min<size_t>(value.size(), value.find_last_not_of("\t\n\r ") + 1));
+                this->response_header_[line.substr(0, found)] = std::move(value);
             }
         }
     }
@@ -803,14 +1117,18 @@ void liboai::netimpl::Session::SetBody(components::Body&& body) {
 	// when checking unset values
 	CURLcode e[2]; memset(e, CURLcode::CURLE_OK, sizeof(e));
 
+	// the Session takes ownership of the body for the duration
+	// of the transfer, so cURL can use it without a copy
+	this->body_ = body.take();
+
 	this->hasBody = true;
-	e[0] = curl_easy_setopt(this->curl_, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(body.str().length()));
-	e[1] = curl_easy_setopt(this->curl_, CURLOPT_COPYPOSTFIELDS, body.c_str());
+	e[0] = curl_easy_setopt(this->curl_, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(this->body_.length()));
+	e[1] = curl_easy_setopt(this->curl_, CURLOPT_POSTFIELDS, this->body_.c_str());
 
 	#if defined(LIBOAI_DEBUG)
 		_liboai_dbg(
-			"[dbg] [@%s] Set CURLOPT_POSTFIELDSIZE_LARGE and CURLOPT_COPYPOSTFIELDS for Session (0x%p) to %lld and \"%s\".\n",
-			__func__, this, static_cast<curl_off_t>(body.str().length()), body.c_str()
+			"[dbg] [@%s] Set CURLOPT_POSTFIELDSIZE_LARGE and CURLOPT_POSTFIELDS for Session (0x%p) to %lld and \"%s\".\n",
+			__func__, this, static_cast<curl_off_t>(this->body_.length()), this->body_.c_str()
 		);
 	#endif
 		
@@ -1325,6 +1643,7 @@ void liboai::netimpl::Session::SetOption(const components::Timeout& timeout) {
 }
 
 void liboai::netimpl::Session::SetTimeout(const components::Timeout& timeout) {
+	this->timeout_ms_ = timeout.Milliseconds();
 	CURLcode e = curl_easy_setopt(this->curl_, CURLOPT_TIMEOUT_MS, timeout.Milliseconds());
 
 	#if defined(LIBOAI_DEBUG)
@@ -1571,3 +1890,615 @@ void liboai::netimpl::ErrorCheck(CURLcode ecode, std::string_view where) {
 		}
 	}
 #endif
+
+void liboai::netimpl::SessionPool::Returner::operator()(Session* session) const noexcept {
+	SessionPool::Pool().Release(session);
+}
+
+std::string liboai::netimpl::SessionPool::Origin(std::string_view url) {
+	size_t start = url.find("://");
+	start = (start == std::string_view::npos) ? 0 : start + 3;
+
+	size_t end = url.find_first_of("/?#", start);
+	std::string origin(url.substr(0, end));
+
+	// scheme and host are case-insensitive
+	std::transform(origin.begin(), origin.end(), origin.begin(),
+		[](unsigned char c) { return static_cast<char>(std::tolower(c)); }
+	);
+
+	return origin;
+}
+
+liboai::netimpl::SessionPool::Lease liboai::netimpl::SessionPool::Acquire(std::string_view url) {
+	std::string origin = SessionPool::Origin(url);
+	std::vector<Entry> expired;
+	Lease lease;
+
+	{
+		std::lock_guard<std::mutex> lock(this->mutex_);
+		auto it = this->idle_.find(origin);
+		if (it != this->idle_.end()) {
+			auto now = std::chrono::steady_clock::now();
+
+			// most recently returned sessions sit at the back and are
+			// the most likely to still hold a live connection
+			while (!it->second.empty()) {
+				Entry entry = std::move(it->second.back());
+				it->second.pop_back();
+
+				if (this->Expired(entry, now)) {
+					expired.push_back(std::move(entry));
+					continue;
+				}
+
+				lease.reset(entry.session.release());
+				break;
+			}
+
+			if (it->second.empty()) {
+				this->idle_.erase(it);
+			}
+		}
+	}
+
+	// expired sessions are destroyed outside the lock; closing
+	// their connections may take a moment
+	expired.clear();
+
+	if (lease) {
+		this->reuses_.fetch_add(1, std::memory_order_relaxed);
+
+		#if defined(LIBOAI_DEBUG)
+			_liboai_dbg(
+				"[dbg] [@%s] Reusing pooled Session (0x%p) for %s.\n",
+				__func__, lease.get(), origin.c_str()
+			);
+		#endif
+
+		return lease;
+	}
+
+	this->misses_.fetch_add(1, std::memory_order_relaxed);
+	lease.reset(new Session());
+	lease->origin_ = std::move(origin);
+	return lease;
+}
+
+void liboai::netimpl::SessionPool::Release(Session* session) noexcept {
+	std::unique_ptr<Session> owned(session);
+	if (!owned) {
+		return;
+	}
+
+	try {
+		// drop per-request state now so idle sessions don't pin
+		// request or response buffers
+		owned->ClearContext();
+
+		Entry entry{ std::move(owned), std::chrono::steady_clock::now() };
+
+		std::lock_guard<std::mutex> lock(this->mutex_);
+		if (entry.session->origin_.empty() || this->Expired(entry, entry.idle_since)) {
+			return;
+		}
+
+		std::vector<Entry>& entries = this->idle_[entry.session->origin_];
+		if (entries.size() >= this->max_idle_) {
+			return;
+		}
+
+		entries.push_back(std::move(entry));
+	}
+	catch (...) {
+		// session is discarded
+	}
+}
+
+bool liboai::netimpl::SessionPool::Expired(const Entry& entry, std::chrono::steady_clock::time_point now) const noexcept {
+	return (now - entry.idle_since) > this->idle_timeout_
+		|| (now - entry.session->created_) > this->max_lifetime_;
+}
+
+void liboai::netimpl::SessionPool::SetMaxIdlePerOrigin(size_t count) noexcept {
+	std::unordered_map<std::string, std::vector<Entry>> discarded;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex_);
+		this->max_idle_ = count;
+		for (auto& [origin, entries] : this->idle_) {
+			while (entries.size() > count) {
+				discarded[origin].push_back(std::move(entries.front()));
+				entries.erase(entries.begin());
+			}
+		}
+	}
+}
+
+void liboai::netimpl::SessionPool::SetIdleTimeout(std::chrono::milliseconds timeout) noexcept {
+	std::lock_guard<std::mutex> lock(this->mutex_);
+	this->idle_timeout_ = timeout;
+}
+
+void liboai::netimpl::SessionPool::SetMaxLifetime(std::chrono::milliseconds lifetime) noexcept {
+	std::lock_guard<std::mutex> lock(this->mutex_);
+	this->max_lifetime_ = lifetime;
+}
+
+void liboai::netimpl::SessionPool::Clear() noexcept {
+	std::unordered_map<std::string, std::vector<Entry>> discarded;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex_);
+		discarded.swap(this->idle_);
+	}
+}
+
+size_t liboai::netimpl::SessionPool::Idle() const noexcept {
+	std::lock_guard<std::mutex> lock(this->mutex_);
+	size_t count = 0;
+	for (const auto& [origin, entries] : this->idle_) {
+		count += entries.size();
+	}
+	return count;
+}
+
+liboai::netimpl::MultiEngine::~MultiEngine() {
+	// from here on Enqueue() fails transfers instead of queueing them,
+	// so callbacks run below cannot add to the loops being torn down
+	this->shutdown_ = true;
+
+	for (auto& loop : this->loops_) {
+		loop->stop = true;
+		#if LIBCURL_VERSION_MAJOR > 7 || (LIBCURL_VERSION_MAJOR == 7 && LIBCURL_VERSION_MINOR >= 68)
+			curl_multi_wakeup(loop->multi);
+		#endif
+		if (loop->thread.joinable()) {
+			loop->thread.join();
+		}
+	}
+
+	// anything still owned by a loop will never complete; take it all
+	// out of the loops before the first callback runs
+	std::vector<std::unique_ptr<Transfer>> orphaned;
+	for (auto& loop : this->loops_) {
+		std::unordered_map<CURL*, std::unique_ptr<Transfer>> active;
+		std::vector<std::unique_ptr<Transfer>> incoming;
+		active.swap(loop->active);
+		{
+			std::lock_guard<std::mutex> lock(loop->mutex);
+			incoming.swap(loop->incoming);
+		}
+
+		for (auto& [handle, transfer] : active) {
+			curl_multi_remove_handle(loop->multi, handle);
+			transfer->session->multi_.store(nullptr);
+			orphaned.push_back(std::move(transfer));
+		}
+		for (auto& transfer : incoming) {
+			orphaned.push_back(std::move(transfer));
+		}
+
+		curl_multi_cleanup(loop->multi);
+		loop->multi = nullptr;
+	}
+
+	for (auto& transfer : orphaned) {
+		this->Finish(std::move(transfer), CURLE_OK, ShutDown());
+	}
+}
+
+namespace liboai::netimpl {
+	// set on loop threads; synchronous transfers issued from within a
+	// loop callback must not block on their own loop
+	static thread_local bool _on_loop_thread = false;
+}
+
+bool liboai::netimpl::MultiEngine::SetHttp2(bool enabled, long max_concurrent_streams, long max_host_connections) noexcept {
+	if (enabled && !(curl_version_info(CURLVERSION_NOW)->features & CURL_VERSION_HTTP2)) {
+		return false;
+	}
+
+	this->max_streams_ = max_concurrent_streams > 0 ? max_concurrent_streams : 1;
+	this->max_host_connections_ = (enabled && max_host_connections > 0) ? max_host_connections : 0;
+	this->http2_ = enabled;
+
+	// wake the loops so the new limits are applied promptly
+	this->Wake();
+
+	return true;
+}
+
+CURLcode liboai::netimpl::MultiEngine::Perform(Session& session) {
+	if (_on_loop_thread) {
+		return curl_easy_perform(session.curl_);
+	}
+
+	std::promise<CURLcode> performed;
+	std::future<CURLcode> result = performed.get_future();
+
+	auto transfer = std::make_unique<Transfer>();
+	transfer->session = &session;
+	transfer->performed = &performed;
+	this->Enqueue(std::move(transfer));
+
+	return result.get();
+}
+
+void liboai::netimpl::MultiEngine::Wake() noexcept {
+	#if LIBCURL_VERSION_MAJOR > 7 || (LIBCURL_VERSION_MAJOR == 7 && LIBCURL_VERSION_MINOR >= 68)
+		if (this->started_ && !this->shutdown_) {
+			for (auto& loop : this->loops_) {
+				curl_multi_wakeup(loop->multi);
+			}
+		}
+	#endif
+}
+
+bool liboai::netimpl::MultiEngine::SetLoopCount(size_t count) noexcept {
+	std::lock_guard<std::mutex> lock(this->start_mutex_);
+	if (count == 0 || this->started_) {
+		return false;
+	}
+	this->loop_count_ = count;
+	return true;
+}
+
+std::future<liboai::Response> liboai::netimpl::MultiEngine::Get(SessionPool::Lease session) {
+	auto transfer = std::make_unique<Transfer>();
+	transfer->owned = std::move(session);
+	transfer->session = transfer->owned.get();
+	return this->Submit(std::move(transfer), [](Session& s) { s.PrepareGet(); });
+}
+
+std::future<liboai::Response> liboai::netimpl::MultiEngine::Post(SessionPool::Lease session) {
+	auto transfer = std::make_unique<Transfer>();
+	transfer->owned = std::move(session);
+	transfer->session = transfer->owned.get();
+	return this->Submit(std::move(transfer), [](Session& s) { s.PreparePost(); });
+}
+
+std::future<liboai::Response> liboai::netimpl::MultiEngine::Delete(SessionPool::Lease session) {
+	auto transfer = std::make_unique<Transfer>();
+	transfer->owned = std::move(session);
+	transfer->session = transfer->owned.get();
+	return this->Submit(std::move(transfer), [](Session& s) { s.PrepareDelete(); });
+}
+
+void liboai::netimpl::MultiEngine::Get(SessionPool::Lease session, Callback callback) {
+	auto transfer = std::make_unique<Transfer>();
+	transfer->owned = std::move(session);
+	transfer->session = transfer->owned.get();
+	transfer->callback = std::move(callback);
+	this->Submit(std::move(transfer), [](Session& s) { s.PrepareGet(); });
+}
+
+void liboai::netimpl::MultiEngine::Post(SessionPool::Lease session, Callback callback) {
+	auto transfer = std::make_unique<Transfer>();
+	transfer->owned = std::move(session);
+	transfer->session = transfer->owned.get();
+	transfer->callback = std::move(callback);
+	this->Submit(std::move(transfer), [](Session& s) { s.PreparePost(); });
+}
+
+void liboai::netimpl::MultiEngine::Delete(SessionPool::Lease session, Callback callback) {
+	auto transfer = std::make_unique<Transfer>();
+	transfer->owned = std::move(session);
+	transfer->session = transfer->owned.get();
+	transfer->callback = std::move(callback);
+	this->Submit(std::move(transfer), [](Session& s) { s.PrepareDelete(); });
+}
+
+void liboai::netimpl::MultiEngine::Download(SessionPool::Lease session, std::shared_ptr<std::ofstream> file, Callback callback) {
+	auto transfer = std::make_unique<Transfer>();
+	transfer->owned = std::move(session);
+	transfer->session = transfer->owned.get();
+	transfer->file = std::move(file);
+	transfer->callback = std::move(callback);
+
+	std::ofstream& stream = *transfer->file;
+	this->Submit(std::move(transfer), [&stream](Session& s) { s.PrepareDownload(stream); });
+}
+
+void liboai::netimpl::MultiEngine::Download(Session& session, std::shared_ptr<std::ofstream> file, Callback callback) {
+	auto transfer = std::make_unique<Transfer>();
+	transfer->session = &session;
+	transfer->file = std::move(file);
+	transfer->callback = std::move(callback);
+
+	std::ofstream& stream = *transfer->file;
+	this->Submit(std::move(transfer), [&stream](Session& s) { s.PrepareDownload(stream); });
+}
+
+void liboai::netimpl::MultiEngine::Get(Session& session, Callback callback) {
+	auto transfer = std::make_unique<Transfer>();
+	transfer->session = &session;
+	transfer->callback = std::move(callback);
+	this->Submit(std::move(transfer), [](Session& s) { s.PrepareGet(); });
+}
+
+void liboai::netimpl::MultiEngine::Post(Session& session, Callback callback) {
+	auto transfer = std::make_unique<Transfer>();
+	transfer->session = &session;
+	transfer->callback = std::move(callback);
+	this->Submit(std::move(transfer), [](Session& s) { s.PreparePost(); });
+}
+
+void liboai::netimpl::MultiEngine::Delete(Session& session, Callback callback) {
+	auto transfer = std::make_unique<Transfer>();
+	transfer->session = &session;
+	transfer->callback = std::move(callback);
+	this->Submit(std::move(transfer), [](Session& s) { s.PrepareDelete(); });
+}
+
+void liboai::netimpl::MultiEngine::Resend(Session& session, Callback callback) {
+	auto transfer = std::make_unique<Transfer>();
+	transfer->session = &session;
+	transfer->callback = std::move(callback);
+	this->Submit(std::move(transfer), [](Session& s) { s.PrepareResend(); });
+}
+
+std::future<liboai::Response> liboai::netimpl::MultiEngine::Submit(std::unique_ptr<Transfer> transfer, const std::function<void(Session&)>& prepare) {
+	std::future<liboai::Response> future = transfer->promise.get_future();
+
+	// options are applied on the calling thread; any failure is
+	// reported through the future just as a failed transfer would be
+	try {
+		prepare(*transfer->session);
+	}
+	catch (...) {
+		transfer->promise.set_exception(std::current_exception());
+		if (transfer->callback) {
+			transfer->callback(std::move(future));
+			return {};
+		}
+		return future;
+	}
+
+	if (transfer->callback) {
+		// the callback receives the future; the caller gets an invalid one
+		Callback callback = std::move(transfer->callback);
+		transfer->callback = [callback = std::move(callback), future = std::make_shared<std::future<liboai::Response>>(std::move(future))](std::future<liboai::Response>) mutable {
+			callback(std::move(*future));
+		};
+		future = {};
+	}
+
+	this->Enqueue(std::move(transfer));
+	return future;
+}
+
+void liboai::netimpl::MultiEngine::Enqueue(std::unique_ptr<Transfer> transfer) {
+	// should the loops fail to start, the transfer is not the engine's
+	// yet, and the failure goes to the caller
+	if (!this->started_ && !this->shutdown_) {
+		this->Start();
+	}
+
+	this->in_flight_.fetch_add(1, std::memory_order_relaxed);
+	if (this->shutdown_) {
+		this->Finish(std::move(transfer), CURLE_OK, ShutDown());
+		return;
+	}
+
+	Loop& loop = *this->loops_[this->next_.fetch_add(1, std::memory_order_relaxed) % this->loops_.size()];
+	{
+		std::lock_guard<std::mutex> lock(loop.mutex);
+
+		// checked again under the lock the destructor drains under
+		if (!this->shutdown_) {
+			loop.incoming.push_back(std::move(transfer));
+		}
+	}
+	if (transfer) {
+		this->Finish(std::move(transfer), CURLE_OK, ShutDown());
+		return;
+	}
+
+	#if LIBCURL_VERSION_MAJOR > 7 || (LIBCURL_VERSION_MAJOR == 7 && LIBCURL_VERSION_MINOR >= 68)
+		curl_multi_wakeup(loop.multi);
+	#endif
+}
+
+void liboai::netimpl::MultiEngine::Start() {
+	std::lock_guard<std::mutex> lock(this->start_mutex_);
+	if (this->started_) {
+		return;
+	}
+
+	// the loops only become the engine's once every one of them is
+	// running, so that a failure part way leaves the engine unstarted
+	std::vector<std::unique_ptr<Loop>> loops;
+	try {
+		for (size_t i = 0; i < this->loop_count_; ++i) {
+			auto loop = std::make_unique<Loop>();
+			loop->multi = curl_multi_init();
+			if (!loop->multi) {
+				throw liboai::exception::OpenAIException(
+					"curl_multi_init() failed",
+					liboai::exception::EType::E_CURLERROR,
+					"liboai::netimpl::MultiEngine::Start()"
+				);
+			}
+
+			#if LIBCURL_VERSION_MAJOR > 7 || (LIBCURL_VERSION_MAJOR == 7 && LIBCURL_VERSION_MINOR >= 43)
+				curl_multi_setopt(loop->multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+			#endif
+			loops.push_back(std::move(loop));
+		}
+
+		for (auto& loop : loops) {
+			Loop* l = loop.get();
+			l->thread = std::thread([this, l]() { this->Run(*l); });
+		}
+	}
+	catch (...) {
+		// no transfer has been handed to these loops yet
+		for (auto& loop : loops) {
+			loop->stop = true;
+			#if LIBCURL_VERSION_MAJOR > 7 || (LIBCURL_VERSION_MAJOR == 7 && LIBCURL_VERSION_MINOR >= 68)
+				curl_multi_wakeup(loop->multi);
+			#endif
+			if (loop->thread.joinable()) {
+				loop->thread.join();
+			}
+			curl_multi_cleanup(loop->multi);
+		}
+		throw;
+	}
+
+	this->loops_ = std::move(loops);
+
+	#if defined(LIBOAI_DEBUG)
+		_liboai_dbg(
+			"[dbg] [@%s] Started %zu multi loop(s).\n",
+			__func__, this->loops_.size()
+		);
+	#endif
+
+	this->started_ = true;
+}
+
+void liboai::netimpl::MultiEngine::Run(Loop& loop) {
+	std::vector<std::unique_ptr<Transfer>> incoming;
+	_on_loop_thread = true;
+
+	while (!loop.stop) {
+		#if LIBCURL_VERSION_MAJOR > 7 || (LIBCURL_VERSION_MAJOR == 7 && LIBCURL_VERSION_MINOR >= 67)
+			// multi options may only be changed from the owning thread
+			if (long streams = this->max_streams_.load(std::memory_order_relaxed); streams != loop.max_streams) {
+				curl_multi_setopt(loop.multi, CURLMOPT_MAX_CONCURRENT_STREAMS, streams);
+				loop.max_streams = streams;
+			}
+		#endif
+
+		#if LIBCURL_VERSION_MAJOR > 7 || (LIBCURL_VERSION_MAJOR == 7 && LIBCURL_VERSION_MINOR >= 30)
+			// without a cap, a burst of transfers opens a connection for
+			// each one before the first has confirmed it can multiplex
+			if (long connections = this->max_host_connections_.load(std::memory_order_relaxed); connections != loop.max_host_connections) {
+				curl_multi_setopt(loop.multi, CURLMOPT_MAX_HOST_CONNECTIONS, connections);
+				loop.max_host_connections = connections;
+			}
+		#endif
+
+		{
+			std::lock_guard<std::mutex> lock(loop.mutex);
+			incoming.swap(loop.incoming);
+		}
+
+		for (auto& transfer : incoming) {
+			CURL* handle = transfer->session->curl_;
+			CURLMcode mc = curl_multi_add_handle(loop.multi, handle);
+			if (mc != CURLM_OK) {
+				this->Finish(std::move(transfer), CURLE_OK, std::make_exception_ptr(liboai::exception::OpenAIException(
+					curl_multi_strerror(mc),
+					liboai::exception::EType::E_CURLERROR,
+					"liboai::netimpl::MultiEngine::Run()"
+				)));
+				continue;
+			}
+			transfer->session->multi_.store(loop.multi);
+			loop.active.emplace(handle, std::move(transfer));
+		}
+		incoming.clear();
+
+		int running = 0;
+		curl_multi_perform(loop.multi, &running);
+
+		int queued = 0;
+		while (CURLMsg* msg = curl_multi_info_read(loop.multi, &queued)) {
+			if (msg->msg != CURLMSG_DONE) {
+				continue;
+			}
+
+			CURL* handle = msg->easy_handle;
+			CURLcode result = msg->data.result;
+			curl_multi_remove_handle(loop.multi, handle);
+
+			auto it = loop.active.find(handle);
+			if (it != loop.active.end()) {
+				std::unique_ptr<Transfer> transfer = std::move(it->second);
+				loop.active.erase(it);
+				transfer->session->multi_.store(nullptr);
+				this->Finish(std::move(transfer), result);
+			}
+		}
+
+		// cURL has no timer of its own for first-byte and idle
+		// timeouts, and does not check in on transfers still waiting
+		// for a connection; the loop aborts those that are cancelled
+		// or overdue itself, and wakes when the next one falls due
+		int timeout = 1000;
+		const auto now = std::chrono::steady_clock::now();
+		for (auto it = loop.active.begin(); it != loop.active.end(); ) {
+			Session* session = it->second->session;
+			std::optional<std::chrono::steady_clock::time_point> due = session->Due();
+			if (session->Cancelled() || (due && now >= due.value())) {
+				std::unique_ptr<Transfer> transfer = std::move(it->second);
+				curl_multi_remove_handle(loop.multi, it->first);
+				it = loop.active.erase(it);
+				session->multi_.store(nullptr);
+				session->expired_ = !session->Cancelled();
+				this->Finish(std::move(transfer), CURLE_ABORTED_BY_CALLBACK);
+				continue;
+			}
+
+			if (due) {
+				auto wait = std::chrono::ceil<std::chrono::milliseconds>(due.value() - now).count();
+				timeout = static_cast<int>(std::clamp<decltype(wait)>(wait, 1, timeout));
+			}
+			++it;
+		}
+
+		#if LIBCURL_VERSION_MAJOR > 7 || (LIBCURL_VERSION_MAJOR == 7 && LIBCURL_VERSION_MINOR >= 68)
+			curl_multi_poll(loop.multi, nullptr, 0, timeout, nullptr);
+		#else
+			// no curl_multi_wakeup(); keep the interval short so new
+			// submissions are picked up promptly
+			curl_multi_wait(loop.multi, nullptr, 0, std::min(timeout, 10), nullptr);
+		#endif
+	}
+}
+
+void liboai::netimpl::MultiEngine::Finish(std::unique_ptr<Transfer> transfer, CURLcode result, std::exception_ptr error) noexcept {
+	if (transfer->performed) {
+		// synchronous transfer; the caller builds the response itself
+		error ? transfer->performed->set_exception(error) : transfer->performed->set_value(result);
+		this->in_flight_.fetch_sub(1, std::memory_order_relaxed);
+		return;
+	}
+
+	if (error) {
+		transfer->promise.set_exception(error);
+	}
+	else {
+		try {
+			result = transfer->session->ResultOf(result);
+			transfer->session->result_ = result;
+			transfer->session->CheckResult(result, "liboai::netimpl::MultiEngine::Finish()");
+			transfer->promise.set_value(
+				transfer->file ? transfer->session->CompleteDownload() : transfer->session->Complete()
+			);
+		}
+		catch (...) {
+			transfer->promise.set_exception(std::current_exception());
+		}
+	}
+
+	if (transfer->callback) {
+		try {
+			transfer->callback({});
+		}
+		catch (...) {
+			// exceptions must not escape into the loop thread
+		}
+	}
+
+	this->in_flight_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+std::exception_ptr liboai::netimpl::MultiEngine::ShutDown() {
+	return std::make_exception_ptr(liboai::exception::OpenAIException(
+		"Transfer aborted; engine shut down",
+		liboai::exception::EType::E_CONNECTIONERROR,
+		"liboai::netimpl::MultiEngine::~MultiEngine()"
+	));
+}
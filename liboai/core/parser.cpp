@@ -0,0 +1,362 @@
+#include "../include/core/parser.h"
+
+#if defined(LIBOAI_SIMDJSON)
+	#include <memory>
+	#include <simdjson.h>
+
+namespace {
+	namespace ondemand = simdjson::ondemand;
+
+	/*
+		On-Demand parsers are expensive to set up and need their
+		input padded, so each thread keeps one of each and reuses
+		their buffers across parses. A parse started while another
+		is in progress on the same thread - from within a SAX
+		handler - gets its own.
+	*/
+	struct Scratch {
+		ondemand::parser parser;
+		std::string input;
+		bool busy = false;
+	};
+
+	template <class _Fn>
+	simdjson::error_code Iterate(std::string_view json, _Fn&& visit) {
+		thread_local Scratch shared;
+		std::unique_ptr<Scratch> nested;
+		Scratch* scratch = &shared;
+		if (shared.busy) {
+			nested = std::make_unique<Scratch>();
+			scratch = nested.get();
+		}
+
+		struct Release {
+			bool& busy;
+			~Release() { busy = false; }
+		} release{ scratch->busy };
+		scratch->busy = true;
+
+		scratch->input.reserve(json.size() + simdjson::SIMDJSON_PADDING);
+		scratch->input.assign(json.data(), json.size());
+
+		ondemand::document document;
+		simdjson::error_code error = scratch->parser.iterate(
+			simdjson::padded_string_view(scratch->input.data(), scratch->input.size(), scratch->input.capacity())
+		).get(document);
+
+		if (!error) {
+			error = visit(document);
+		}
+		if (!error && !document.at_end()) {
+			error = simdjson::TRAILING_CONTENT;
+		}
+		return error;
+	}
+
+	std::string_view Token(ondemand::value& value) {
+		return value.raw_json_token();
+	}
+
+	std::string_view Token(ondemand::document& document) {
+		std::string_view token;
+		if (document.raw_json_token().get(token)) {
+			return {};
+		}
+		return token;
+	}
+
+	/*
+		Reads a number the way nlohmann does: non-negative integers
+		as unsigned, integers too large for 64 bits as doubles.
+	*/
+	template <class _Value, class _Int, class _Uint, class _Float>
+	simdjson::error_code ReadNumber(_Value& value, _Int&& on_int, _Uint&& on_uint, _Float&& on_float) {
+		ondemand::number number;
+		if (value.get_number().get(number)) {
+			double big;
+			if (auto error = value.get_double().get(big)) {
+				return error;
+			}
+			return on_float(big);
+		}
+
+		switch (number.get_number_type()) {
+			case ondemand::number_type::signed_integer:
+				return number.get_int64() >= 0
+					? on_uint(static_cast<uint64_t>(number.get_int64()))
+					: on_int(number.get_int64());
+			case ondemand::number_type::unsigned_integer:
+				return on_uint(number.get_uint64());
+			default:
+				return on_float(number.as_double());
+		}
+	}
+
+	template <class _Value>
+	simdjson::error_code Build(_Value& value, nlohmann::json& out) {
+		ondemand::json_type type;
+		if (auto error = value.type().get(type)) {
+			return error;
+		}
+
+		switch (type) {
+			case ondemand::json_type::object: {
+				ondemand::object object;
+				if (auto error = value.get_object().get(object)) {
+					return error;
+				}
+
+				out = nlohmann::json::object();
+				for (auto field : object) {
+					std::string_view key;
+					ondemand::value member;
+					if (auto error = field.unescaped_key().get(key)) {
+						return error;
+					}
+					if (auto error = field.value().get(member)) {
+						return error;
+					}
+					if (auto error = Build(member, out[std::string(key)])) {
+						return error;
+					}
+				}
+				return simdjson::SUCCESS;
+			}
+			case ondemand::json_type::array: {
+				ondemand::array array;
+				if (auto error = value.get_array().get(array)) {
+					return error;
+				}
+
+				out = nlohmann::json::array();
+				auto& elements = out.get_ref<nlohmann::json::array_t&>();
+				for (auto element : array) {
+					ondemand::value item;
+					if (auto error = element.get(item)) {
+						return error;
+					}
+					if (auto error = Build(item, elements.emplace_back())) {
+						return error;
+					}
+				}
+				return simdjson::SUCCESS;
+			}
+			case ondemand::json_type::number:
+				return ReadNumber(value,
+					[&](int64_t number) { out = number; return simdjson::SUCCESS; },
+					[&](uint64_t number) { out = number; return simdjson::SUCCESS; },
+					[&](double number) { out = number; return simdjson::SUCCESS; }
+				);
+			case ondemand::json_type::string: {
+				std::string_view string;
+				if (auto error = value.get_string().get(string)) {
+					return error;
+				}
+				out = std::string(string);
+				return simdjson::SUCCESS;
+			}
+			case ondemand::json_type::boolean: {
+				bool boolean;
+				if (auto error = value.get_bool().get(boolean)) {
+					return error;
+				}
+				out = boolean;
+				return simdjson::SUCCESS;
+			}
+			case ondemand::json_type::null: {
+				bool null;
+				if (auto error = value.is_null().get(null)) {
+					return error;
+				}
+				out = nullptr;
+				return null ? simdjson::SUCCESS : simdjson::N_ATOM_ERROR;
+			}
+			default:
+				return simdjson::INCORRECT_TYPE;
+		}
+	}
+
+	class SaxWalker final {
+		public:
+			explicit SaxWalker(nlohmann::json_sax<nlohmann::json>& handler) : handler_(handler) {}
+
+			template <class _Value>
+			simdjson::error_code Walk(_Value& value) {
+				ondemand::json_type type;
+				if (auto error = value.type().get(type)) {
+					return error;
+				}
+
+				switch (type) {
+					case ondemand::json_type::object: {
+						ondemand::object object;
+						if (auto error = value.get_object().get(object)) {
+							return error;
+						}
+						if (!this->handler_.start_object(static_cast<std::size_t>(-1))) {
+							return this->Stop();
+						}
+
+						for (auto field : object) {
+							std::string_view key;
+							ondemand::value member;
+							if (auto error = field.unescaped_key().get(key)) {
+								return error;
+							}
+							this->string_.assign(key.data(), key.size());
+							if (!this->handler_.key(this->string_)) {
+								return this->Stop();
+							}
+							if (auto error = field.value().get(member)) {
+								return error;
+							}
+							if (auto error = this->Walk(member)) {
+								return error;
+							}
+						}
+						return this->handler_.end_object() ? simdjson::SUCCESS : this->Stop();
+					}
+					case ondemand::json_type::array: {
+						ondemand::array array;
+						if (auto error = value.get_array().get(array)) {
+							return error;
+						}
+						if (!this->handler_.start_array(static_cast<std::size_t>(-1))) {
+							return this->Stop();
+						}
+
+						for (auto element : array) {
+							ondemand::value item;
+							if (auto error = element.get(item)) {
+								return error;
+							}
+							if (auto error = this->Walk(item)) {
+								return error;
+							}
+						}
+						return this->handler_.end_array() ? simdjson::SUCCESS : this->Stop();
+					}
+					case ondemand::json_type::number: {
+						// raw tokens keep any whitespace that follows them
+						std::string_view token = Token(value);
+						while (!token.empty() && (token.back() == ' ' || token.back() == '\t' || token.back() == '\n' || token.back() == '\r')) {
+							token.remove_suffix(1);
+						}
+						return ReadNumber(value,
+							[&](int64_t number) { return this->handler_.number_integer(number) ? simdjson::SUCCESS : this->Stop(); },
+							[&](uint64_t number) { return this->handler_.number_unsigned(number) ? simdjson::SUCCESS : this->Stop(); },
+							[&](double number) {
+								this->string_.assign(token.data(), token.size());
+								return this->handler_.number_float(number, this->string_) ? simdjson::SUCCESS : this->Stop();
+							}
+						);
+					}
+					case ondemand::json_type::string: {
+						std::string_view string;
+						if (auto error = value.get_string().get(string)) {
+							return error;
+						}
+						this->string_.assign(string.data(), string.size());
+						return this->handler_.string(this->string_) ? simdjson::SUCCESS : this->Stop();
+					}
+					case ondemand::json_type::boolean: {
+						bool boolean;
+						if (auto error = value.get_bool().get(boolean)) {
+							return error;
+						}
+						return this->handler_.boolean(boolean) ? simdjson::SUCCESS : this->Stop();
+					}
+					case ondemand::json_type::null: {
+						bool null;
+						if (auto error = value.is_null().get(null)) {
+							return error;
+						}
+						if (!null) {
+							return simdjson::N_ATOM_ERROR;
+						}
+						return this->handler_.null() ? simdjson::SUCCESS : this->Stop();
+					}
+					default:
+						return simdjson::INCORRECT_TYPE;
+				}
+			}
+
+			bool Stopped() const noexcept { return this->stopped_; }
+
+		private:
+			simdjson::error_code Stop() {
+				this->stopped_ = true;
+				return simdjson::UNEXPECTED_ERROR;
+			}
+
+			nlohmann::json_sax<nlohmann::json>& handler_;
+			std::string string_;   // reused for keys, strings and number text
+			bool stopped_ = false;
+	};
+}
+
+const char* liboai::JsonParser::Backend() noexcept {
+	return "simdjson";
+}
+
+nlohmann::json liboai::JsonParser::Parse(std::string_view json, bool throwing) noexcept(false) {
+	nlohmann::json out;
+	simdjson::error_code error = Iterate(json, [&](ondemand::document& document) {
+		return Build(document, out);
+	});
+
+	if (error) {
+		if (throwing) {
+			throw liboai::exception::OpenAIException(
+				simdjson::error_message(error),
+				liboai::exception::EType::E_FAILURETOPARSE,
+				"liboai::JsonParser::Parse()"
+			);
+		}
+		return nlohmann::json(nlohmann::json::value_t::discarded);
+	}
+
+	return out;
+}
+
+bool liboai::JsonParser::Sax(std::string_view json, nlohmann::json_sax<nlohmann::json>& handler, std::string& error) {
+	SaxWalker walker(handler);
+	simdjson::error_code code = Iterate(json, [&](ondemand::document& document) {
+		return walker.Walk(document);
+	});
+
+	if (code && !walker.Stopped()) {
+		error = simdjson::error_message(code);
+	}
+	return !code;
+}
+
+#else
+
+const char* liboai::JsonParser::Backend() noexcept {
+	return "nlohmann_json";
+}
+
+nlohmann::json liboai::JsonParser::Parse(std::string_view json, bool throwing) noexcept(false) {
+	if (!throwing) {
+		return nlohmann::json::parse(json, nullptr, false);
+	}
+
+	try {
+		return nlohmann::json::parse(json);
+	}
+	catch (nlohmann::json::parse_error& e) {
+		throw liboai::exception::OpenAIException(
+			e.what(),
+			liboai::exception::EType::E_FAILURETOPARSE,
+			"liboai::JsonParser::Parse()"
+		);
+	}
+}
+
+bool liboai::JsonParser::Sax(std::string_view json, nlohmann::json_sax<nlohmann::json>& handler, std::string& /*error*/) {
+	// nlohmann reports errors to the handler itself
+	return nlohmann::json::sax_parse(json.begin(), json.end(), &handler);
+}
+
+#endif
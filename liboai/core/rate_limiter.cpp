@@ -0,0 +1,442 @@
+#include "../include/core/rate_limiter.h"
+#include "../include/core/active.h"
+#include "../include/core/parser.h"
+#include "../include/core/hash.h"
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+	// limits apply per API key and organization, so requests are
+	// bucketed by the headers that carry them
+	constexpr const char* kCredentialHeaders[] = { "Authorization", "api-key", "OpenAI-Organization" };
+
+	std::optional<double> Number(const liboai::netimpl::components::Header& headers, const std::string& name) noexcept {
+		auto found = headers.find(name);
+		if (found == headers.end()) {
+			return std::nullopt;
+		}
+
+		const char* begin = found->second.c_str();
+		char* end = nullptr;
+		double value = std::strtod(begin, &end);
+		if (end == begin || !std::isfinite(value) || value < 0) {
+			return std::nullopt;
+		}
+		return value;
+	}
+
+	/*
+		Reset times are durations such as "1s", "6m0s" or "20ms".
+	*/
+	std::optional<double> Seconds(const liboai::netimpl::components::Header& headers, const std::string& name) noexcept {
+		auto found = headers.find(name);
+		if (found == headers.end() || found->second.empty()) {
+			return std::nullopt;
+		}
+
+		double seconds = 0;
+		const char* at = found->second.c_str();
+		while (*at) {
+			char* end = nullptr;
+			double value = std::strtod(at, &end);
+			if (end == at || !std::isfinite(value) || value < 0) {
+				return std::nullopt;
+			}
+			at = end;
+
+			if (at[0] == 'm' && at[1] == 's') { seconds += value / 1000; at += 2; }
+			else if (at[0] == 'h') { seconds += value * 3600; ++at; }
+			else if (at[0] == 'm') { seconds += value * 60; ++at; }
+			else if (at[0] == 's') { seconds += value; ++at; }
+			else if (at[0] == '\0') { seconds += value; }
+			else { return std::nullopt; }
+		}
+		return seconds;
+	}
+
+	using Clock = std::chrono::steady_clock;
+
+	struct Level {
+		double limit = 0;     // per minute; 0 while unknown, in which case nothing is enforced
+		double available = 0; // may fall below zero when a response reports less than expected
+		double rate = 0;      // refill per second
+		double pending = 0;   // drawn by requests that have not settled yet
+
+		void Refill(double seconds) noexcept;
+		double Wait(double cost) const noexcept;
+		void Draw(double cost) noexcept;
+		void Observe(double limit, double remaining, double reset) noexcept;
+	};
+
+	void Level::Refill(double seconds) noexcept {
+		if (this->limit > 0) {
+			this->available = std::min(this->limit, this->available + this->rate * seconds);
+		}
+	}
+
+	double Level::Wait(double cost) const noexcept {
+		// a request larger than the whole bucket goes once it is full
+		// rather than never
+		double needed = std::min(cost, this->limit) - this->available;
+		if (this->limit <= 0 || needed <= 1e-9) {
+			return 0;
+		}
+		return needed / this->rate;
+	}
+
+	void Level::Draw(double cost) noexcept {
+		this->pending += cost;
+		if (this->limit > 0) {
+			this->available -= cost;
+		}
+	}
+
+	void Level::Observe(double limit, double remaining, double reset) noexcept {
+		if (limit <= 0) {
+			return;
+		}
+
+		// what the API has left, less what was sent since and has not
+		// been counted yet as far as we know; responses can arrive out
+		// of order, so once the limit is known they only ever lower the
+		// estimate, which refilling raises again
+		double available = std::min(limit, remaining) - this->pending;
+		this->available = this->limit > 0 ? std::min(this->available, available) : available;
+		this->limit = limit;
+		this->rate = reset > 0 && limit > remaining ? (limit - remaining) / reset : limit / 60;
+	}
+
+	struct Waiting {
+		double tokens;
+		std::function<void()> grant;
+		uint64_t ticket;
+		std::optional<Clock::time_point> until;
+		std::function<void()> expire; // called instead of 'grant' once 'until' passes
+	};
+
+	struct Bucket {
+		Level requests, tokens;
+		Clock::time_point refilled = Clock::now();
+		std::deque<Waiting> queue;
+
+		void Refill(Clock::time_point now) noexcept {
+			double elapsed = std::chrono::duration<double>(now - this->refilled).count();
+			this->requests.Refill(elapsed);
+			this->tokens.Refill(elapsed);
+			this->refilled = now;
+		}
+	};
+}
+
+struct liboai::RateLimiter::State {
+	RateLimiterOptions options;
+
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::unordered_map<std::string, Bucket> buckets;
+	std::thread thread; // started when a request first has to wait
+	bool stop = false;
+	uint64_t tickets = 0;
+	Stats stats;
+
+	Bucket& BucketOf(const std::string& name) {
+		auto [found, added] = this->buckets.try_emplace(name);
+		if (added) {
+			Bucket& bucket = found->second;
+			bucket.requests.limit = bucket.requests.available = this->options.requests_per_minute;
+			bucket.requests.rate = this->options.requests_per_minute / 60.0;
+			bucket.tokens.limit = bucket.tokens.available = this->options.tokens_per_minute;
+			bucket.tokens.rate = this->options.tokens_per_minute / 60.0;
+		}
+		return found->second;
+	}
+
+	// draws the request's cost at once if its buckets can afford it
+	// and no request is queued ahead of it, returning 0; otherwise
+	// queues it and returns its ticket
+	static uint64_t Enqueue(const std::shared_ptr<State>& state, const Cost& cost, Waiting& waiting);
+
+	// takes a queued request out of the queue; false if it is no
+	// longer there, having been granted
+	bool Withdraw(const std::string& name, uint64_t ticket);
+
+	static void Run(std::shared_ptr<State> state);
+};
+
+liboai::RateLimiter::RateLimiter(RateLimiterOptions options) noexcept : state_(std::make_shared<State>()) {
+	this->state_->options = options;
+}
+
+liboai::RateLimiter::~RateLimiter() {
+	{
+		std::lock_guard<std::mutex> lock(this->state_->mutex);
+		this->state_->stop = true;
+	}
+	this->state_->wake.notify_all();
+
+	if (this->state_->thread.joinable()) {
+		// a grant may drop the last reference to the limiter from
+		// the limiter's own thread, which then finishes on its own
+		if (this->state_->thread.get_id() == std::this_thread::get_id()) {
+			this->state_->thread.detach();
+		}
+		else {
+			this->state_->thread.join();
+		}
+	}
+}
+
+std::optional<liboai::RateLimiter::Cost> liboai::RateLimiter::CostOf(const netimpl::components::Header& headers, std::string_view body) {
+	if (body.empty()) {
+		return std::nullopt;
+	}
+
+	nlohmann::json json = JsonParser::Parse(body, false);
+	if (json.is_discarded() || !json.is_object()) {
+		return std::nullopt;
+	}
+
+	auto model = json.find("model");
+	if (model == json.end() || !model->is_string()) {
+		return std::nullopt;
+	}
+
+	std::string credentials;
+	for (const char* name : kCredentialHeaders) {
+		auto found = headers.find(name);
+		if (found != headers.end()) {
+			credentials.append(found->second).push_back('\n');
+		}
+	}
+
+	uint64_t hash[2];
+	Hash::Murmur3(credentials.data(), credentials.size(), 0, hash);
+
+	Cost cost;
+	static constexpr char digits[] = "0123456789abcdef";
+	for (int shift = 60; shift >= 0; shift -= 4) {
+		cost.bucket.push_back(digits[(hash[0] >> shift) & 0xF]);
+	}
+	cost.bucket.push_back(':');
+	cost.bucket.append(model->get_ref<const std::string&>());
+
+	// the API counts about four characters of prompt per token, and
+	// reserves the most the request may generate up front
+	cost.tokens = body.size() / 4;
+	for (const char* name : { "max_tokens", "max_completion_tokens" }) {
+		auto found = json.find(name);
+		if (found != json.end() && found->is_number_unsigned()) {
+			uint64_t choices = 1;
+			auto n = json.find("n");
+			if (n != json.end() && n->is_number_unsigned()) {
+				choices = std::max<uint64_t>(1, n->get<uint64_t>());
+			}
+			cost.tokens += found->get<uint64_t>() * choices;
+			break;
+		}
+	}
+
+	return cost;
+}
+
+void liboai::RateLimiter::Acquire(const Cost& cost) {
+	// a token that is never cancelled waits for as long as it takes
+	static_cast<void>(this->Acquire(cost, CancellationToken()));
+}
+
+bool liboai::RateLimiter::Acquire(const Cost& cost, const CancellationToken& token, std::optional<Clock::time_point> until) {
+	auto granted = std::make_shared<std::atomic<bool>>(false);
+	Waiting waiting{};
+	waiting.grant = [granted, token]() {
+		granted->store(true, std::memory_order_release);
+		token.Notify();
+	};
+
+	// the caller gives up by itself once 'until' passes, so the queue
+	// need not know about it
+	uint64_t ticket = State::Enqueue(this->state_, cost, waiting);
+	if (ticket == 0) {
+		return true;
+	}
+
+	token.Wait(until, [&granted]() { return granted->load(std::memory_order_acquire); });
+
+	// a grant that came before the request could withdraw stands
+	return granted->load(std::memory_order_acquire) || !this->state_->Withdraw(cost.bucket, ticket);
+}
+
+void liboai::RateLimiter::Schedule(const Cost& cost, std::function<void()> grant, std::optional<Clock::time_point> until, std::function<void()> expire) {
+	Waiting waiting{};
+	waiting.grant = std::move(grant);
+	if (expire) {
+		waiting.until = until;
+		waiting.expire = std::move(expire);
+	}
+
+	if (State::Enqueue(this->state_, cost, waiting) == 0) {
+		waiting.grant();
+	}
+}
+
+void liboai::RateLimiter::Settle(const Cost& cost, const netimpl::components::Header& received) noexcept {
+	static const std::string kRequests[] = { "x-ratelimit-limit-requests", "x-ratelimit-remaining-requests", "x-ratelimit-reset-requests" };
+	static const std::string kTokens[] = { "x-ratelimit-limit-tokens", "x-ratelimit-remaining-tokens", "x-ratelimit-reset-tokens" };
+
+	State& state = *this->state_;
+	std::lock_guard<std::mutex> lock(state.mutex);
+	auto found = state.buckets.find(cost.bucket);
+	if (found == state.buckets.end()) {
+		return;
+	}
+
+	Bucket& bucket = found->second;
+	bucket.requests.pending = std::max(0.0, bucket.requests.pending - 1);
+	bucket.tokens.pending = std::max(0.0, bucket.tokens.pending - static_cast<double>(cost.tokens));
+	bucket.Refill(Clock::now());
+
+	std::pair<Level*, const std::string*> levels[] = { { &bucket.requests, kRequests }, { &bucket.tokens, kTokens } };
+	for (auto& [level, names] : levels) {
+		std::optional<double> limit = Number(received, names[0]), remaining = Number(received, names[1]);
+		if (limit && remaining) {
+			level->Observe(limit.value(), remaining.value(), Seconds(received, names[2]).value_or(0));
+		}
+	}
+
+	// the buckets may have more room than was thought
+	if (!bucket.queue.empty()) {
+		state.wake.notify_all();
+	}
+}
+
+liboai::RateLimiter::Stats liboai::RateLimiter::GetStats() const noexcept {
+	std::lock_guard<std::mutex> lock(this->state_->mutex);
+	return this->state_->stats;
+}
+
+void liboai::RateLimiter::SetActive(std::shared_ptr<RateLimiter> limiter) noexcept {
+	ActiveInstance<RateLimiter>::Set(std::move(limiter));
+}
+
+std::shared_ptr<liboai::RateLimiter> liboai::RateLimiter::Active() noexcept {
+	return ActiveInstance<RateLimiter>::Get();
+}
+
+uint64_t liboai::RateLimiter::State::Enqueue(const std::shared_ptr<State>& state, const Cost& cost, Waiting& waiting) {
+	double tokens = static_cast<double>(cost.tokens);
+	std::lock_guard<std::mutex> lock(state->mutex);
+	Bucket& bucket = state->BucketOf(cost.bucket);
+	bucket.Refill(Clock::now());
+
+	if (!bucket.queue.empty() || bucket.requests.Wait(1) > 0 || bucket.tokens.Wait(tokens) > 0) {
+		waiting.tokens = tokens;
+		waiting.ticket = ++state->tickets;
+		bucket.queue.push_back(std::move(waiting));
+		++state->stats.queued;
+		if (!state->thread.joinable()) {
+			state->thread = std::thread(&State::Run, state);
+		}
+		state->wake.notify_all();
+		return bucket.queue.back().ticket;
+	}
+
+	bucket.requests.Draw(1);
+	bucket.tokens.Draw(tokens);
+	++state->stats.granted;
+	return 0;
+}
+
+bool liboai::RateLimiter::State::Withdraw(const std::string& name, uint64_t ticket) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	auto found = this->buckets.find(name);
+	if (found == this->buckets.end()) {
+		return false;
+	}
+
+	std::deque<Waiting>& queue = found->second.queue;
+	auto waiting = std::find_if(queue.begin(), queue.end(), [ticket](const Waiting& w) { return w.ticket == ticket; });
+	if (waiting == queue.end()) {
+		return false;
+	}
+
+	// the request behind it may be affordable where this one was not
+	bool first = waiting == queue.begin();
+	queue.erase(waiting);
+	if (first && !queue.empty()) {
+		this->wake.notify_all();
+	}
+	return true;
+}
+
+void liboai::RateLimiter::State::Run(std::shared_ptr<State> state) {
+	std::unique_lock<std::mutex> lock(state->mutex);
+	std::vector<std::function<void()>> grants; // and expiries, which are run alike
+
+	while (true) {
+		Clock::time_point now = Clock::now();
+		std::optional<Clock::time_point> next;
+
+		for (auto& [name, bucket] : state->buckets) {
+			bucket.Refill(now);
+
+			// a request whose deadline passes while queued gives up
+			// its place, wherever that is
+			for (auto waiting = bucket.queue.begin(); waiting != bucket.queue.end(); ) {
+				if (waiting->until && now >= waiting->until.value()) {
+					grants.push_back(std::move(waiting->expire));
+					waiting = bucket.queue.erase(waiting);
+					continue;
+				}
+				if (waiting->until) {
+					next = next ? std::min(next.value(), waiting->until.value()) : waiting->until.value();
+				}
+				++waiting;
+			}
+
+			while (!bucket.queue.empty()) {
+				Waiting& waiting = bucket.queue.front();
+				double wait = state->stop ? 0 : std::max(bucket.requests.Wait(1), bucket.tokens.Wait(waiting.tokens));
+				if (wait > 0) {
+					Clock::time_point at = now + std::chrono::ceil<Clock::duration>(std::chrono::duration<double>(wait));
+					next = next ? std::min(next.value(), at) : at;
+					break;
+				}
+
+				bucket.requests.Draw(1);
+				bucket.tokens.Draw(waiting.tokens);
+				++state->stats.granted;
+				grants.push_back(std::move(waiting.grant));
+				bucket.queue.pop_front();
+			}
+		}
+
+		if (!grants.empty()) {
+			lock.unlock();
+			for (std::function<void()>& grant : grants) {
+				try {
+					grant();
+				}
+				catch (...) {
+					// a grant's failure is its request's own
+				}
+			}
+			grants.clear();
+			lock.lock();
+			continue;
+		}
+
+		if (state->stop) {
+			return;
+		}
+
+		if (next) {
+			state->wake.wait_until(lock, next.value());
+		}
+		else {
+			state->wake.wait(lock);
+		}
+	}
+}
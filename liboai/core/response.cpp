@@ -1,50 +1,133 @@
 #include "../include/core/response.h"
+#include "../include/core/parser.h"
+#include <cmath>
+#include <atomic>
+#include <cstdio>
+
+void liboai::JsonConstructor::write_string(std::string& out, std::string_view value) {
+	out.push_back('"');
+
+	// copy runs of characters that need no escaping in one go
+	size_t run = 0;
+	for (size_t i = 0; i < value.size(); ++i) {
+		unsigned char c = static_cast<unsigned char>(value[i]);
+		if (c >= 0x20 && c != '"' && c != '\\') {
+			continue;
+		}
+
+		out.append(value.data() + run, i - run);
+		run = i + 1;
+
+		switch (c) {
+			case '"':  out += "\\\""; break;
+			case '\\': out += "\\\\"; break;
+			case '\b': out += "\\b";  break;
+			case '\f': out += "\\f";  break;
+			case '\n': out += "\\n";  break;
+			case '\r': out += "\\r";  break;
+			case '\t': out += "\\t";  break;
+			default: {
+				static constexpr char hex[] = "0123456789abcdef";
+				out += "\\u00";
+				out.push_back(hex[c >> 4]);
+				out.push_back(hex[c & 0xF]);
+			}
+		}
+	}
+	out.append(value.data() + run, value.size() - run);
+
+	out.push_back('"');
+}
+
+void liboai::JsonConstructor::write_number(double value) {
+	if (!std::isfinite(value)) {
+		this->_buffer += "null"; // as nlohmann::json does
+		return;
+	}
+
+	char digits[32];
+	#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+		auto result = std::to_chars(digits, digits + sizeof(digits), value);
+		this->_buffer.append(digits, result.ptr);
+	#else
+		int length = std::snprintf(digits, sizeof(digits), "%.17g", value);
+		this->_buffer.append(digits, static_cast<size_t>(length));
+	#endif
+}
+
+void liboai::JsonConstructor::write_number(float value) {
+	if (!std::isfinite(value)) {
+		this->_buffer += "null";
+		return;
+	}
+
+	// shortest form that round-trips as a float, so 0.7f is
+	// written as 0.7 rather than 0.699999988079071
+	char digits[32];
+	#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+		auto result = std::to_chars(digits, digits + sizeof(digits), value);
+		this->_buffer.append(digits, result.ptr);
+	#else
+		int length = std::snprintf(digits, sizeof(digits), "%.9g", static_cast<double>(value));
+		this->_buffer.append(digits, static_cast<size_t>(length));
+	#endif
+}
+
+namespace {
+	std::atomic<bool> _lazy_parsing{ false };
+	std::atomic<bool> _release_content{ false };
+}
 
 liboai::Response::Response(const liboai::Response& other) noexcept
 	: status_code(other.status_code), elapsed(other.elapsed), status_line(other.status_line),
-	content(other.content), url(other.url), reason(other.reason), raw_json(other.raw_json) {}
+	url(other.url), reason(other.reason)
+{
+	std::lock_guard<std::mutex> lock(other.parse_mutex_);
+	this->content = other.content;
+	this->raw_json = other.raw_json;
+	this->parsed_.store(other.parsed_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
 
 liboai::Response::Response(liboai::Response&& other) noexcept
 	: status_code(other.status_code), elapsed(other.elapsed), status_line(std::move(other.status_line)),
-	content(std::move(other.content)), url(std::move(other.url)), reason(std::move(other.reason)), raw_json(std::move(other.raw_json)) {}
+	content(std::move(other.content)), url(std::move(other.url)), reason(std::move(other.reason)), raw_json(std::move(other.raw_json)),
+	parsed_(other.parsed_.load(std::memory_order_relaxed)) {}
 
 liboai::Response::Response(std::string&& url, std::string&& content, std::string&& status_line, std::string&& reason, long status_code, double elapsed) noexcept(false) 
 	: status_code(status_code), elapsed(elapsed), status_line(std::move(status_line)),
-	content(std::move(content)), url(url), reason(std::move(reason))
+	content(std::move(content)), url(std::move(url)), reason(std::move(reason)), parsed_(false)
 {
-	try {
-		if (!this->content.empty()) {
-			if (this->content[0] == '{') {
-				this->raw_json = nlohmann::json::parse(this->content);
-			}
-			else {
-				this->raw_json = nlohmann::json();
-			}
-		}
-		else {
-			this->raw_json = nlohmann::json();
+	// in lazy mode a successful response is left unparsed; the
+	// status code alone says there is no error to extract
+	bool success = this->status_code >= 200 && this->status_code < 300;
+	if (!_lazy_parsing.load(std::memory_order_relaxed) || !success) {
+		this->Parse();
+		this->parsed_.store(true, std::memory_order_relaxed);
+
+		if (_release_content.load(std::memory_order_relaxed) && !this->raw_json.is_null()) {
+			std::string().swap(this->content);
 		}
 	}
-	catch (nlohmann::json::parse_error& e) {
-		throw liboai::exception::OpenAIException(
-			e.what(),
-			liboai::exception::EType::E_FAILURETOPARSE,
-			"liboai::Response::Response(std::string&&, std::string&&, ...)"
-		);
-	}
 
 	// check the response for errors -- nothrow on success
 	this->CheckResponse();
 }
 
 liboai::Response& liboai::Response::operator=(const liboai::Response& other) noexcept {
+	if (this == &other) {
+		return *this;
+	}
+
 	this->status_code = other.status_code;
 	this->elapsed = other.elapsed;
 	this->status_line = other.status_line;
-	this->content = other.content;
 	this->url = other.url;
 	this->reason = other.reason;
+
+	std::lock_guard<std::mutex> lock(other.parse_mutex_);
+	this->content = other.content;
 	this->raw_json = other.raw_json;
+	this->parsed_.store(other.parsed_.load(std::memory_order_relaxed), std::memory_order_relaxed);
 
 	return *this;
 }
@@ -57,14 +140,53 @@ liboai::Response& liboai::Response::operator=(liboai::Response&& other) noexcept
 	this->url = std::move(other.url);
 	this->reason = std::move(other.reason);
 	this->raw_json = std::move(other.raw_json);
+	this->parsed_.store(other.parsed_.load(std::memory_order_relaxed), std::memory_order_relaxed);
 
 	return *this;
 }
 
+const nlohmann::json& liboai::Response::GetJSON() const noexcept(false) {
+	// the body is parsed by whichever thread gets here first; a
+	// failed parse leaves it unparsed, to throw again next time
+	if (!this->parsed_.load(std::memory_order_acquire)) {
+		std::lock_guard<std::mutex> lock(this->parse_mutex_);
+		if (!this->parsed_.load(std::memory_order_relaxed)) {
+			this->Parse();
+			this->parsed_.store(true, std::memory_order_release);
+		}
+	}
+	return this->raw_json;
+}
+
+void liboai::Response::SetLazyParsing(bool lazy) noexcept {
+	_lazy_parsing.store(lazy, std::memory_order_relaxed);
+}
+
+bool liboai::Response::LazyParsing() noexcept {
+	return _lazy_parsing.load(std::memory_order_relaxed);
+}
+
+void liboai::Response::SetReleaseContent(bool release) noexcept {
+	_release_content.store(release, std::memory_order_relaxed);
+}
+
+bool liboai::Response::ReleaseContent() noexcept {
+	return _release_content.load(std::memory_order_relaxed);
+}
+
+void liboai::Response::Parse() const noexcept(false) {
+	if (!this->content.empty() && this->content[0] == '{') {
+		this->raw_json = liboai::JsonParser::Parse(this->content);
+	}
+	else {
+		this->raw_json = nlohmann::json();
+	}
+}
+
 namespace liboai {
 
 std::ostream& operator<<(std::ostream& os, const Response& r) {
-	!r.raw_json.empty() ? os << r.raw_json.dump(4) : os << "null";
+	!r.GetJSON().empty() ? os << r.GetJSON().dump(4) : os << "null";
 	return os;
 }
 
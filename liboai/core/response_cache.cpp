@@ -0,0 +1,437 @@
+#include "../include/core/response_cache.h"
+#include "../include/core/active.h"
+#include "../include/core/parser.h"
+#include "../include/core/hash.h"
+#include <fstream>
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+	constexpr char kMagic[8] = { 'L', 'I', 'B', 'O', 'A', 'I', 'R', 'C' };
+	constexpr uint32_t kVersion = 1;
+	constexpr const char* kExtension = ".resp";
+
+	struct DiskHeader {
+		char magic[8];
+		uint32_t version;
+		uint32_t reserved;
+		int64_t expires;
+		int64_t status_code;
+		uint64_t sizes[4]; // url, status line, reason, content
+	};
+
+	int64_t Now() noexcept {
+		return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	}
+
+	bool EndsWith(std::string_view text, std::string_view suffix) noexcept {
+		return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+	}
+
+	std::string Hex(const liboai::ResponseCache::Key& key) {
+		static constexpr char digits[] = "0123456789abcdef";
+		std::string hex(32, '0');
+		for (size_t i = 0; i < 32; ++i) {
+			hex[i] = digits[(key.hash[i / 16] >> (60 - (i % 16) * 4)) & 0xF];
+		}
+		return hex;
+	}
+
+	bool FromHex(std::string_view hex, liboai::ResponseCache::Key& key) noexcept {
+		if (hex.size() != 32) {
+			return false;
+		}
+
+		key.hash[0] = key.hash[1] = 0;
+		for (size_t i = 0; i < 32; ++i) {
+			char c = hex[i];
+			uint64_t digit;
+			if (c >= '0' && c <= '9') {
+				digit = static_cast<uint64_t>(c - '0');
+			}
+			else if (c >= 'a' && c <= 'f') {
+				digit = static_cast<uint64_t>(c - 'a' + 10);
+			}
+			else {
+				return false;
+			}
+			key.hash[i / 16] = (key.hash[i / 16] << 4) | digit;
+		}
+		return true;
+	}
+}
+
+liboai::ResponseCache::ResponseCache(ResponseCacheOptions options) noexcept(false) : options_(std::move(options)) {
+	if (this->options_.directory) {
+		std::error_code error;
+		std::filesystem::create_directories(this->options_.directory.value(), error);
+		if (error) {
+			throw liboai::exception::OpenAIException(
+				"Failed to create response cache directory " + this->options_.directory.value().string() + ": " + error.message(),
+				liboai::exception::EType::E_FILEERROR,
+				"liboai::ResponseCache::ResponseCache()"
+			);
+		}
+		this->Scan();
+	}
+}
+
+std::optional<liboai::ResponseCache::Key> liboai::ResponseCache::KeyOf(std::string_view method, std::string_view url, std::string_view body, std::string_view context) const {
+	return KeyOf(method, url, body, context, &this->options_.endpoints, this->options_.deterministic_only);
+}
+
+std::optional<liboai::ResponseCache::Key> liboai::ResponseCache::KeyOf(std::string_view method, std::string_view url, std::string_view body, std::string_view context, const std::vector<std::string>* endpoints, bool deterministic_only) {
+	if (method != "GET" && method != "POST") {
+		return std::nullopt;
+	}
+	if (endpoints && std::none_of(endpoints->begin(), endpoints->end(), [url](const std::string& endpoint) { return EndsWith(url, endpoint); })) {
+		return std::nullopt;
+	}
+
+	// completions sample at a temperature of 1 unless told otherwise
+	bool samples = EndsWith(url, "/completions");
+
+	std::string canonical;
+	if (!body.empty()) {
+		nlohmann::json json = JsonParser::Parse(body, false);
+		if (json.is_discarded() || !json.is_object()) {
+			return std::nullopt;
+		}
+
+		auto stream = json.find("stream");
+		if (stream != json.end() && stream->is_boolean() && stream->get<bool>()) {
+			return std::nullopt;
+		}
+
+		auto temperature = json.find("temperature");
+		if (temperature != json.end()) {
+			samples = !temperature->is_number() || temperature->get<double>() != 0.0;
+		}
+
+		// objects are ordered by key, and dump() writes no whitespace
+		canonical = json.dump();
+	}
+
+	if (samples && deterministic_only) {
+		return std::nullopt;
+	}
+
+	std::string data;
+	data.reserve(method.size() + url.size() + context.size() + canonical.size() + 3);
+	data.append(method).push_back('\n');
+	data.append(url).push_back('\n');
+	data.append(context).push_back('\n');
+	data.append(canonical);
+
+	Key key;
+	Hash::Murmur3(data.data(), data.size(), 0, key.hash);
+	return key;
+}
+
+std::optional<liboai::Response> liboai::ResponseCache::Lookup(const Key& key) {
+	int64_t now = Now();
+	Entry entry;
+
+	std::unique_lock<std::mutex> lock(this->mutex_);
+	auto found = this->memory_index_.find(key);
+	if (found != this->memory_index_.end()) {
+		if (found->second->expires == 0 || now < found->second->expires) {
+			this->memory_.splice(this->memory_.begin(), this->memory_, found->second);
+			++this->stats_.memory_hits;
+			entry = *found->second;
+			lock.unlock();
+
+			return liboai::Response(std::move(entry.url), std::move(entry.content), std::move(entry.status_line), std::move(entry.reason), entry.status_code, 0.0);
+		}
+
+		this->memory_bytes_ -= found->second->bytes;
+		this->memory_.erase(found->second);
+		this->memory_index_.erase(found);
+	}
+
+	if (this->disk_index_.count(key) == 0) {
+		++this->stats_.misses;
+		return std::nullopt;
+	}
+
+	// the file is read without holding the lock; should it be
+	// evicted meanwhile, the read fails and the lookup misses
+	lock.unlock();
+	bool read = this->ReadDisk(key, entry);
+	lock.lock();
+
+	auto on_disk = this->disk_index_.find(key);
+	if (!read || on_disk == this->disk_index_.end() || (entry.expires != 0 && now >= entry.expires)) {
+		if (on_disk != this->disk_index_.end()) {
+			this->disk_bytes_ -= on_disk->second->bytes;
+			this->disk_.erase(on_disk->second);
+			this->disk_index_.erase(on_disk);
+
+			std::error_code error;
+			std::filesystem::remove(this->PathOf(key), error);
+		}
+		++this->stats_.misses;
+		return std::nullopt;
+	}
+
+	this->disk_.splice(this->disk_.begin(), this->disk_, on_disk->second);
+	++this->stats_.disk_hits;
+	this->Remember(entry);
+	lock.unlock();
+
+	// keep the disk tier's order across restarts
+	std::error_code error;
+	std::filesystem::last_write_time(this->PathOf(key), std::filesystem::file_time_type::clock::now(), error);
+
+	return liboai::Response(std::move(entry.url), std::move(entry.content), std::move(entry.status_line), std::move(entry.reason), entry.status_code, 0.0);
+}
+
+void liboai::ResponseCache::Store(const Key& key, const liboai::Response& response) noexcept {
+	if (response.status_code < 200 || response.status_code >= 300) {
+		return;
+	}
+
+	try {
+		Entry entry;
+		entry.key = key;
+		entry.url = response.url;
+		entry.status_line = response.status_line;
+		entry.reason = response.reason;
+		entry.content = response.content.empty() && !response.GetJSON().is_null() ? response.GetJSON().dump() : response.content; // content may have been released
+		entry.status_code = response.status_code;
+		entry.expires = this->options_.ttl.count() != 0 ? Now() + this->options_.ttl.count() : 0;
+		entry.bytes = sizeof(Entry) + entry.url.size() + entry.status_line.size() + entry.reason.size() + entry.content.size();
+
+		bool written = this->options_.directory && this->WriteDisk(entry);
+		uint64_t bytes = sizeof(DiskHeader) + entry.url.size() + entry.status_line.size() + entry.reason.size() + entry.content.size();
+
+		std::vector<Key> evicted;
+		{
+			std::lock_guard<std::mutex> lock(this->mutex_);
+			this->Remember(std::move(entry));
+
+			if (written) {
+				auto found = this->disk_index_.find(key);
+				if (found != this->disk_index_.end()) {
+					this->disk_bytes_ -= found->second->bytes;
+					this->disk_.erase(found->second);
+				}
+				this->disk_.push_front(DiskEntry{ key, bytes });
+				this->disk_index_[key] = this->disk_.begin();
+				this->disk_bytes_ += bytes;
+
+				while (this->disk_bytes_ > this->options_.disk_bytes && !this->disk_.empty()) {
+					const DiskEntry& last = this->disk_.back();
+					evicted.push_back(last.key);
+					this->disk_bytes_ -= last.bytes;
+					this->disk_index_.erase(last.key);
+					this->disk_.pop_back();
+				}
+			}
+		}
+
+		for (const Key& old : evicted) {
+			std::error_code error;
+			std::filesystem::remove(this->PathOf(old), error);
+		}
+	}
+	catch (...) {
+		// a response that cannot be cached is simply not cached
+	}
+}
+
+void liboai::ResponseCache::Clear() noexcept {
+	std::vector<Key> files;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex_);
+		this->memory_.clear();
+		this->memory_index_.clear();
+		this->memory_bytes_ = 0;
+
+		for (const DiskEntry& entry : this->disk_) {
+			files.push_back(entry.key);
+		}
+		this->disk_.clear();
+		this->disk_index_.clear();
+		this->disk_bytes_ = 0;
+	}
+
+	for (const Key& key : files) {
+		std::error_code error;
+		std::filesystem::remove(this->PathOf(key), error);
+	}
+}
+
+liboai::ResponseCache::Stats liboai::ResponseCache::GetStats() const noexcept {
+	std::lock_guard<std::mutex> lock(this->mutex_);
+
+	Stats stats = this->stats_;
+	stats.memory_entries = this->memory_.size();
+	stats.memory_bytes = this->memory_bytes_;
+	stats.disk_entries = this->disk_.size();
+	stats.disk_bytes = this->disk_bytes_;
+	return stats;
+}
+
+void liboai::ResponseCache::SetActive(std::shared_ptr<ResponseCache> cache) noexcept {
+	ActiveInstance<ResponseCache>::Set(std::move(cache));
+}
+
+std::shared_ptr<liboai::ResponseCache> liboai::ResponseCache::Active() noexcept {
+	return ActiveInstance<ResponseCache>::Get();
+}
+
+std::filesystem::path liboai::ResponseCache::PathOf(const Key& key) const {
+	return this->options_.directory.value() / (Hex(key) + kExtension);
+}
+
+void liboai::ResponseCache::Remember(Entry entry) {
+	auto found = this->memory_index_.find(entry.key);
+	if (found != this->memory_index_.end()) {
+		this->memory_bytes_ -= found->second->bytes;
+		this->memory_.erase(found->second);
+		this->memory_index_.erase(found);
+	}
+	if (entry.bytes > this->options_.memory_bytes) {
+		return;
+	}
+
+	this->memory_bytes_ += entry.bytes;
+	this->memory_.push_front(std::move(entry));
+	this->memory_index_[this->memory_.front().key] = this->memory_.begin();
+
+	while (this->memory_bytes_ > this->options_.memory_bytes) {
+		const Entry& last = this->memory_.back();
+		this->memory_bytes_ -= last.bytes;
+		this->memory_index_.erase(last.key);
+		this->memory_.pop_back();
+	}
+}
+
+bool liboai::ResponseCache::ReadDisk(const Key& key, Entry& entry) const {
+	std::ifstream file(this->PathOf(key), std::ios::binary | std::ios::ate);
+	if (!file) {
+		return false;
+	}
+	uint64_t size = static_cast<uint64_t>(file.tellg());
+	file.seekg(0);
+
+	DiskHeader header;
+	if (size < sizeof(header) || !file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+		return false;
+	}
+	if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion) {
+		return false;
+	}
+
+	uint64_t total = 0;
+	for (uint64_t part : header.sizes) {
+		if (part > size) {
+			return false;
+		}
+		total += part;
+	}
+	if (sizeof(header) + total != size) {
+		return false;
+	}
+
+	std::string* parts[4] = { &entry.url, &entry.status_line, &entry.reason, &entry.content };
+	for (size_t i = 0; i < 4; ++i) {
+		parts[i]->resize(static_cast<size_t>(header.sizes[i]));
+		if (!file.read(parts[i]->data(), static_cast<std::streamsize>(header.sizes[i]))) {
+			return false;
+		}
+	}
+
+	entry.key = key;
+	entry.status_code = static_cast<long>(header.status_code);
+	entry.expires = header.expires;
+	entry.bytes = sizeof(Entry) + entry.url.size() + entry.status_line.size() + entry.reason.size() + entry.content.size();
+	return true;
+}
+
+bool liboai::ResponseCache::WriteDisk(const Entry& entry) const {
+	static std::atomic<uint64_t> sequence = 0;
+
+	DiskHeader header{};
+	std::memcpy(header.magic, kMagic, sizeof(kMagic));
+	header.version = kVersion;
+	header.expires = entry.expires;
+	header.status_code = entry.status_code;
+	header.sizes[0] = entry.url.size();
+	header.sizes[1] = entry.status_line.size();
+	header.sizes[2] = entry.reason.size();
+	header.sizes[3] = entry.content.size();
+
+	// written under a temporary name and renamed into place, so that
+	// readers never see a partly written file
+	std::filesystem::path path = this->PathOf(entry.key);
+	std::filesystem::path temporary = path;
+	temporary += ".tmp" + std::to_string(sequence.fetch_add(1, std::memory_order_relaxed));
+
+	{
+		std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		for (const std::string* part : { &entry.url, &entry.status_line, &entry.reason, &entry.content }) {
+			file.write(part->data(), static_cast<std::streamsize>(part->size()));
+		}
+		file.close();
+
+		std::error_code error;
+		if (!file) {
+			std::filesystem::remove(temporary, error);
+			return false;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temporary, path, error);
+	if (error) {
+		std::filesystem::remove(temporary, error);
+		return false;
+	}
+	return true;
+}
+
+void liboai::ResponseCache::Scan() {
+	struct Found {
+		Key key;
+		uint64_t bytes;
+		std::filesystem::file_time_type time;
+	};
+	std::vector<Found> found;
+
+	std::error_code error;
+	for (const auto& file : std::filesystem::directory_iterator(this->options_.directory.value(), error)) {
+		std::error_code file_error;
+		if (!file.is_regular_file(file_error) || file.path().extension() != kExtension) {
+			continue;
+		}
+
+		Key key;
+		if (FromHex(file.path().stem().string(), key)) {
+			uint64_t bytes = file.file_size(file_error);
+			auto time = file.last_write_time(file_error);
+			if (!file_error) {
+				found.push_back(Found{ key, bytes, time });
+			}
+		}
+	}
+
+	// most recently used first, as in memory
+	std::sort(found.begin(), found.end(), [](const Found& a, const Found& b) { return a.time > b.time; });
+	for (const Found& file : found) {
+		this->disk_.push_back(DiskEntry{ file.key, file.bytes });
+		this->disk_index_[file.key] = std::prev(this->disk_.end());
+		this->disk_bytes_ += file.bytes;
+	}
+
+	while (this->disk_bytes_ > this->options_.disk_bytes && !this->disk_.empty()) {
+		const DiskEntry& last = this->disk_.back();
+		std::filesystem::remove(this->PathOf(last.key), error);
+		this->disk_bytes_ -= last.bytes;
+		this->disk_index_.erase(last.key);
+		this->disk_.pop_back();
+	}
+}
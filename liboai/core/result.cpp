@@ -0,0 +1,130 @@
+#include "../include/core/result.h"
+
+void liboai::SaxReader::Parse(std::string_view json) noexcept(false) {
+	this->stack_.clear();
+	this->error_.clear();
+
+	std::string error;
+	if (!JsonParser::Sax(json, *this, error)) {
+		if (this->error_.empty()) {
+			this->error_ = error.empty() ? "Failed to parse response" : std::move(error);
+		}
+		throw liboai::exception::OpenAIException(
+			this->error_,
+			liboai::exception::EType::E_FAILURETOPARSE,
+			"liboai::SaxReader::Parse()"
+		);
+	}
+}
+
+bool liboai::SaxReader::null() {
+	return true;
+}
+
+bool liboai::SaxReader::boolean(bool value) {
+	this->OnBoolean(value);
+	return true;
+}
+
+bool liboai::SaxReader::number_integer(number_integer_t value) {
+	this->OnNumber(static_cast<double>(value));
+	return true;
+}
+
+bool liboai::SaxReader::number_unsigned(number_unsigned_t value) {
+	this->OnNumber(static_cast<double>(value));
+	return true;
+}
+
+bool liboai::SaxReader::number_float(number_float_t value, const string_t& /*text*/) {
+	this->OnNumber(value);
+	return true;
+}
+
+bool liboai::SaxReader::string(string_t& value) {
+	this->OnString(value);
+	return true;
+}
+
+bool liboai::SaxReader::binary(binary_t& /*value*/) {
+	return true;
+}
+
+bool liboai::SaxReader::start_object(std::size_t /*elements*/) {
+	this->OnEnter(false);
+	this->stack_.push_back(Frame{ false, {} });
+	return true;
+}
+
+bool liboai::SaxReader::key(string_t& value) {
+	this->stack_.back().key.swap(value);
+	return true;
+}
+
+bool liboai::SaxReader::end_object() {
+	this->stack_.pop_back();
+	this->OnLeave(false);
+	return true;
+}
+
+bool liboai::SaxReader::start_array(std::size_t /*elements*/) {
+	this->OnEnter(true);
+	this->stack_.push_back(Frame{ true, {} });
+	return true;
+}
+
+bool liboai::SaxReader::end_array() {
+	this->stack_.pop_back();
+	this->OnLeave(true);
+	return true;
+}
+
+bool liboai::SaxReader::parse_error(std::size_t /*position*/, const std::string& /*last_token*/, const nlohmann::detail::exception& ex) {
+	this->error_ = ex.what();
+	return false;
+}
+
+bool liboai::SaxReader::At(std::initializer_list<std::string_view> path) const noexcept {
+	if (path.size() != this->stack_.size()) {
+		return false;
+	}
+
+	auto segment = path.begin();
+	for (const Frame& frame : this->stack_) {
+		if (frame.array ? *segment != "#" : (*segment != "*" && *segment != frame.key)) {
+			return false;
+		}
+		++segment;
+	}
+
+	return true;
+}
+
+std::string_view liboai::SaxReader::Key() const noexcept {
+	if (this->stack_.empty() || this->stack_.back().array) {
+		return {};
+	}
+	return this->stack_.back().key;
+}
+
+bool liboai::SaxReader::ReadUsage(Usage& usage, double value) const noexcept {
+	if (this->stack_.size() != 2 || this->stack_[0].key != "usage") {
+		return false;
+	}
+
+	std::string_view key = this->stack_[1].key;
+	if (key == "prompt_tokens") {
+		usage.prompt_tokens = static_cast<uint32_t>(value);
+	}
+	else if (key == "completion_tokens") {
+		usage.completion_tokens = static_cast<uint32_t>(value);
+	}
+	else if (key == "total_tokens") {
+		usage.total_tokens = static_cast<uint32_t>(value);
+	}
+	else {
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,211 @@
+#include "../include/core/retry_policy.h"
+#include "../include/core/active.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <thread>
+
+namespace {
+	int64_t DaysFromCivil(int64_t year, unsigned month, unsigned day) noexcept {
+		year -= month <= 2;
+		const int64_t era = (year >= 0 ? year : year - 399) / 400;
+		const unsigned yoe = static_cast<unsigned>(year - era * 400);
+		const unsigned doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+		const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+		return era * 146097 + static_cast<int64_t>(doe) - 719468;
+	}
+
+	/*
+		Retry-After is either a number of seconds or an HTTP date,
+		such as "Wed, 21 Oct 2015 07:28:00 GMT"; OpenAI also sends
+		retry-after-ms.
+	*/
+	std::optional<std::chrono::milliseconds> RetryAfter(const liboai::netimpl::components::Header& header) {
+		auto found = header.find("retry-after-ms");
+		if (found != header.end()) {
+			char* end = nullptr;
+			double ms = std::strtod(found->second.c_str(), &end);
+			if (end != found->second.c_str() && ms >= 0) {
+				return std::chrono::milliseconds(static_cast<int64_t>(ms));
+			}
+		}
+
+		found = header.find("Retry-After");
+		if (found == header.end()) {
+			return std::nullopt;
+		}
+
+		const std::string& value = found->second;
+		char* end = nullptr;
+		double seconds = std::strtod(value.c_str(), &end);
+		if (end != value.c_str() && *end == '\0' && seconds >= 0) {
+			return std::chrono::milliseconds(static_cast<int64_t>(seconds * 1000));
+		}
+
+		char weekday[4] = {}, month[4] = {};
+		int day = 0, year = 0, hour = 0, minute = 0, second = 0;
+		if (std::sscanf(value.c_str(), "%3s, %d %3s %d %d:%d:%d", weekday, &day, month, &year, &hour, &minute, &second) != 7) {
+			return std::nullopt;
+		}
+
+		static constexpr const char* months[] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+		auto named = std::find_if(std::begin(months), std::end(months), [&month](const char* name) { return std::strcmp(name, month) == 0; });
+		if (named == std::end(months)) {
+			return std::nullopt;
+		}
+
+		int64_t at = DaysFromCivil(year, static_cast<unsigned>(named - std::begin(months) + 1), static_cast<unsigned>(day)) * 86400
+			+ hour * 3600 + minute * 60 + second;
+		int64_t now = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+		return std::chrono::milliseconds(std::max<int64_t>(0, at - now) * 1000);
+	}
+}
+
+struct liboai::RetryPolicy::Timers {
+	struct Timer {
+		std::function<void()> fire;
+		std::optional<CancellationToken> token;
+	};
+
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::multimap<std::chrono::steady_clock::time_point, Timer> pending;
+	std::thread thread; // started with the first timer
+	bool stop = false;
+
+	static void Run(std::shared_ptr<Timers> timers);
+};
+
+liboai::RetryPolicy::RetryPolicy(RetryPolicyOptions options) noexcept
+	: options_(std::move(options)), timers_(std::make_shared<Timers>()) {}
+
+liboai::RetryPolicy::~RetryPolicy() {
+	{
+		std::lock_guard<std::mutex> lock(this->timers_->mutex);
+		this->timers_->stop = true;
+	}
+	this->timers_->wake.notify_all();
+
+	if (this->timers_->thread.joinable()) {
+		// a retry may drop the last reference to the policy from the
+		// policy's own thread, which then finishes on its own
+		if (this->timers_->thread.get_id() == std::this_thread::get_id()) {
+			this->timers_->thread.detach();
+		}
+		else {
+			this->timers_->thread.join();
+		}
+	}
+}
+
+std::optional<std::chrono::milliseconds> liboai::RetryPolicy::Delay(const Failure& failure) const {
+	const RetryRule* rule = nullptr;
+	if (failure.status_code != 0) {
+		auto found = this->options_.statuses.find(failure.status_code);
+		if (found != this->options_.statuses.end()) {
+			rule = &found->second;
+		}
+	}
+	else if (failure.result != CURLE_OK) {
+		auto found = this->options_.curl_errors.find(failure.result);
+		if (found != this->options_.curl_errors.end()) {
+			rule = &found->second;
+		}
+	}
+
+	if (!rule || failure.attempt >= rule->max_attempts) {
+		return std::nullopt;
+	}
+
+	std::optional<std::chrono::milliseconds> delay;
+	if (this->options_.honor_retry_after && failure.header) {
+		delay = RetryAfter(*failure.header);
+	}
+
+	if (!delay) {
+		// decorrelated jitter: somewhere between the base delay and
+		// three times the last one, so that clients that failed
+		// together do not retry together
+		thread_local std::mt19937_64 random(std::random_device{}());
+		int64_t base = std::max<int64_t>(1, rule->base_delay.count());
+		int64_t high = std::max(base, 3 * std::max(base, static_cast<int64_t>(failure.last_delay.count())));
+		delay = std::chrono::milliseconds(std::uniform_int_distribution<int64_t>(base, high)(random));
+		delay = std::min(delay.value(), this->options_.max_delay);
+	}
+
+	if (failure.elapsed + delay.value() > this->options_.max_elapsed) {
+		return std::nullopt;
+	}
+	return delay;
+}
+
+void liboai::RetryPolicy::Schedule(std::chrono::steady_clock::time_point at, std::function<void()> fire, std::optional<CancellationToken> token) {
+	{
+		std::lock_guard<std::mutex> lock(this->timers_->mutex);
+		if (this->timers_->stop) {
+			return;
+		}
+
+		this->timers_->pending.emplace(at, Timers::Timer{ std::move(fire), std::move(token) });
+		if (!this->timers_->thread.joinable()) {
+			this->timers_->thread = std::thread(&Timers::Run, this->timers_);
+		}
+	}
+	this->timers_->wake.notify_all();
+}
+
+void liboai::RetryPolicy::SetActive(std::shared_ptr<RetryPolicy> policy) noexcept {
+	ActiveInstance<RetryPolicy>::Set(std::move(policy));
+}
+
+std::shared_ptr<liboai::RetryPolicy> liboai::RetryPolicy::Active() noexcept {
+	return ActiveInstance<RetryPolicy>::Get();
+}
+
+void liboai::RetryPolicy::Timers::Run(std::shared_ptr<Timers> timers) {
+	std::unique_lock<std::mutex> lock(timers->mutex);
+	std::vector<std::function<void()>> due;
+
+	while (!timers->stop) {
+		// a token cannot wake this thread, so while any wait is made
+		// under one the thread checks back every few milliseconds
+		const auto now = std::chrono::steady_clock::now();
+		bool watched = false;
+		for (auto it = timers->pending.begin(); it != timers->pending.end(); ) {
+			if (it->first <= now || (it->second.token && it->second.token->Cancelled())) {
+				due.push_back(std::move(it->second.fire));
+				it = timers->pending.erase(it);
+				continue;
+			}
+			watched = watched || it->second.token.has_value();
+			++it;
+		}
+
+		if (!due.empty()) {
+			lock.unlock();
+			for (std::function<void()>& fire : due) {
+				fire();
+			}
+			due.clear();
+			lock.lock();
+			continue;
+		}
+
+		if (timers->pending.empty()) {
+			timers->wake.wait(lock);
+		}
+		else {
+			auto until = timers->pending.begin()->first;
+			if (watched) {
+				until = std::min(until, now + std::chrono::milliseconds(10));
+			}
+			timers->wake.wait_until(lock, until);
+		}
+	}
+
+	// waits not yet over are dropped, outside the lock
+	auto dropped = std::move(timers->pending);
+	lock.unlock();
+}
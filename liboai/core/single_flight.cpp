@@ -0,0 +1,105 @@
+#include "../include/core/single_flight.h"
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+	struct KeyHash {
+		size_t operator()(const liboai::ResponseCache::Key& key) const noexcept { return static_cast<size_t>(key.hash[0]); }
+	};
+
+	struct Table {
+		std::mutex mutex;
+		std::unordered_map<liboai::ResponseCache::Key, liboai::SingleFlight::Flight*, KeyHash> flights;
+	};
+
+	Table& Flights() noexcept {
+		static Table table;
+		return table;
+	}
+
+	std::atomic<bool> coalescing = false;
+}
+
+liboai::SingleFlight::Flight::~Flight() {
+	this->Land(std::make_exception_ptr(liboai::exception::OpenAIException(
+		"The request being waited on was abandoned",
+		liboai::exception::EType::E_CONNECTIONERROR,
+		"liboai::SingleFlight::Flight::~Flight()"
+	)));
+}
+
+void liboai::SingleFlight::Flight::Land(const liboai::Response& response) noexcept {
+	this->Deliver(&response, nullptr);
+}
+
+void liboai::SingleFlight::Flight::Land(std::exception_ptr error) noexcept {
+	this->Deliver(nullptr, std::move(error));
+}
+
+void liboai::SingleFlight::Flight::Deliver(const liboai::Response* response, std::exception_ptr error) noexcept {
+	std::vector<Waiter> waiters;
+	{
+		Table& table = Flights();
+		std::lock_guard<std::mutex> lock(table.mutex);
+		if (this->landed_) {
+			return;
+		}
+		this->landed_ = true;
+		table.flights.erase(this->key_);
+		waiters.swap(this->waiters_);
+	}
+
+	// every waiter gets a response of its own to keep or modify
+	for (Waiter& waiter : waiters) {
+		std::promise<liboai::Response> outcome;
+		try {
+			if (response) {
+				outcome.set_value(*response);
+			}
+			else {
+				outcome.set_exception(error);
+			}
+		}
+		catch (...) {
+			outcome.set_exception(std::current_exception());
+		}
+
+		try {
+			waiter(outcome.get_future());
+		}
+		catch (...) {
+			// a waiter's failure is its own
+		}
+	}
+}
+
+std::shared_ptr<liboai::SingleFlight::Flight> liboai::SingleFlight::Join(const ResponseCache::Key& key, Waiter waiter) {
+	Table& table = Flights();
+	std::lock_guard<std::mutex> lock(table.mutex);
+
+	auto found = table.flights.find(key);
+	if (found != table.flights.end()) {
+		found->second->waiters_.push_back(std::move(waiter));
+		return nullptr;
+	}
+
+	std::shared_ptr<Flight> flight(new Flight(key));
+	table.flights.emplace(key, flight.get());
+	return flight;
+}
+
+std::optional<liboai::ResponseCache::Key> liboai::SingleFlight::KeyOf(std::string_view method, std::string_view url, std::string_view body, std::string_view context) {
+	// reads are always safe to share; of the writes, only those that
+	// create nothing and are answered the same way each time
+	static const std::vector<std::string> idempotent = { "/chat/completions", "/completions", "/moderations", "/embeddings" };
+	return ResponseCache::KeyOf(method, url, body, context, method == "GET" ? nullptr : &idempotent, true);
+}
+
+void liboai::SingleFlight::SetEnabled(bool enabled) noexcept {
+	coalescing.store(enabled, std::memory_order_relaxed);
+}
+
+bool liboai::SingleFlight::Enabled() noexcept {
+	return coalescing.load(std::memory_order_relaxed);
+}
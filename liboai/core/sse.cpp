@@ -0,0 +1,210 @@
+#include "../include/core/sse.h"
+
+void liboai::SseParser::Append(std::string_view chunk) {
+	this->Compact();
+	this->buffer_.append(chunk.data(), chunk.size());
+}
+
+bool liboai::SseParser::Next(SseEvent& event) {
+	while (true) {
+		// a CR closed the previous line at the very end of a chunk;
+		// if this chunk starts with the matching LF, swallow it
+		if (this->skip_lf_ && this->scan_ < this->buffer_.size()) {
+			if (this->buffer_[this->scan_] == '\n') {
+				if (this->event_begin_ == this->scan_) {
+					++this->event_begin_;
+				}
+				++this->scan_;
+			}
+			this->skip_lf_ = false;
+		}
+
+		size_t eol = this->buffer_.find_first_of("\r\n", this->scan_);
+		if (eol == std::string::npos) {
+			return false; // incomplete line
+		}
+
+		size_t next = eol + 1;
+		if (this->buffer_[eol] == '\r') {
+			if (next < this->buffer_.size()) {
+				next += (this->buffer_[next] == '\n') ? 1 : 0;
+			}
+			else {
+				this->skip_lf_ = true;
+			}
+		}
+
+		if (eol != this->scan_) {
+			this->ProcessLine(this->scan_, eol);
+			this->scan_ = next;
+			continue;
+		}
+
+		// blank line; dispatch the event if it carried any data
+		size_t begin = this->event_begin_;
+		this->scan_ = this->event_begin_ = next;
+
+		if (this->data_lines_ == 0) {
+			this->ClearPending();
+			continue;
+		}
+
+		event.event = this->event_.length > 0 ? this->View(this->event_) : std::string_view("message");
+		event.data = this->data_lines_ > 1 ? std::string_view(this->joined_) : this->View(this->data_);
+		event.id = this->id_;
+		event.raw = std::string_view(this->buffer_.data() + begin, next - begin);
+
+		this->ClearPending();
+		return true;
+	}
+}
+
+void liboai::SseParser::Reset() noexcept {
+	this->buffer_.clear();
+	this->scan_ = this->event_begin_ = 0;
+	this->skip_lf_ = false;
+	this->ClearPending();
+	this->joined_.clear();
+	this->id_.clear();
+	this->retry_ = std::nullopt;
+}
+
+void liboai::SseParser::ProcessLine(size_t begin, size_t end) {
+	std::string_view line(this->buffer_.data() + begin, end - begin);
+
+	// lines beginning with a colon are comments (e.g. keep-alives)
+	if (line.front() == ':') {
+		return;
+	}
+
+	std::string_view field = line;
+	size_t value_offset = end;
+
+	size_t colon = line.find(':');
+	if (colon != std::string_view::npos) {
+		field = line.substr(0, colon);
+		value_offset = begin + colon + 1;
+
+		// a single space after the colon is not part of the value
+		if (value_offset < end && this->buffer_[value_offset] == ' ') {
+			++value_offset;
+		}
+	}
+
+	Span value{ value_offset, end - value_offset };
+
+	if (field == "data") {
+		if (this->data_lines_ == 0) {
+			this->data_ = value;
+		}
+		else {
+			// only multi-line data needs a copy to be contiguous
+			if (this->data_lines_ == 1) {
+				this->joined_.assign(this->View(this->data_));
+			}
+			this->joined_.push_back('\n');
+			this->joined_.append(this->View(value));
+		}
+		++this->data_lines_;
+	}
+	else if (field == "event") {
+		this->event_ = value;
+	}
+	else if (field == "id") {
+		std::string_view id = this->View(value);
+		if (id.find('\0') == std::string_view::npos && id != this->id_) {
+			this->id_.assign(id);
+		}
+	}
+	else if (field == "retry") {
+		std::string_view retry = this->View(value);
+		if (!retry.empty() && retry.find_first_not_of("0123456789") == std::string_view::npos) {
+			uint64_t ms = 0;
+			for (char c : retry) {
+				ms = ms * 10 + static_cast<uint64_t>(c - '0');
+			}
+			this->retry_ = ms;
+		}
+	}
+	// unknown fields are ignored
+}
+
+void liboai::SseParser::Compact() {
+	// everything before the event being assembled has been consumed
+	size_t consumed = this->event_begin_;
+	if (consumed == 0) {
+		return;
+	}
+
+	if (consumed == this->buffer_.size()) {
+		this->buffer_.clear(); // common case: chunks ended on an event boundary
+	}
+	else {
+		this->buffer_.erase(0, consumed);
+	}
+
+	this->scan_ -= consumed;
+	this->event_begin_ = 0;
+	if (this->event_.length > 0) {
+		this->event_.offset -= consumed;
+	}
+	if (this->data_lines_ > 0) {
+		this->data_.offset -= consumed;
+	}
+}
+
+void liboai::SseParser::ClearPending() noexcept {
+	this->event_ = {};
+	this->data_ = {};
+	this->data_lines_ = 0;
+}
+
+liboai::netimpl::components::WriteCallback liboai::SseParser::Framed(std::function<bool(std::string, intptr_t)> callback) {
+	struct Stream {
+		SseParser parser;
+		std::optional<bool> framed; // decided by the first byte of the body
+	};
+	auto stream = std::make_shared<Stream>();
+
+	netimpl::components::WriteCallback write([stream, callback](std::string data, intptr_t userdata) -> bool {
+		if (!stream->framed) {
+			size_t first = data.find_first_not_of(" \t\r\n");
+			if (first == std::string::npos) {
+				return true; // leading whitespace means nothing either way
+			}
+
+			// no event stream line starts with a brace or bracket; the
+			// body is JSON, e.g. an error, and is passed on as it is
+			stream->framed = data[first] != '{' && data[first] != '[';
+		}
+		if (!stream->framed.value()) {
+			return callback(std::move(data), userdata);
+		}
+
+		SseParser& parser = stream->parser;
+		parser.Append(data);
+
+		// events extracted in one pass are contiguous in the buffer
+		const char* first = nullptr, *last = nullptr;
+		SseEvent event;
+		while (parser.Next(event)) {
+			if (!first) {
+				first = event.raw.data();
+			}
+			last = event.raw.data() + event.raw.size();
+		}
+
+		return first ? callback(std::string(first, last), userdata) : true;
+	});
+
+	// the stream may end without terminating its last event
+	write.finish = [stream, callback](intptr_t userdata) {
+		std::string_view pending = stream->parser.Pending();
+		if (!pending.empty()) {
+			static_cast<void>(callback(std::string(pending), userdata));
+			stream->parser.Reset();
+		}
+	};
+
+	return write;
+}
@@ -194,6 +194,39 @@ namespace liboai {
 			) const& noexcept(false);
 
 		private:
+			// each request is built once here and sent by both the
+			// method and its _async twin; see Network::Send
+			template <class _Mode>
+			typename _Mode::Result Transcribe(
+				_Mode mode,
+				const std::filesystem::path& file,
+				const std::string& model,
+				std::optional<std::string> prompt,
+				std::optional<std::string> response_format,
+				std::optional<float> temperature,
+				std::optional<std::string> language
+			) const;
+
+			template <class _Mode>
+			typename _Mode::Result Translate(
+				_Mode mode,
+				const std::filesystem::path& file,
+				const std::string& model,
+				std::optional<std::string> prompt,
+				std::optional<std::string> response_format,
+				std::optional<float> temperature
+			) const;
+
+			template <class _Mode>
+			typename _Mode::Result Speech(
+				_Mode mode,
+				const std::string& model,
+				const std::string& voice,
+				const std::string& input,
+				std::optional<std::string> response_format,
+				std::optional<float> speed
+			) const;
+
 			Authorization& auth_ = Authorization::Authorizer();
 	};
 }
@@ -298,6 +298,86 @@ namespace liboai {
 			) const & noexcept(false);
 
 		private:
+			// each request is built once here and sent by both the
+			// method and its _async twin; see Network::Send
+			template <class _Mode>
+			typename _Mode::Result CreateCompletion(
+				_Mode mode,
+				const std::string& resource_name,
+				const std::string& deployment_id,
+				const std::string& api_version,
+				std::optional<std::string> prompt,
+				std::optional<std::string> suffix,
+				std::optional<uint16_t> max_tokens,
+				std::optional<float> temperature,
+				std::optional<float> top_p,
+				std::optional<uint16_t> n,
+				std::optional<std::function<bool(std::string, intptr_t)>> stream,
+				std::optional<uint8_t> logprobs,
+				std::optional<bool> echo,
+				std::optional<std::vector<std::string>> stop,
+				std::optional<float> presence_penalty,
+				std::optional<float> frequency_penalty,
+				std::optional<uint16_t> best_of,
+				std::optional<std::unordered_map<std::string, int8_t>> logit_bias,
+				std::optional<std::string> user
+			) const;
+
+			template <class _Mode>
+			typename _Mode::Result CreateEmbedding(
+				_Mode mode,
+				const std::string& resource_name,
+				const std::string& deployment_id,
+				const std::string& api_version,
+				const std::string& input,
+				std::optional<std::string> user
+			) const;
+
+			template <class _Mode>
+			typename _Mode::Result CreateChatCompletion(
+				_Mode mode,
+				const std::string& resource_name,
+				const std::string& deployment_id,
+				const std::string& api_version,
+				Conversation& conversation,
+				std::optional<std::string> function_call,
+				std::optional<float> temperature,
+				std::optional<uint16_t> n,
+				std::optional<ChatStreamCallback> stream,
+				std::optional<std::vector<std::string>> stop,
+				std::optional<uint16_t> max_tokens,
+				std::optional<float> presence_penalty,
+				std::optional<float> frequency_penalty,
+				std::optional<std::unordered_map<std::string, int8_t>> logit_bias,
+				std::optional<std::string> user
+			) const;
+
+			template <class _Mode>
+			typename _Mode::Result RequestImageGeneration(
+				_Mode mode,
+				const std::string& resource_name,
+				const std::string& api_version,
+				const std::string& prompt,
+				std::optional<uint8_t> n,
+				std::optional<std::string> size
+			) const;
+
+			template <class _Mode>
+			typename _Mode::Result GetGeneratedImage(
+				_Mode mode,
+				const std::string& resource_name,
+				const std::string& api_version,
+				const std::string& operation_id
+			) const;
+
+			template <class _Mode>
+			typename _Mode::Result DeleteGeneratedImage(
+				_Mode mode,
+				const std::string& resource_name,
+				const std::string& api_version,
+				const std::string& operation_id
+			) const;
+
 			Authorization& auth_ = Authorization::Authorizer();
 			using StrippedStreamCallback = std::function<bool(std::string, intptr_t)>;
 	};
@@ -13,8 +13,12 @@
 
 #include "../core/authorization.h"
 #include "../core/response.h"
+#include "../core/sse.h"
+#include "../core/result.h"
 
 #include <limits>
+#include <memory>
+#include <cstdint>
 
 namespace liboai {
 	/*
@@ -819,23 +823,125 @@ namespace liboai {
 
 		private:
 			friend class ChatCompletion; friend class Azure;
-			[[nodiscard]] std::vector<std::string> SplitStreamedData(std::string data) const noexcept(false);
-			void RemoveStrings(std::string& s, std::string_view p) const noexcept(false);
-			void EraseExtra();
+
 			/*
-				@brief split full stream data that read from remote server.
-				@returns vector of string that contains the split data that will contains the last termination string(data: "DONE").
+				Messages are kept in a compact native form rather than
+				as JSON: roles are an enum, names are interned, and all
+				text lives in one contiguous arena that is compacted as
+				old messages are trimmed. Fields with no native slot
+				(e.g. tool_calls or non-text content) are kept verbatim
+				per message. The JSON form returned by GetJSON() is only
+				built on request.
 			*/
-			[[nodiscard]] std::vector<std::string> SplitFullStreamedData(std::string data) const noexcept(false);
+			enum class Role : uint8_t { System, User, Assistant, Function, Tool, Other };
+			enum class ContentKind : uint8_t { Text, Null, Absent };
+
+			struct Span {
+				size_t offset = 0, length = 0;
+			};
+
+			struct Message {
+				static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+				Span content, function_arguments, tool_call_id;
+				std::shared_ptr<const nlohmann::json> extra;
+				uint32_t role_name = npos;      // interned role, if role is Other
+				uint32_t name = npos;           // interned author name
+				uint32_t function_name = npos;  // interned function_call name
+				Role role = Role::User;
+				ContentKind content_kind = ContentKind::Text;
+				bool pending = false;           // streamed response in progress
+				bool has_function_call = false, has_function_arguments = false, has_tool_call_id = false;
+			};
+
+			struct FunctionCall {
+				std::optional<std::string> name, arguments;
+			};
+
+			void EraseExtra();
+			void ResetFunctionCall() noexcept;
+			bool UpdateFromJSON(const nlohmann::json& response);
 			bool ParseStreamData(std::string data, std::string& delta, bool& completed);
 
-			nlohmann::json _conversation;
+			static Role ParseRole(std::string_view role) noexcept;
+			std::string_view RoleName(const Message& message) const noexcept;
+			void SetRole(Message& message, const nlohmann::json& role);
+			uint32_t Intern(std::string_view name);
+			Span Store(std::string_view data);
+			void Release(const Span& span) noexcept;
+			std::string_view View(const Span& span) const noexcept { return { this->_arena.data() + span.offset, span.length }; }
+			void AppendContent(Message& message, std::string_view delta);
+			void PushMessage(Role role, std::string_view content);
+			void PushMessage(const nlohmann::json& message);
+			void EraseMessage(size_t index);
+			void CompactArena();
+			nlohmann::json MessageJSON(const Message& message, bool include_pending) const;
+
+			void SerializeMessage(std::string& out, const Message& message) const;
+			void InvalidateBodyCache(size_t index) noexcept;
+			void EraseFromBodyCache(size_t index);
+
+			/*
+				@brief Serializes the messages straight into a JSON
+					array suitable for a request body. The serialized
+					form of settled messages is cached, so each call
+					only serializes what was added since the last.
+			*/
+			std::string SerializeMessages() const;
+
+			std::vector<Message> _messages;
+			std::string _arena;
+			size_t _arena_garbage = 0;
+			std::vector<std::string> _names;
+			std::optional<FunctionCall> _function_call = std::nullopt;
 			std::optional<nlohmann::json> _functions = std::nullopt;
 			bool _last_resp_is_fc = false;
-			std::string _last_incomplete_buffer;
+			SseParser _stream_parser;
+			mutable std::string _body_cache;               // serialized settled messages, comma-separated
+			mutable std::vector<size_t> _body_cache_ends;  // end of each cached message in _body_cache
+			mutable nlohmann::json _json;
+			mutable bool _json_stale = true;
 			size_t _max_history_size = std::numeric_limits<size_t>::max();
 	};
 
+	/*
+		@brief Typed form of a chat completion response, read
+			from the body with Response::As<ChatCompletionResult>().
+	*/
+	struct ChatCompletionResult {
+		struct FunctionCall {
+			std::string name, arguments;
+		};
+
+		struct ToolCall {
+			std::string id, type;
+			FunctionCall function;
+		};
+
+		struct Message {
+			std::string role;
+			std::optional<std::string> content;        // null for function/tool calls
+			std::optional<FunctionCall> function_call;
+			std::vector<ToolCall> tool_calls;
+		};
+
+		struct Choice {
+			uint32_t index = 0;
+			Message message;
+			std::string finish_reason;
+		};
+
+		std::string id, object, model, system_fingerprint;
+		int64_t created = 0;
+		std::vector<Choice> choices;
+		Usage usage;
+
+		/*
+			@brief Reads a chat completion from its JSON text.
+		*/
+		LIBOAI_EXPORT static ChatCompletionResult Parse(std::string_view json) noexcept(false);
+	};
+
 	class ChatCompletion final : private Network {
 		public:
 			ChatCompletion(const std::string &root): Network(root) {}
@@ -968,6 +1074,26 @@ namespace liboai {
 			) const & noexcept(false);
 			
 		private:
+			// each request is built once here and sent by both the
+			// method and its _async twin; see Network::Send
+			template <class _Mode>
+			typename _Mode::Result Create(
+				_Mode mode,
+				const std::string& model,
+				Conversation& conversation,
+				std::optional<std::string> function_call,
+				std::optional<float> temperature,
+				std::optional<float> top_p,
+				std::optional<uint16_t> n,
+				std::optional<ChatStreamCallback> stream,
+				std::optional<std::vector<std::string>> stop,
+				std::optional<uint16_t> max_tokens,
+				std::optional<float> presence_penalty,
+				std::optional<float> frequency_penalty,
+				std::optional<std::unordered_map<std::string, int8_t>> logit_bias,
+				std::optional<std::string> user
+			) const;
+
 			Authorization& auth_ = Authorization::Authorizer();
 			using StrippedStreamCallback = std::function<bool(std::string, intptr_t)>;
 	};
@@ -13,6 +13,7 @@
 
 #include "../core/authorization.h"
 #include "../core/response.h"
+#include "../core/sse.h"
 
 namespace liboai {
 	class Completions final : private Network {
@@ -166,6 +167,29 @@ namespace liboai {
 			) const & noexcept(false);
 
 		private:
+			// each request is built once here and sent by both the
+			// method and its _async twin; see Network::Send
+			template <class _Mode>
+			typename _Mode::Result Create(
+				_Mode mode,
+				const std::string& model_id,
+				std::optional<std::string> prompt,
+				std::optional<std::string> suffix,
+				std::optional<uint16_t> max_tokens,
+				std::optional<float> temperature,
+				std::optional<float> top_p,
+				std::optional<uint16_t> n,
+				std::optional<std::function<bool(std::string, intptr_t)>> stream,
+				std::optional<uint8_t> logprobs,
+				std::optional<bool> echo,
+				std::optional<std::vector<std::string>> stop,
+				std::optional<float> presence_penalty,
+				std::optional<float> frequency_penalty,
+				std::optional<uint16_t> best_of,
+				std::optional<std::unordered_map<std::string, int8_t>> logit_bias,
+				std::optional<std::string> user
+			) const;
+
 			Authorization& auth_ = Authorization::Authorizer();
 	};
 }
\ No newline at end of file
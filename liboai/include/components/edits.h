@@ -85,6 +85,19 @@ namespace liboai {
 			) const & noexcept(false);
 
 		private:
+			// each request is built once here and sent by both the
+			// method and its _async twin; see Network::Send
+			template <class _Mode>
+			typename _Mode::Result Create(
+				_Mode mode,
+				const std::string& model_id,
+				std::optional<std::string> input,
+				std::optional<std::string> instruction,
+				std::optional<uint16_t> n,
+				std::optional<float> temperature,
+				std::optional<float> top_p
+			) const;
+
 			Authorization& auth_ = Authorization::Authorizer();
 	};
 }
\ No newline at end of file
@@ -0,0 +1,110 @@
+#pragma once
+
+/*
+	embedding_cache.h : Embedding cache implementation.
+		This header file provides declarations for the on-disk cache
+		of embedding vectors that liboai::Embeddings consults, when
+		given one, before asking the API for an embedding.
+
+		Vectors are content-addressed by a 128-bit hash of the model,
+		the requested dimensions and the input text, and stored in an
+		append-only file that is memory-mapped for reading. A compact
+		in-memory hash index over that file is rebuilt when the cache
+		is opened, so a hit costs a table probe and a copy - no HTTP
+		request and no JSON.
+
+		The file format is native-endian and is meant to be reused
+		across runs on the same machine, by one process at a time.
+*/
+
+#include <filesystem>
+#include <shared_mutex>
+#include <atomic>
+#include "embeddings.h"
+
+namespace liboai {
+	class EmbeddingCache final {
+		public:
+			/*
+				@brief Opens the cache stored at path, creating it if it
+					does not exist. Records left incomplete by a crash
+					are discarded.
+
+				@throws liboai::exception::OpenAIException with
+					E_FILEERROR if the file cannot be opened or mapped,
+					is not a cache file, or is in use by another
+					process.
+			*/
+			LIBOAI_EXPORT explicit EmbeddingCache(const std::filesystem::path& path) noexcept(false);
+			LIBOAI_EXPORT ~EmbeddingCache();
+			NON_COPYABLE(EmbeddingCache)
+			NON_MOVABLE(EmbeddingCache)
+
+			struct Stats {
+				uint64_t hits = 0, misses = 0;
+				uint64_t entries = 0;   // vectors in the cache
+				uint64_t bytes = 0;     // size of the records on disk
+			};
+
+			/*
+				@brief Looks up the embedding of input. Safe to call from
+					several threads at once, and concurrently with Store().
+
+				@param model        The model the embedding was created with.
+				@param dimensions   The dimensions requested, or 0 if none were.
+				@param input        The input text.
+				@param out          Receives the embedding on a hit.
+
+				@returns True on a hit.
+			*/
+			LIBOAI_EXPORT bool Lookup(std::string_view model, uint32_t dimensions, std::string_view input, std::vector<float>& out) const;
+
+			/*
+				@brief Adds the embedding of input to the cache, unless an
+					embedding is already stored for it.
+
+				@throws liboai::exception::OpenAIException with
+					E_FILEERROR if the file cannot be grown.
+			*/
+			LIBOAI_EXPORT void Store(std::string_view model, uint32_t dimensions, std::string_view input, Span<const float> embedding) noexcept(false);
+
+			/*
+				@brief Flushes stored records to disk.
+			*/
+			LIBOAI_EXPORT void Flush() noexcept(false);
+
+			LIBOAI_EXPORT Stats GetStats() const noexcept;
+
+		private:
+			struct Key {
+				uint64_t hash[2];
+				bool operator==(const Key& other) const noexcept { return this->hash[0] == other.hash[0] && this->hash[1] == other.hash[1]; }
+			};
+
+			// an open-addressed index slot; offset 0 marks an empty slot,
+			// as no record starts at the beginning of the file
+			struct Slot {
+				Key key;
+				uint64_t offset;
+			};
+
+			struct File;
+
+			static Key KeyOf(std::string_view model, uint32_t dimensions, std::string_view input);
+
+			uint64_t Find(const Key& key) const noexcept;
+			void Insert(const Key& key, uint64_t offset);
+			void Recover();
+			void Reserve(uint64_t size);
+
+			std::unique_ptr<File> file_;
+			uint8_t* map_ = nullptr;
+			uint64_t end_ = 0, capacity_ = 0; // end of the records, size of the mapping
+
+			std::vector<Slot> index_;
+			uint64_t entries_ = 0;
+
+			mutable std::shared_mutex mutex_;
+			mutable std::atomic<uint64_t> hits_ = 0, misses_ = 0;
+	};
+}
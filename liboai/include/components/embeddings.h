@@ -13,8 +13,178 @@
 
 #include "../core/authorization.h"
 #include "../core/response.h"
+#include "../core/result.h"
+#include "../core/base64.h"
+
+#include <limits>
+#include <memory>
+#include <new>
+#include <exception>
 
 namespace liboai {
+	class EmbeddingCache;
+
+	/*
+		@brief Typed form of an embeddings response, read from the
+			body with Response::As<EmbeddingResult>(). Vectors are
+			stored as floats, which is the precision the API uses.
+	*/
+	struct EmbeddingResult {
+		struct Embedding {
+			uint32_t index = 0;
+			std::vector<float> embedding;
+		};
+
+		std::string object, model;
+		std::vector<Embedding> data;
+		Usage usage;
+
+		/*
+			@brief Reads an embeddings response from its JSON text.
+		*/
+		LIBOAI_EXPORT static EmbeddingResult Parse(std::string_view json) noexcept(false);
+	};
+
+	/*
+		@brief A non-owning view of contiguous elements, such as a
+			row of an EmbeddingMatrix.
+	*/
+	template <class _Ty>
+	class Span final {
+		public:
+			constexpr Span() noexcept = default;
+			constexpr Span(_Ty* data, size_t size) noexcept : data_(data), size_(size) {}
+
+			constexpr _Ty* data() const noexcept { return this->data_; }
+			constexpr size_t size() const noexcept { return this->size_; }
+			constexpr bool empty() const noexcept { return this->size_ == 0; }
+			constexpr _Ty* begin() const noexcept { return this->data_; }
+			constexpr _Ty* end() const noexcept { return this->data_ + this->size_; }
+			constexpr _Ty& operator[](size_t i) const noexcept { return this->data_[i]; }
+
+		private:
+			_Ty* data_ = nullptr;
+			size_t size_ = 0;
+	};
+
+	/*
+		@brief Embedding vectors stored as one row-major float
+			matrix, read from an embeddings response with
+			Response::As<EmbeddingMatrix>(). Rows are ordered by
+			their index in the response.
+
+			Storage and every row start on a 64-byte boundary: rows
+			are Stride() floats apart, with the floats past
+			Dimensions() zeroed, so rows can be handed to SIMD code
+			as they are.
+	*/
+	class EmbeddingMatrix final {
+		public:
+			static constexpr size_t alignment = 64;
+
+			EmbeddingMatrix() = default;
+			LIBOAI_EXPORT EmbeddingMatrix(size_t rows, size_t dimensions);
+			LIBOAI_EXPORT EmbeddingMatrix(const EmbeddingMatrix& other);
+			EmbeddingMatrix(EmbeddingMatrix&& old) noexcept = default;
+			LIBOAI_EXPORT EmbeddingMatrix& operator=(const EmbeddingMatrix& other);
+			EmbeddingMatrix& operator=(EmbeddingMatrix&& old) noexcept = default;
+
+			size_t Rows() const noexcept { return this->rows_; }
+			size_t Dimensions() const noexcept { return this->dimensions_; }
+			size_t Stride() const noexcept { return this->stride_; }
+			bool Empty() const noexcept { return this->rows_ == 0; }
+
+			float* Data() noexcept { return this->data_.get(); }
+			const float* Data() const noexcept { return this->data_.get(); }
+
+			Span<float> Row(size_t row) noexcept { return { this->data_.get() + row * this->stride_, this->dimensions_ }; }
+			Span<const float> Row(size_t row) const noexcept { return { this->data_.get() + row * this->stride_, this->dimensions_ }; }
+			Span<const float> operator[](size_t row) const noexcept { return this->Row(row); }
+
+			/*
+				@brief Reads the vectors of an embeddings response from
+					its JSON text straight into the matrix.
+
+				@throws liboai::exception::OpenAIException with
+					E_FAILURETOPARSE if the document is malformed or
+					its vectors differ in dimension.
+			*/
+			LIBOAI_EXPORT static EmbeddingMatrix Parse(std::string_view json) noexcept(false);
+
+		private:
+			class Reader;
+
+			struct Free {
+				void operator()(float* data) const noexcept { ::operator delete(data, std::align_val_t(alignment)); }
+			};
+
+			static size_t StrideOf(size_t dimensions) noexcept {
+				constexpr size_t floats = alignment / sizeof(float);
+				return (dimensions + floats - 1) / floats * floats;
+			}
+
+			void Reserve(size_t rows);
+
+			std::unique_ptr<float[], Free> data_;
+			size_t rows_ = 0, dimensions_ = 0, stride_ = 0, capacity_ = 0; // capacity in rows
+	};
+
+	/*
+		@brief Controls how a batched embeddings request is split
+			into API-legal requests, and how many of those are in
+			flight at once.
+	*/
+	struct EmbeddingBatchOptions {
+		size_t max_inputs = 2048;                              // inputs per request
+		size_t max_tokens = 300000;                            // tokens per request, as counted by count_tokens
+		size_t max_bytes = std::numeric_limits<size_t>::max(); // input bytes per request
+		size_t concurrency = 8;                                // requests in flight at once
+
+		/*
+			Counts the tokens in an input. If unset, a conservative
+			estimate of one token per three bytes is used.
+		*/
+		std::function<size_t(std::string_view)> count_tokens;
+
+		std::optional<std::string> user;
+
+		/*
+			Whether to request base64-encoded vectors, which are about
+			a quarter of the size of decimal text. Disable for servers
+			that do not support encoding_format.
+		*/
+		bool base64 = true;
+
+		/*
+			The number of dimensions the vectors should have, for
+			models that support shortening them.
+		*/
+		std::optional<uint32_t> dimensions;
+
+		/*
+			A cache consulted before sending each input and filled
+			with each embedding returned; inputs found in it are not
+			sent at all. It must outlive the request.
+		*/
+		EmbeddingCache* cache = nullptr;
+	};
+
+	/*
+		@brief The result of a batched embeddings request, holding
+			one item per input in input order. A failed request
+			only fails the inputs it carried.
+	*/
+	struct EmbeddingBatchResult {
+		struct Item {
+			std::vector<float> embedding;
+			std::exception_ptr error; // set if this input could not be embedded
+		};
+
+		std::vector<Item> items;
+		Usage usage;       // summed over all successful requests
+		size_t failed = 0; // number of items with an error
+	};
+
 	class Embeddings final : private Network {
 		public:
 			Embeddings(const std::string &root): Network(root) {}
@@ -28,6 +198,9 @@ namespace liboai {
 				@param *model       The model to use for the edit.
 				@param input        The input text to edit.
 				@param user         A unique identifier representing your end-user
+				@param encoding_format  "float" (the default) or "base64"; base64
+				                        responses are about a quarter of the size
+				                        and are decoded by the typed results.
 
 				@return A liboai::Response object containing the image(s)
 					data in JSON format.
@@ -35,7 +208,8 @@ namespace liboai {
 			LIBOAI_EXPORT liboai::Response create(
 				const std::string& model_id,
 				std::optional<std::string> input = std::nullopt,
-				std::optional<std::string> user = std::nullopt
+				std::optional<std::string> user = std::nullopt,
+				std::optional<std::string> encoding_format = std::nullopt
 			) const & noexcept(false);
 
 			/*
@@ -44,6 +218,9 @@ namespace liboai {
 				@param *model       The model to use for the edit.
 				@param input        The input text to edit.
 				@param user         A unique identifier representing your end-user
+				@param encoding_format  "float" (the default) or "base64"; base64
+				                        responses are about a quarter of the size
+				                        and are decoded by the typed results.
 
 				@return A liboai::Response future containing the image(s)
 					data in JSON format.
@@ -51,10 +228,65 @@ namespace liboai {
 			LIBOAI_EXPORT liboai::FutureResponse create_async(
 				const std::string& model_id,
 				std::optional<std::string> input = std::nullopt,
-				std::optional<std::string> user = std::nullopt
+				std::optional<std::string> user = std::nullopt,
+				std::optional<std::string> encoding_format = std::nullopt
+			) const & noexcept(false);
+
+			/*
+				@brief Creates embedding vectors for many inputs at once.
+					The inputs are split into batches that respect the
+					limits in options, which are sent concurrently; the
+					call returns once every batch has completed.
+
+				@param *model       The model to use.
+				@param *inputs      The input texts to embed.
+				@param options      Batching limits and end-user identifier.
+
+				@return One embedding or error per input, in input order.
+			*/
+			LIBOAI_EXPORT liboai::EmbeddingBatchResult create(
+				const std::string& model_id,
+				const std::vector<std::string>& inputs,
+				const EmbeddingBatchOptions& options = {}
+			) const & noexcept(false);
+
+			/*
+				@brief Asynchronously creates embedding vectors for many
+					inputs at once; see create() above.
+
+				@param *model       The model to use.
+				@param *inputs      The input texts to embed.
+				@param options      Batching limits and end-user identifier.
+
+				@return A future holding one embedding or error per input,
+					in input order.
+			*/
+			LIBOAI_EXPORT std::future<liboai::EmbeddingBatchResult> create_async(
+				const std::string& model_id,
+				std::vector<std::string> inputs,
+				const EmbeddingBatchOptions& options = {}
 			) const & noexcept(false);
 
 		private:
+			// each request is built once here and sent by both the
+			// method and its _async twin; see Network::Send
+			template <class _Mode>
+			typename _Mode::Result Create(
+				_Mode mode,
+				const std::string& model_id,
+				std::optional<std::string> input,
+				std::optional<std::string> user,
+				std::optional<std::string> encoding_format
+			) const;
+
+			struct BatchJob;
+
+			std::future<liboai::EmbeddingBatchResult> StartBatches(std::shared_ptr<BatchJob> job, const std::string& model_id, const EmbeddingBatchOptions& options) const;
+			static void DispatchBatches(const std::shared_ptr<BatchJob>& job);
+			static void CompleteBatch(const std::shared_ptr<BatchJob>& job, size_t batch, FutureResponse response);
+			static void FailBatch(BatchJob& job, size_t batch, std::exception_ptr error);
+			static bool FinishBatch(BatchJob& job);
+
 			Authorization& auth_ = Authorization::Authorizer();
 	};
 }
\ No newline at end of file
@@ -152,6 +152,32 @@ namespace liboai {
 			) const & noexcept(false);
 			
 		private:
+			// each request is built once here and sent by both the
+			// method and its _async twin; see Network::Send
+			template <class _Mode>
+			typename _Mode::Result List(
+				_Mode mode
+			) const;
+
+			template <class _Mode>
+			typename _Mode::Result Create(
+				_Mode mode,
+				const std::filesystem::path& file,
+				const std::string& purpose
+			) const;
+
+			template <class _Mode>
+			typename _Mode::Result Remove(
+				_Mode mode,
+				const std::string& file_id
+			) const;
+
+			template <class _Mode>
+			typename _Mode::Result Retrieve(
+				_Mode mode,
+				const std::string& file_id
+			) const;
+
 			Authorization& auth_ = Authorization::Authorizer();
 	};
 }
\ No newline at end of file
@@ -13,6 +13,7 @@
 
 #include "../core/authorization.h"
 #include "../core/response.h"
+#include "../core/sse.h"
 
 namespace liboai {
 	class FineTunes final : private Network {
@@ -227,6 +228,55 @@ namespace liboai {
 			) const & noexcept(false);
 
 		private:
+			// each request is built once here and sent by both the
+			// method and its _async twin; see Network::Send
+			template <class _Mode>
+			typename _Mode::Result Create(
+				_Mode mode,
+				const std::string& training_file,
+				std::optional<std::string> validation_file,
+				std::optional<std::string> model_id,
+				std::optional<uint8_t> n_epochs,
+				std::optional<uint16_t> batch_size,
+				std::optional<float> learning_rate_multiplier,
+				std::optional<float> prompt_loss_weight,
+				std::optional<bool> compute_classification_metrics,
+				std::optional<uint16_t> classification_n_classes,
+				std::optional<std::string> classification_positive_class,
+				std::optional<std::vector<float>> classification_betas,
+				std::optional<std::string> suffix
+			) const;
+
+			template <class _Mode>
+			typename _Mode::Result List(
+				_Mode mode
+			) const;
+
+			template <class _Mode>
+			typename _Mode::Result Retrieve(
+				_Mode mode,
+				const std::string& fine_tune_id
+			) const;
+
+			template <class _Mode>
+			typename _Mode::Result Cancel(
+				_Mode mode,
+				const std::string& fine_tune_id
+			) const;
+
+			template <class _Mode>
+			typename _Mode::Result ListEvents(
+				_Mode mode,
+				const std::string& fine_tune_id,
+				std::optional<std::function<bool(std::string, intptr_t)>> stream
+			) const;
+
+			template <class _Mode>
+			typename _Mode::Result Remove(
+				_Mode mode,
+				const std::string& model
+			) const;
+
 			Authorization& auth_ = Authorization::Authorizer();
 	};
 }	
\ No newline at end of file
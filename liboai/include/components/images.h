@@ -159,6 +159,40 @@ namespace liboai {
 			) const & noexcept(false);
 
 		private:
+			// each request is built once here and sent by both the
+			// method and its _async twin; see Network::Send
+			template <class _Mode>
+			typename _Mode::Result Create(
+				_Mode mode,
+				const std::string& prompt,
+				std::optional<uint8_t> n,
+				std::optional<std::string> size,
+				std::optional<std::string> response_format,
+				std::optional<std::string> user
+			) const;
+
+			template <class _Mode>
+			typename _Mode::Result CreateEdit(
+				_Mode mode,
+				const std::filesystem::path& image,
+				const std::string& prompt,
+				std::optional<std::filesystem::path> mask,
+				std::optional<uint8_t> n,
+				std::optional<std::string> size,
+				std::optional<std::string> response_format,
+				std::optional<std::string> user
+			) const;
+
+			template <class _Mode>
+			typename _Mode::Result CreateVariation(
+				_Mode mode,
+				const std::filesystem::path& image,
+				std::optional<uint8_t> n,
+				std::optional<std::string> size,
+				std::optional<std::string> response_format,
+				std::optional<std::string> user
+			) const;
+
 			Authorization& auth_ = Authorization::Authorizer();
 	};
 }
\ No newline at end of file
@@ -13,8 +13,31 @@
 
 #include "../core/authorization.h"
 #include "../core/response.h"
+#include "../core/result.h"
+
+#include <unordered_map>
 
 namespace liboai {
+	/*
+		@brief Typed form of a moderation response, read from the
+			body with Response::As<ModerationResult>().
+	*/
+	struct ModerationResult {
+		struct Result {
+			bool flagged = false;
+			std::unordered_map<std::string, bool> categories;
+			std::unordered_map<std::string, double> category_scores;
+		};
+
+		std::string id, model;
+		std::vector<Result> results;
+
+		/*
+			@brief Reads a moderation response from its JSON text.
+		*/
+		LIBOAI_EXPORT static ModerationResult Parse(std::string_view json) noexcept(false);
+	};
+
 	class Moderations final : private Network {
 		public:
 			Moderations(const std::string &root): Network(root) {}
@@ -53,6 +76,15 @@ namespace liboai {
 			) const & noexcept(false);
 
 		private:
+			// each request is built once here and sent by both the
+			// method and its _async twin; see Network::Send
+			template <class _Mode>
+			typename _Mode::Result Create(
+				_Mode mode,
+				const std::string& input,
+				std::optional<std::string> model
+			) const;
+
 			Authorization& auth_ = Authorization::Authorizer();
 	};
 }
\ No newline at end of file
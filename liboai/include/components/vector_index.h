@@ -0,0 +1,138 @@
+#pragma once
+
+/*
+	vector_index.h : Vector index implementation.
+		This header file provides declarations for an in-memory index
+		of embedding vectors that answers exact top-k similarity
+		queries, for local retrieval over the embeddings returned by
+		liboai::Embeddings without a separate vector database.
+
+		Vectors are stored as float32, or quantized to float16 or int8
+		to halve or quarter the memory each query scans. Scans use
+		AVX-512 or AVX2 on x86-64 processors that support them and
+		NEON on 64-bit ARM, and large indexes are split across several
+		threads.
+
+		An index can be saved to a file and loaded back by mapping that
+		file into memory, so it is paged in as it is searched rather
+		than read up front.
+*/
+
+#include <filesystem>
+#include "embeddings.h"
+
+namespace liboai {
+	class VectorIndex final {
+		public:
+			enum class Metric : uint32_t {
+				DOT,
+				COSINE   // vectors and queries are normalized, then compared by dot product
+			};
+
+			enum class Storage : uint32_t {
+				F32,
+				F16,
+				I8       // one scale per vector, symmetric around zero
+			};
+
+			struct Match {
+				uint64_t id;  // the order in which the vector was added, from 0
+				float score;
+			};
+
+			LIBOAI_EXPORT explicit VectorIndex(uint32_t dimensions, Metric metric = Metric::COSINE, Storage storage = Storage::F32) noexcept(false);
+			LIBOAI_EXPORT VectorIndex(VectorIndex&& old) noexcept;
+			LIBOAI_EXPORT VectorIndex& operator=(VectorIndex&& old) noexcept;
+			LIBOAI_EXPORT ~VectorIndex();
+			NON_COPYABLE(VectorIndex)
+
+			/*
+				@brief Adds a vector to the index.
+
+				@returns The id of the vector.
+
+				@throws liboai::exception::OpenAIException with
+					E_BADREQUEST if the vector is not of the index's
+					dimension.
+			*/
+			LIBOAI_EXPORT uint64_t Add(Span<const float> vector) noexcept(false);
+
+			/*
+				@brief Adds every vector of an embeddings result, in
+					order.
+
+				@returns The id of the first vector added.
+			*/
+			LIBOAI_EXPORT uint64_t Add(const EmbeddingMatrix& matrix) noexcept(false);
+			LIBOAI_EXPORT uint64_t Add(const EmbeddingResult& result) noexcept(false);
+
+			/*
+				@brief Finds the k vectors most similar to query, best
+					first; ties go to the lower id. Several searches may
+					run at once, but not alongside Add().
+
+				@param *query     A vector of the index's dimension.
+				@param *k         The number of matches to return at most.
+				@param threads    The number of threads to scan with, or 0
+				                  to choose by the size of the index.
+
+				@throws liboai::exception::OpenAIException with
+					E_BADREQUEST if the query is not of the index's
+					dimension.
+			*/
+			LIBOAI_EXPORT std::vector<Match> Search(Span<const float> query, size_t k, size_t threads = 0) const noexcept(false);
+
+			/*
+				@brief Makes room for a number of vectors in total.
+			*/
+			LIBOAI_EXPORT void Reserve(size_t vectors) noexcept(false);
+
+			size_t Size() const noexcept { return this->rows_; }
+			uint32_t Dimensions() const noexcept { return this->dimensions_; }
+			Metric GetMetric() const noexcept { return this->metric_; }
+			Storage GetStorage() const noexcept { return this->storage_; }
+
+			/*
+				@brief Writes the index to a file.
+
+				@throws liboai::exception::OpenAIException with
+					E_FILEERROR if the file cannot be written.
+			*/
+			LIBOAI_EXPORT void Save(const std::filesystem::path& path) const noexcept(false);
+
+			/*
+				@brief Loads an index written by Save() by mapping the
+					file into memory. The file must not be modified while
+					the index is loaded; vectors added afterwards copy the
+					index into memory first.
+
+				@throws liboai::exception::OpenAIException with
+					E_FILEERROR if the file cannot be mapped or is not an
+					index file.
+			*/
+			LIBOAI_EXPORT static VectorIndex Load(const std::filesystem::path& path) noexcept(false);
+
+		private:
+			static constexpr size_t alignment = 64;
+
+			struct Free {
+				void operator()(uint8_t* data) const noexcept { ::operator delete(data, std::align_val_t(alignment)); }
+			};
+
+			struct Mapping;
+
+			void Encode(const float* vector, uint8_t* row, float& scale) const noexcept;
+			void Scan(const float* query, size_t begin, size_t end, size_t k, std::vector<Match>& out) const noexcept;
+
+			uint32_t dimensions_;
+			Metric metric_;
+			Storage storage_;
+			size_t padded_, stride_;          // elements and bytes per row; rows are zero-padded
+			size_t rows_ = 0, capacity_ = 0; // capacity is 0 while the rows are mapped
+
+			std::unique_ptr<uint8_t[], Free> owned_;
+			const uint8_t* data_ = nullptr;  // owned_, or the rows of a loaded file
+			std::vector<float> scales_;      // for I8 storage
+			std::unique_ptr<Mapping> mapping_;
+	};
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+/*
+	active.h : liboai active instance implementation.
+		This header file provides the process-wide slot behind each
+		opt-in policy that liboai::Network applies once one has been
+		set, such as the rate limiter or the retry policy.
+*/
+
+#include <memory>
+#include <mutex>
+
+namespace liboai {
+	/*
+		@brief The _Type instance in effect for the whole process, if
+			any; safe to set and read from any thread.
+	*/
+	template <class _Type>
+	class ActiveInstance final {
+		public:
+			static void Set(std::shared_ptr<_Type> instance) noexcept {
+				std::lock_guard<std::mutex> lock(Mutex());
+				Instance() = std::move(instance);
+			}
+
+			static std::shared_ptr<_Type> Get() noexcept {
+				std::lock_guard<std::mutex> lock(Mutex());
+				return Instance();
+			}
+
+		private:
+			static std::shared_ptr<_Type>& Instance() noexcept {
+				static std::shared_ptr<_Type> instance;
+				return instance;
+			}
+
+			static std::mutex& Mutex() noexcept {
+				static std::mutex mutex;
+				return mutex;
+			}
+	};
+}
@@ -194,6 +194,8 @@ namespace liboai {
 
 			/*
 				@brief Sets the timeout for component calls in milliseconds.
+					Calls made in a liboai::DeadlineScope are also held to
+					its deadlines.
 			*/
 			LIBOAI_EXPORT void SetMaxTimeout(int32_t ms) noexcept { this->timeout_ = netimpl::components::Timeout(ms); }
 
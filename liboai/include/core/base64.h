@@ -0,0 +1,77 @@
+#pragma once
+
+/*
+	base64.h : liboai base64 decoding implementation.
+		This header file provides declarations for the base64
+		decoder used to read embeddings requested with
+		encoding_format "base64", whose vectors arrive as base64
+		strings of little-endian float32 values.
+
+		Decoding uses AVX2 on x86-64 processors that support it
+		and NEON on 64-bit ARM, falling back to a table-driven
+		scalar decoder elsewhere and for the tail of the input.
+*/
+
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+#include "response.h"
+
+namespace liboai {
+	class Base64 final {
+		public:
+			static constexpr size_t npos = static_cast<size_t>(-1);
+
+			/*
+				@brief The number of bytes a base64 string decodes to,
+					with or without padding, or npos if its length is
+					not a valid base64 length.
+			*/
+			LIBOAI_EXPORT static size_t DecodedSize(std::string_view in) noexcept;
+
+			/*
+				@brief Decodes a base64 string.
+
+				@param in    The base64 text.
+				@param out   Storage for DecodedSize(in) bytes.
+
+				@returns False if in is not valid base64, in which case
+					the contents of out are unspecified.
+			*/
+			LIBOAI_EXPORT static bool Decode(std::string_view in, uint8_t* out) noexcept;
+
+			/*
+				@brief Decodes a base64 string of little-endian float32
+					values, such as a base64-encoded embedding.
+
+				@param in      The base64 text.
+				@param out     Storage for count floats.
+				@param count   The number of floats in encodes, which
+				               must be DecodedSize(in) / 4.
+
+				@returns False if in is not valid base64 or does not
+					hold exactly count floats.
+			*/
+			LIBOAI_EXPORT static bool DecodeFloats(std::string_view in, float* out, size_t count) noexcept;
+
+			/*
+				@brief The number of floats a base64 string of float32
+					values holds, or npos if it cannot hold a whole
+					number of them.
+			*/
+			static size_t FloatCount(std::string_view in) noexcept {
+				size_t bytes = DecodedSize(in);
+				return (bytes == npos || bytes % sizeof(float) != 0) ? npos : bytes / sizeof(float);
+			}
+
+			/*
+				@brief Enables or disables the AVX2 and NEON decoders
+					process-wide. When disabled, everything is decoded
+					by the scalar decoder, which gives the same results;
+					this is meant for comparing and checking the two.
+					Enabled by default.
+			*/
+			LIBOAI_EXPORT static void SetSimd(bool enabled) noexcept;
+			LIBOAI_EXPORT static bool Simd() noexcept;
+	};
+}
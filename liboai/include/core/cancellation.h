@@ -0,0 +1,103 @@
+#pragma once
+
+/*
+	cancellation.h : liboai cancellation token implementation.
+		This header file provides declarations for tokens with which
+		requests that are already in flight, streams included, can be
+		aborted from any thread.
+
+		Requests are made under a token by making them while a
+		liboai::CancellationScope for it is alive on the calling
+		thread; any component call can be made that way, synchronous
+		or asynchronous. Cancelling the token aborts every transfer
+		made under it within milliseconds, whether or not any data is
+		flowing, and fails their requests with E_CONNECTIONERROR.
+		Their sessions go back to the pool as usual.
+
+		Requests made under a token are carried by the multi engine,
+		which wakes as soon as a token is cancelled; synchronous ones
+		block their caller as before.
+*/
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include "response.h"
+
+namespace liboai {
+	class CancellationToken final {
+		public:
+			/*
+				@brief Creates a token that has not been cancelled.
+					Copies of a token share its state, so that any copy
+					may cancel it.
+			*/
+			CancellationToken() : state_(std::make_shared<State>()) {}
+
+			/*
+				@brief Aborts every request in flight under the token,
+					and any made under it from then on; safe to call from
+					any thread, more than once.
+			*/
+			LIBOAI_EXPORT void Cancel() noexcept;
+
+			bool Cancelled() const noexcept { return this->state_->cancelled.load(std::memory_order_acquire); }
+
+			/*
+				@brief Blocks until the token is cancelled or 'until'
+					passes, or, if 'done' is given, until it returns
+					true; 'done' is checked again whenever Notify() is
+					called.
+
+				@returns False if the token has been cancelled.
+			*/
+			LIBOAI_EXPORT bool Wait(
+				std::optional<std::chrono::steady_clock::time_point> until,
+				const std::function<bool()>& done = {}
+			) const;
+
+			/*
+				@brief Wakes the threads blocked in Wait() so that they
+					check 'done' again.
+			*/
+			LIBOAI_EXPORT void Notify() const noexcept;
+
+			/*
+				@brief The token of the innermost CancellationScope alive
+					on the calling thread, if any.
+			*/
+			LIBOAI_EXPORT static std::optional<CancellationToken> Current() noexcept;
+
+		private:
+			struct State {
+				std::atomic<bool> cancelled = false;
+				std::mutex mutex;
+				std::condition_variable changed;
+			};
+
+			std::shared_ptr<State> state_;
+	};
+
+	/*
+		@brief Makes requests made on the constructing thread, while
+			the scope is alive, under 'token'. Scopes nest; the
+			innermost one applies.
+	*/
+	class CancellationScope final {
+		public:
+			LIBOAI_EXPORT explicit CancellationScope(CancellationToken token) noexcept;
+			LIBOAI_EXPORT ~CancellationScope();
+			NON_COPYABLE(CancellationScope)
+			NON_MOVABLE(CancellationScope)
+
+		private:
+			CancellationToken token_;
+			const CancellationScope* outer_;
+
+			friend class CancellationToken;
+	};
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+/*
+	circuit_breaker.h : liboai circuit breaker implementation.
+		This header file provides declarations for the opt-in circuit
+		breaker that liboai::Network consults before each attempt at a
+		request, once one has been set with
+		liboai::Network::SetCircuitBreaker().
+
+		Each host and endpoint path has a circuit of its own. Attempts
+		that fail without a response, such as on a timeout or a refused
+		connection, or with a 5xx response, are counted, and a success
+		resets the count. Once enough fail in a row the circuit opens,
+		and attempts on it fail at once with
+		liboai::exception::OpenAICircuitOpen rather than waiting on an
+		upstream that is down. After a while the circuit is half-open:
+		a few probe attempts are let through, and it closes again once
+		they succeed, or reopens if one fails.
+*/
+
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include "netimpl.h"
+
+namespace liboai {
+	/*
+		@brief Controls when liboai::CircuitBreaker opens its circuits
+			and how it probes them.
+	*/
+	struct CircuitBreakerOptions {
+		uint32_t failure_threshold = 5; // failed attempts in a row that open a circuit
+		std::chrono::milliseconds open_duration = std::chrono::seconds(30); // before an open circuit is probed
+		uint32_t half_open_probes = 1;  // attempts let through a half-open circuit, all of which must succeed to close it
+	};
+
+	class CircuitBreaker final {
+		public:
+			enum class Circuit : uint8_t {
+				CLOSED,    // attempts go through
+				OPEN,      // attempts fail at once
+				HALF_OPEN  // probe attempts go through
+			};
+
+			/*
+				@brief A change in the state of a circuit.
+			*/
+			struct Transition {
+				std::string key;        // the host and endpoint path
+				Circuit from, to;
+				uint32_t failures = 0;  // failed attempts in a row, when the circuit opened
+			};
+
+			struct Stats {
+				uint64_t admitted = 0, rejected = 0;
+				uint64_t opened = 0, half_opened = 0, closed = 0; // transitions into each state
+			};
+
+			/*
+				@brief An attempt let through a circuit, to be reported
+					with CircuitBreaker::Report() once it is over.
+			*/
+			struct Permit {
+				std::string key;
+				uint64_t probe = 0; // the half-open period it probes, or 0
+			};
+
+			/*
+				@brief How an attempt went, as far as the health of its
+					upstream is concerned.
+			*/
+			enum class Outcome : uint8_t {
+				SUCCEEDED, // a response other than 5xx was received
+				FAILED,    // no response, or a 5xx one
+				ABANDONED  // cancelled, or never sent; tells nothing
+			};
+
+			LIBOAI_EXPORT explicit CircuitBreaker(CircuitBreakerOptions options = {}) noexcept;
+			NON_COPYABLE(CircuitBreaker)
+			NON_MOVABLE(CircuitBreaker)
+			~CircuitBreaker() = default;
+
+			/*
+				@brief The circuit a URL goes through: its scheme, host
+					and port, and its path without the query.
+			*/
+			LIBOAI_EXPORT static std::string KeyOf(std::string_view url);
+
+			/*
+				@brief What the last request on a session tells of its
+					upstream.
+			*/
+			LIBOAI_EXPORT static Outcome OutcomeOf(const netimpl::Session& session) noexcept;
+
+			/*
+				@brief Lets an attempt at 'url' through its circuit.
+
+				@throws liboai::exception::OpenAICircuitOpen if the
+					circuit is open, or half-open with its probes already
+					out.
+			*/
+			LIBOAI_EXPORT Permit Admit(std::string_view url) noexcept(false);
+
+			/*
+				@brief Reports how an admitted attempt went.
+			*/
+			LIBOAI_EXPORT void Report(const Permit& permit, Outcome outcome) noexcept;
+
+			/*
+				@brief The state of the circuit 'url' goes through.
+			*/
+			LIBOAI_EXPORT Circuit StateOf(std::string_view url) const;
+
+			/*
+				@brief Sets a function called on every change in the
+					state of a circuit, such as to feed metrics. It is
+					called on the thread whose attempt or report caused
+					the change, outside the breaker's lock, and should
+					return quickly.
+			*/
+			LIBOAI_EXPORT void OnTransition(std::function<void(const Transition&)> listener);
+
+			LIBOAI_EXPORT Stats GetStats() const noexcept;
+
+			/*
+				@brief The breaker that liboai::Network consults, if any;
+					see liboai::Network::SetCircuitBreaker().
+			*/
+			LIBOAI_EXPORT static void SetActive(std::shared_ptr<CircuitBreaker> breaker) noexcept;
+			LIBOAI_EXPORT static std::shared_ptr<CircuitBreaker> Active() noexcept;
+
+		private:
+			struct Entry {
+				Circuit circuit = Circuit::CLOSED;
+				uint32_t failures = 0;
+				std::chrono::steady_clock::time_point opened;
+				uint64_t probe = 0;             // the current half-open period
+				uint32_t probing = 0, probed = 0; // probes out, and succeeded
+			};
+
+			void Notify(const std::optional<Transition>& transition) const noexcept;
+
+			CircuitBreakerOptions options_;
+
+			mutable std::mutex mutex_;
+			// only circuits that are not closed, or that have failures
+			// counted, are kept
+			std::unordered_map<std::string, Entry> circuits_;
+			uint64_t periods_ = 0;
+			Stats stats_;
+			std::shared_ptr<const std::function<void(const Transition&)>> listener_;
+	};
+}
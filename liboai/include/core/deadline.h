@@ -0,0 +1,72 @@
+#pragma once
+
+/*
+	deadline.h : liboai request deadline implementation.
+		This header file provides declarations for the per-request
+		timeouts that apply in place of, or within, the single timeout
+		set with liboai::Authorization::SetMaxTimeout().
+
+		Deadlines apply to the component calls made on a thread while
+		a liboai::DeadlineScope is alive on it, whether synchronous or
+		asynchronous, and to every attempt at those calls, retries
+		and hedges included. A request that is not over by its
+		absolute deadline fails however many attempts it has left,
+		and no attempt is retried past it. Requests that run out of
+		time fail with E_CURLERROR, as they do on cURL's own timeout.
+*/
+
+#include <chrono>
+#include <optional>
+#include "response.h"
+
+namespace liboai {
+	/*
+		@brief Limits on how long a request may take; those left
+			unset are inherited from the enclosing scope, if any.
+	*/
+	struct DeadlineOptions {
+		std::optional<std::chrono::milliseconds> connect;    // to connect, TLS handshake included
+		std::optional<std::chrono::milliseconds> first_byte; // from the request being sent to the first byte of its response
+		std::optional<std::chrono::milliseconds> idle;       // longest wait for more of a response, such as between chunks of a stream
+
+		/*
+			By when the request must be over, attempts and the waits
+			between them included. A scope nested in another keeps
+			the earlier of the two.
+		*/
+		std::optional<std::chrono::steady_clock::time_point> deadline;
+
+		/*
+			@brief Options with an absolute deadline 'budget' from now.
+		*/
+		static DeadlineOptions Within(std::chrono::milliseconds budget) {
+			DeadlineOptions options;
+			options.deadline = std::chrono::steady_clock::now() + budget;
+			return options;
+		}
+	};
+
+	/*
+		@brief Makes requests made on the constructing thread, while
+			the scope is alive, under 'options'. Scopes nest; the
+			innermost one applies, and cannot extend the deadline of
+			those it is nested in.
+	*/
+	class DeadlineScope final {
+		public:
+			LIBOAI_EXPORT explicit DeadlineScope(DeadlineOptions options) noexcept;
+			LIBOAI_EXPORT ~DeadlineScope();
+			NON_COPYABLE(DeadlineScope)
+			NON_MOVABLE(DeadlineScope)
+
+			/*
+				@brief The options in effect on the calling thread, if
+					any scope is alive on it.
+			*/
+			LIBOAI_EXPORT static std::optional<DeadlineOptions> Current() noexcept;
+
+		private:
+			DeadlineOptions options_;
+			const DeadlineScope* outer_;
+	};
+}
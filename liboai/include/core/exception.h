@@ -24,17 +24,19 @@ namespace liboai {
 			E_RATELIMIT,
 			E_CONNECTIONERROR,
 			E_FILEERROR,
-			E_CURLERROR
+			E_CURLERROR,
+			E_CIRCUITOPEN
 		};
 
-		constexpr const char* _etype_strs_[7] = {
+		constexpr const char* _etype_strs_[8] = {
 			"E_FAILURETOPARSE:0x00",
 			"E_BADREQUEST:0x01",
 			"E_APIERROR:0x02",
 			"E_RATELIMIT:0x03",
 			"E_CONNECTIONERROR:0x04",
 			"E_FILEERROR:0x05",
-			"E_CURLERROR:0x06"
+			"E_CURLERROR:0x06",
+			"E_CIRCUITOPEN:0x07"
 		};
 
 		class OpenAIException : public std::exception {
@@ -82,5 +84,28 @@ namespace liboai {
 				EType error_type_;
 				std::string data_, locale_, fmt_str_;
 		};
+
+		class OpenAICircuitOpen : public std::exception {
+			public:
+				OpenAICircuitOpen() = default;
+				OpenAICircuitOpen(const OpenAICircuitOpen& rhs) noexcept
+					: error_type_(rhs.error_type_), data_(rhs.data_), locale_(rhs.locale_) { this->fmt_str_ = (this->locale_ + ": " + this->data_ + " (" + this->GetETypeString(this->error_type_) + ")"); }
+				OpenAICircuitOpen(OpenAICircuitOpen&& rhs) noexcept
+					: error_type_(rhs.error_type_), data_(std::move(rhs.data_)), locale_(std::move(rhs.locale_)) { this->fmt_str_ = (this->locale_ + ": " + this->data_ + " (" + this->GetETypeString(this->error_type_) + ")"); }
+				OpenAICircuitOpen(std::string_view data, EType error_type, std::string_view locale) noexcept
+					: error_type_(error_type), data_(data), locale_(locale) { this->fmt_str_ = (this->locale_ + ": " + this->data_ + " (" + this->GetETypeString(this->error_type_) + ")"); }
+
+				const char* what() const noexcept override {
+					return this->fmt_str_.c_str();
+				}
+
+				constexpr const char* GetETypeString(EType type) const noexcept {
+					return _etype_strs_[static_cast<uint8_t>(type)];
+				}
+
+			private:
+				EType error_type_;
+				std::string data_, locale_, fmt_str_;
+		};
 	}
 }
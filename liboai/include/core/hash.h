@@ -0,0 +1,27 @@
+#pragma once
+
+/*
+	hash.h : liboai hashing implementation.
+		This header file provides declarations for the 128-bit
+		non-cryptographic hash that liboai's caches use to address
+		their entries by content.
+*/
+
+#include <cstdint>
+#include <cstddef>
+#include "response.h"
+
+namespace liboai {
+	class Hash final {
+		public:
+			/*
+				@brief MurmurHash3 (x64, 128-bit) of a block of bytes.
+
+				@param *data     The bytes to hash.
+				@param length    The number of bytes.
+				@param seed      The seed; equal seeds give equal hashes.
+				@param *out      Receives the two halves of the hash.
+			*/
+			LIBOAI_EXPORT static void Murmur3(const void* data, size_t length, uint64_t seed, uint64_t out[2]) noexcept;
+	};
+}
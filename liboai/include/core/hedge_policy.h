@@ -0,0 +1,132 @@
+#pragma once
+
+/*
+	hedge_policy.h : liboai request hedging implementation.
+		This header file provides declarations for the opt-in policy
+		under which liboai::Network hedges requests to idempotent
+		endpoints, once one has been set with
+		liboai::Network::SetHedgePolicy().
+
+		A hedged request that has not completed after a delay, taken
+		from a percentile of the latencies recently observed for its
+		endpoint, is sent a second time on another session. The first
+		of the two to succeed answers the request, and the other is
+		cancelled. How many requests are hedged is capped, so that
+		hedging cannot multiply the load on an API that is slow for
+		everyone.
+
+		Hedged requests are carried by the multi engine, including
+		synchronous ones, whose caller waits for the outcome. They
+		are not retried, and hedges are not drawn from the rate
+		limiter; keep the hedge rate within the limits' headroom.
+*/
+
+#include <functional>
+#include "netimpl.h"
+
+namespace liboai {
+	/*
+		@brief Controls which requests liboai::HedgePolicy hedges,
+			and when.
+	*/
+	struct HedgePolicyOptions {
+		/*
+			URL suffixes of the endpoints whose requests may be
+			hedged. Only list endpoints where sending a request twice
+			is harmless.
+		*/
+		std::vector<std::string> endpoints = { "/embeddings", "/moderations" };
+
+		double percentile = 0.95; // of the latencies observed for an endpoint, after which a hedge is sent
+		std::chrono::milliseconds min_delay = std::chrono::milliseconds(20); // the shortest wait before hedging
+		uint32_t min_samples = 20;  // latencies an endpoint needs before its requests are hedged
+		uint32_t window = 1000;     // latencies kept per endpoint, the most recent
+
+		/*
+			At most this fraction of requests is hedged over time;
+			up to max_hedge_burst hedges may go out together once
+			enough requests have gone without one.
+		*/
+		double max_hedge_rate = 0.05;
+		uint32_t max_hedge_burst = 10;
+	};
+
+	class HedgePolicy final {
+		public:
+			/*
+				@brief Reports that an attempt is over, with its outcome
+					and the session that carried it, which stays alive
+					until this returns.
+			*/
+			using Completion = std::function<void(std::future<liboai::Response>, const netimpl::Session&)>;
+
+			/*
+				@brief Sends an attempt at a request, calling the given
+					completion once it is over, and returns the session
+					carrying it, which must stay alive until then.
+			*/
+			using Launch = std::function<netimpl::Session*(Completion)>;
+
+			struct Stats {
+				uint64_t requests = 0;  // requests raced, hedged or not
+				uint64_t hedged = 0;    // requests a hedge was sent for
+				uint64_t hedge_wins = 0; // hedges that answered their request
+				uint64_t throttled = 0; // hedges not sent for the rate cap
+			};
+
+			LIBOAI_EXPORT explicit HedgePolicy(HedgePolicyOptions options = {}) noexcept;
+			NON_COPYABLE(HedgePolicy)
+			NON_MOVABLE(HedgePolicy)
+
+			/*
+				@brief Stops the policy's thread; hedges not yet sent
+					are dropped, and their requests answered by the
+					attempts already out.
+			*/
+			LIBOAI_EXPORT ~HedgePolicy();
+
+			/*
+				@brief Whether requests to 'url' are hedged under this
+					policy.
+			*/
+			LIBOAI_EXPORT bool Covers(std::string_view url) const noexcept;
+
+			/*
+				@brief Sends a request with 'launch', and again once the
+					hedge delay for its endpoint has passed if it has not
+					completed by then. 'callback' receives the first
+					successful response, or the last failure if no
+					attempt succeeds, along with the headers of that
+					response in 'received' if given, which must stay
+					alive until then.
+			*/
+			LIBOAI_EXPORT void Race(
+				std::string_view url,
+				Launch launch,
+				netimpl::MultiEngine::Callback callback,
+				netimpl::components::Header* received = nullptr
+			);
+
+			/*
+				@brief How long requests to 'url' wait before they are
+					hedged, or nullopt while too few have been observed.
+			*/
+			LIBOAI_EXPORT std::optional<std::chrono::milliseconds> Delay(std::string_view url) const;
+
+			LIBOAI_EXPORT Stats GetStats() const noexcept;
+
+			/*
+				@brief The policy that liboai::Network hedges under, if
+					any; see liboai::Network::SetHedgePolicy().
+			*/
+			LIBOAI_EXPORT static void SetActive(std::shared_ptr<HedgePolicy> policy) noexcept;
+			LIBOAI_EXPORT static std::shared_ptr<HedgePolicy> Active() noexcept;
+
+		private:
+			struct State;
+			struct Contest;
+
+			// shared with the policy's thread, which may outlive it
+			std::shared_ptr<State> state_;
+	};
+}
@@ -37,7 +37,18 @@
 #include <mutex>
 #include <future>
 #include <sstream>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+#include <chrono>
+#include <algorithm>
+#include <cctype>
 #include <curl/curl.h>
+#include "cancellation.h"
+#include "deadline.h"
 #include "response.h"
 
 namespace liboai {
@@ -69,9 +80,107 @@ namespace liboai {
 				}
 
 			protected:
+				/*
+					@brief Applies the options every handle starts with.
+						Called on construction and again after each
+						curl_easy_reset().
+				*/
+				void ApplyDefaults();
+
 				CURL* curl_ = nullptr;
 		};
 
+		/*
+			Process-wide cURL share object. Every handle created by
+				CurlHolder is attached to it, so DNS results and TLS
+				session tickets are shared across all Sessions and
+				threads rather than kept per handle. A Session for a
+				new origin, or one fresh out of the pool, can thus
+				resume TLS instead of performing a full handshake.
+				Access to each shared cache is serialized through the
+				lock callbacks below.
+
+				Counters report how many transfers reused a connection
+				and, when resumption tracking is enabled, how many TLS
+				handshakes resumed a cached session.
+		*/
+		class Share final {
+			public:
+				NON_COPYABLE(Share)
+				NON_MOVABLE(Share)
+
+				/*
+					@brief Singleton paradigm access method. The instance
+						is intentionally never destroyed, as handles still
+						attached to it may outlive any static destructor.
+				*/
+				static Share& Shared() noexcept {
+					static Share* instance = new Share();
+					return *instance;
+				}
+
+				/*
+					@brief Enables or disables sharing for handles configured
+						from now on. Enabled by default.
+				*/
+				void SetEnabled(bool enabled) noexcept { this->enabled_ = enabled; }
+				bool Enabled() const noexcept { return this->enabled_ && this->share_; }
+
+				/*
+					@brief Enables counting of TLS handshakes and session
+						resumptions for handles configured from now on;
+						requires cURL 7.80 or newer. Off by default.
+				*/
+				void SetTrackResumption(bool track) noexcept { this->track_resumption_ = track; }
+				bool TrackResumption() const noexcept { return this->track_resumption_; }
+
+				/*
+					@returns Number of completed transfers that reused an
+						already open connection.
+				*/
+				uint64_t ConnectionReuses() const noexcept { return this->connection_reuses_.load(std::memory_order_relaxed); }
+
+				/*
+					@returns Number of completed transfers that had to open
+						a new connection.
+				*/
+				uint64_t NewConnections() const noexcept { return this->new_connections_.load(std::memory_order_relaxed); }
+
+				/*
+					@returns Number of transfers that performed a TLS
+						handshake, full or resumed, while resumption
+						tracking was enabled.
+				*/
+				uint64_t TlsHandshakes() const noexcept { return this->tls_handshakes_.load(std::memory_order_relaxed); }
+
+				/*
+					@returns Number of those handshakes that resumed a
+						cached TLS session. Only counted when liboai is
+						built with LIBOAI_OPENSSL and cURL uses OpenSSL;
+						zero otherwise.
+				*/
+				uint64_t TlsResumptions() const noexcept { return this->tls_resumptions_.load(std::memory_order_relaxed); }
+
+			private:
+				friend class CurlHolder;
+				friend class Session;
+
+				Share();
+
+				void Attach(CURL* curl) noexcept;
+				void RecordTransfer(CURL* curl) noexcept;
+
+				static void Lock(CURL* handle, curl_lock_data data, curl_lock_access access, void* userptr);
+				static void Unlock(CURL* handle, curl_lock_data data, void* userptr);
+				static int Prerequest(void* userptr, char* primary_ip, char* local_ip, int primary_port, int local_port);
+
+				CURLSH* share_ = nullptr;
+				std::mutex locks_[CURL_LOCK_DATA_LAST];
+				std::atomic<bool> enabled_ = true, track_resumption_ = false;
+				std::atomic<uint64_t> connection_reuses_ = 0, new_connections_ = 0,
+					tls_handshakes_ = 0, tls_resumptions_ = 0;
+		};
+
 		/*
 			Contains all components that can be passed to below free methods
 			Get, Post, and Delete such as Url, Headers, Body, Multipart,
@@ -284,6 +393,14 @@ namespace liboai {
 						this->str_ = other.str_;
 						return *this;
 					}
+
+					/*
+						@brief Moves the body text out, leaving the Body
+							empty; lets a Session own it for a transfer.
+					*/
+					std::string take() noexcept {
+						return std::move(this->str_);
+					}
 			};
 
 			struct Buffer final {
@@ -566,28 +683,42 @@ namespace liboai {
 			class WriteCallback final {
 				public:
 					WriteCallback() = default;
-					WriteCallback(const WriteCallback& other) : callback(other.callback), userdata(other.userdata) {}
-					WriteCallback(WriteCallback&& old) noexcept : callback(std::move(old.callback)), userdata(std::move(old.userdata)) {}
+					WriteCallback(const WriteCallback& other) : userdata(other.userdata), callback(other.callback), finish(other.finish) {}
+					WriteCallback(WriteCallback&& old) noexcept : userdata(std::move(old.userdata)), callback(std::move(old.callback)), finish(std::move(old.finish)) {}
 					WriteCallback(std::function<bool(std::string data, intptr_t userdata)> p_callback, intptr_t p_userdata = 0)
 						: userdata(p_userdata), callback(std::move(p_callback)) {}
 
 					WriteCallback& operator=(const WriteCallback& other) {
 						this->callback = other.callback;
+						this->finish = other.finish;
 						this->userdata = other.userdata;
+						this->delivered = 0;
 						return *this;
 					}
 					WriteCallback& operator=(WriteCallback&& old) noexcept {
 						this->callback = std::move(old.callback);
+						this->finish = std::move(old.finish);
 						this->userdata = std::move(old.userdata);
+						this->delivered = 0;
 						return *this;
 					}
 
 					[[nodiscard]] bool operator()(std::string data) const {
+						delivered += data.size();
 						return callback(std::move(data), userdata);
 					}
 
+					// called once the whole body has been received
+					void Finish() const {
+						if (finish) {
+							finish(userdata);
+						}
+					}
+
 					intptr_t userdata{};
 					std::function<bool(std::string data, intptr_t userdata)> callback;
+					std::function<void(intptr_t userdata)> finish;
+					mutable size_t delivered = 0; // bytes handed to callback; not copied
 			};
 			size_t writeUserFunction(char* ptr, size_t size, size_t nmemb, const WriteCallback* write);
 			size_t writeFunction(char* ptr, size_t size, size_t nmemb, std::string* data);
@@ -616,13 +747,76 @@ namespace liboai {
 				liboai::Response Download(std::ofstream& file);
 				void ClearContext();
 
-				
+				/*
+					@brief The headers of the last response received,
+						kept until the next request or until the session
+						goes back to the pool.
+				*/
+				const components::Header& ResponseHeader() const noexcept { return this->response_header_; }
+
+				/*
+					@brief What became of the last request: the result of
+						its transfer, and the status code of its response,
+						or 0 if none was received.
+				*/
+				CURLcode Result() const noexcept { return this->result_; }
+				long StatusCode() const noexcept { return this->status_code; }
+
+				/*
+					@brief Whether any of the last response has been
+						handed to a user-supplied write callback, in which
+						case the request cannot be sent again unnoticed.
+				*/
+				bool Delivered() const noexcept { return this->write_.delivered != 0; }
+
+				/*
+					@brief Sends the last request again exactly as it was
+						set up, without setting any of its options, for
+						retrying a request that failed.
+				*/
+				liboai::Response Resend();
+
+				/*
+					@brief Aborts the request in progress; safe to call
+						from any thread. The request then fails with
+						E_CONNECTIONERROR. This holds until the session is
+						set up for its next request.
+				*/
+				void Cancel() noexcept;
+
+				/*
+					@brief Whether the request in progress has been
+						cancelled, either on the session itself or through
+						the CancellationToken it was made under.
+				*/
+				bool Cancelled() const noexcept {
+					return this->cancelled_.load(std::memory_order_relaxed) || (this->token_ && this->token_->Cancelled());
+				}
+
+				/*
+					@brief The CancellationToken the request in progress
+						was made under, if any.
+				*/
+				const std::optional<CancellationToken>& Token() const noexcept { return this->token_; }
+
+				/*
+					@brief By when the request in progress must be over,
+						if it was made under a DeadlineScope that set one.
+				*/
+				std::optional<std::chrono::steady_clock::time_point> Deadline() const noexcept {
+					return this->deadline_ ? this->deadline_->deadline : std::nullopt;
+				}
+
+
 			private:
 				template <class... _Options>
 				friend void set_options(Session&, _Options&&...);
+				friend class MultiEngine;
+				friend class SessionPool;
 
 				void Prepare();
 				void PrepareDownloadInternal();
+				void PrepareResend();
 				CURLcode Perform();
 				liboai::Response BuildResponseObject();
 				liboai::Response Complete();
@@ -634,6 +828,13 @@ namespace liboai {
 				void PrepareDownload(std::ofstream& file);
 
 				void ParseResponseHeader(const std::string& headers, std::string* status_line, std::string* reason);
+				void CheckResult(CURLcode result, std::string_view where) const;
+				CURLcode ResultOf(CURLcode result) const noexcept;
+				static int Progress(void* session, curl_off_t, curl_off_t dlnow, curl_off_t, curl_off_t ulnow) noexcept;
+
+				void ApplyDeadline();
+				bool Watched() const noexcept;
+				std::optional<std::chrono::steady_clock::time_point> Due() const noexcept;
 
 				void SetOption(const components::Url& url);
 				void SetUrl(const components::Url& url);
@@ -690,9 +891,291 @@ namespace liboai {
 				bool hasBody = false;
 				std::string parameter_string_, url_,
 					response_string_, header_string_;
+				std::string body_; // request body handed to cURL by pointer
 				components::Proxies proxies_;
 				components::ProxyAuthentication proxyAuth_;
 				components::WriteCallback write_;
+				components::Header response_header_;
+				CURLcode result_ = CURLE_OK;
+				std::atomic<bool> cancelled_ = false;
+				std::atomic<CURLM*> multi_ = nullptr; // the engine loop carrying the transfer, if any
+				std::optional<CancellationToken> token_; // that of the scope the request was prepared in
+				std::optional<DeadlineOptions> deadline_; // likewise
+				long timeout_ms_ = 0; // set with the Timeout option, 0 for none
+
+				// the attempt in progress, as watched by Progress() for
+				// the first-byte and idle timeouts
+				std::chrono::steady_clock::time_point active_at_;
+				curl_off_t transferred_ = 0;
+				bool awaiting_ = true; // no byte of the response received yet
+				std::atomic<bool> expired_ = false;
+
+				// set by SessionPool for pooled sessions
+				std::string origin_;
+				std::chrono::steady_clock::time_point created_ = std::chrono::steady_clock::now();
+		};
+
+		/*
+			Thread-safe pool of idle Sessions, keyed by origin
+				(scheme://host[:port]). A Session keeps its cURL handle,
+				and with it the handle's keep-alive connections and TLS
+				session cache, so a leased Session for an origin that
+				was recently used skips the TCP and TLS handshakes.
+
+				Sessions are leased with Acquire() and go back to the
+				pool when the lease is destroyed. Idle Sessions are
+				discarded once they exceed the idle timeout or their
+				maximum lifetime; setting the per-origin size to zero
+				disables pooling altogether.
+		*/
+		class SessionPool final {
+			public:
+				struct Returner {
+					void operator()(Session* session) const noexcept;
+				};
+				using Lease = std::unique_ptr<Session, Returner>;
+
+				NON_COPYABLE(SessionPool)
+				NON_MOVABLE(SessionPool)
+				~SessionPool() = default;
+
+				/*
+					@brief Singleton paradigm access method.
+					@return A reference to the pool shared by all components.
+				*/
+				static SessionPool& Pool() noexcept {
+					static SessionPool instance;
+					return instance;
+				}
+
+				/*
+					@brief Leases a Session for the origin of 'url,' reusing
+						an idle one if available.
+				*/
+				Lease Acquire(std::string_view url);
+
+				/*
+					@brief Sets the maximum number of idle Sessions kept per
+						origin. Zero disables pooling. Defaults to 8.
+				*/
+				void SetMaxIdlePerOrigin(size_t count) noexcept;
+
+				/*
+					@brief Sets how long a Session may sit idle in the pool
+						before it is discarded. Defaults to 60 seconds.
+				*/
+				void SetIdleTimeout(std::chrono::milliseconds timeout) noexcept;
+
+				/*
+					@brief Sets the maximum age of a Session, after which it
+						is discarded rather than returned to the pool.
+						Defaults to 10 minutes.
+				*/
+				void SetMaxLifetime(std::chrono::milliseconds lifetime) noexcept;
+
+				/*
+					@brief Discards every idle Session.
+				*/
+				void Clear() noexcept;
+
+				/*
+					@returns Number of Acquire() calls served by an idle Session.
+				*/
+				uint64_t Reuses() const noexcept { return this->reuses_.load(std::memory_order_relaxed); }
+
+				/*
+					@returns Number of Acquire() calls that had to create a Session.
+				*/
+				uint64_t Misses() const noexcept { return this->misses_.load(std::memory_order_relaxed); }
+
+				/*
+					@returns Number of Sessions currently idle in the pool.
+				*/
+				size_t Idle() const noexcept;
+
+				/*
+					@brief Extracts the scheme://authority part of a URL.
+				*/
+				static std::string Origin(std::string_view url);
+
+			private:
+				SessionPool() = default;
+
+				struct Entry {
+					std::unique_ptr<Session> session;
+					std::chrono::steady_clock::time_point idle_since;
+				};
+
+				void Release(Session* session) noexcept;
+				bool Expired(const Entry& entry, std::chrono::steady_clock::time_point now) const noexcept;
+
+				mutable std::mutex mutex_;
+				std::unordered_map<std::string, std::vector<Entry>> idle_;
+				size_t max_idle_ = 8;
+				std::chrono::milliseconds idle_timeout_ = std::chrono::seconds(60);
+				std::chrono::milliseconds max_lifetime_ = std::chrono::minutes(10);
+				std::atomic<uint64_t> reuses_ = 0, misses_ = 0;
+		};
+
+		/*
+			Event-loop engine driving many Sessions at once through
+				cURL's multi interface. Rather than blocking one thread
+				per request in curl_easy_perform(), prepared Sessions are
+				handed to one of N loop threads, each of which owns a
+				CURLM handle and multiplexes all of its transfers.
+
+				Completed transfers fulfil a future, or invoke a callback
+				with an already-satisfied future, from the loop thread.
+				Callbacks should therefore return quickly, as they hold
+				up every other transfer on the same loop.
+
+				In HTTP/2 mode, synchronous transfers are also performed
+				by the engine so that concurrent requests to the same
+				host share connections as multiplexed streams.
+		*/
+		class MultiEngine final {
+			public:
+				using Callback = std::function<void(std::future<liboai::Response>)>;
+
+				NON_COPYABLE(MultiEngine)
+				NON_MOVABLE(MultiEngine)
+				~MultiEngine();
+
+				/*
+					@brief Singleton paradigm access method.
+					@return A reference to the engine shared by all components.
+				*/
+				static MultiEngine& Engine() noexcept {
+					static MultiEngine instance;
+					return instance;
+				}
+
+				/*
+					@brief Sets the number of loop threads to spread transfers
+						across. Only effective before the first transfer is
+						submitted, as loops are started lazily.
+
+					@param count   Number of loop threads, at least one.
+
+					@returns True if the count was applied, false if the loops
+						are already running or count is zero.
+				*/
+				[[nodiscard]] bool SetLoopCount(size_t count) noexcept;
+
+				/*
+					@returns The number of transfers currently owned by the engine.
+				*/
+				size_t InFlight() const noexcept { return this->in_flight_.load(std::memory_order_relaxed); }
+
+				/*
+					@brief Enables or disables HTTP/2 multiplexing. When
+						enabled, Sessions negotiate HTTP/2 over TLS, wait
+						for a connection they can multiplex on rather than
+						opening a new one, and synchronous requests are
+						routed through the engine. Connections whose peer
+						does not offer HTTP/2 fall back to HTTP/1.1.
+
+					@param enabled                  Whether to multiplex.
+					@param max_concurrent_streams   Maximum number of streams
+						opened on a single connection.
+					@param max_host_connections     Maximum number of connections
+						per host; transfers beyond what these can carry
+						wait for a free stream. This also bounds the
+						concurrency of hosts that fall back to HTTP/1.1.
+						Zero means unlimited.
+
+					@returns False if enabling was requested but the linked
+						cURL has no HTTP/2 support.
+				*/
+				[[nodiscard]] bool SetHttp2(bool enabled, long max_concurrent_streams = 100, long max_host_connections = 4) noexcept;
+				bool Http2() const noexcept { return this->http2_.load(std::memory_order_relaxed); }
+
+				/*
+					@brief Performs an already prepared Session on a loop
+						thread and blocks until it completes. Used for
+						synchronous transfers in HTTP/2 mode.
+				*/
+				CURLcode Perform(Session& session);
+
+				/*
+					@brief Wakes every loop so that the transfers they
+						carry are checked for cancellation at once.
+				*/
+				void Wake() noexcept;
+
+				std::future<liboai::Response> Get(SessionPool::Lease session);
+				std::future<liboai::Response> Post(SessionPool::Lease session);
+				std::future<liboai::Response> Delete(SessionPool::Lease session);
+				void Get(SessionPool::Lease session, Callback callback);
+				void Post(SessionPool::Lease session, Callback callback);
+				void Delete(SessionPool::Lease session, Callback callback);
+
+				/*
+					@brief Downloads into 'file', which is kept alive by the
+						engine until the transfer completes.
+				*/
+				void Download(SessionPool::Lease session, std::shared_ptr<std::ofstream> file, Callback callback);
+
+				/*
+					@brief As above, but on a caller-owned Session which must
+						outlive the transfer.
+				*/
+				void Download(Session& session, std::shared_ptr<std::ofstream> file, Callback callback);
+
+				/*
+					@brief As Get, Post and Delete, but on a caller-owned
+						Session which must outlive the transfer, so that it
+						can be resent once the transfer is over.
+				*/
+				void Get(Session& session, Callback callback);
+				void Post(Session& session, Callback callback);
+				void Delete(Session& session, Callback callback);
+
+				/*
+					@brief Sends the last request made on a caller-owned
+						Session again, as Session::Resend() does, but on a
+						loop thread.
+				*/
+				void Resend(Session& session, Callback callback);
+
+			private:
+				// the pool must outlive the engine, which still owns
+				// leases while shutting down
+				MultiEngine() { SessionPool::Pool(); }
+
+				struct Transfer {
+					SessionPool::Lease owned;
+					Session* session = nullptr;
+					std::shared_ptr<std::ofstream> file;
+					std::promise<liboai::Response> promise;
+					std::promise<CURLcode>* performed = nullptr;
+					Callback callback;
+				};
+
+				struct Loop {
+					CURLM* multi = nullptr;
+					std::thread thread;
+					std::mutex mutex;
+					std::vector<std::unique_ptr<Transfer>> incoming;
+					std::unordered_map<CURL*, std::unique_ptr<Transfer>> active;
+					std::atomic<bool> stop = false;
+					long max_streams = 0, max_host_connections = 0;
+				};
+
+				std::future<liboai::Response> Submit(std::unique_ptr<Transfer> transfer, const std::function<void(Session&)>& prepare);
+				void Enqueue(std::unique_ptr<Transfer> transfer);
+				void Start();
+				void Run(Loop& loop);
+				void Finish(std::unique_ptr<Transfer> transfer, CURLcode result, std::exception_ptr error = nullptr) noexcept;
+				static std::exception_ptr ShutDown();
+
+				std::mutex start_mutex_;
+				std::vector<std::unique_ptr<Loop>> loops_;
+				std::atomic<bool> started_ = false, shutdown_ = false;
+				std::atomic<size_t> next_ = 0, in_flight_ = 0;
+				size_t loop_count_ = 1;
+				std::atomic<bool> http2_ = false;
+				std::atomic<long> max_streams_ = 100, max_host_connections_ = 0;
 		};
 
 		template <class... _Options>
@@ -751,6 +1234,76 @@ namespace liboai {
 			return session.Download(file);
 		}
 
+		template <class... _Options>
+		std::future<liboai::Response> GetAsync(SessionPool::Lease session, _Options&&... options) {
+			set_options(*session, std::forward<_Options>(options)...);
+			return MultiEngine::Engine().Get(std::move(session));
+		}
+
+		template <class... _Options>
+		std::future<liboai::Response> PostAsync(SessionPool::Lease session, _Options&&... options) {
+			set_options(*session, std::forward<_Options>(options)...);
+			return MultiEngine::Engine().Post(std::move(session));
+		}
+
+		template <class... _Options>
+		std::future<liboai::Response> DeleteAsync(SessionPool::Lease session, _Options&&... options) {
+			set_options(*session, std::forward<_Options>(options)...);
+			return MultiEngine::Engine().Delete(std::move(session));
+		}
+
+		template <class... _Options>
+		void GetAsyncWithCallback(SessionPool::Lease session, MultiEngine::Callback callback, _Options&&... options) {
+			set_options(*session, std::forward<_Options>(options)...);
+			MultiEngine::Engine().Get(std::move(session), std::move(callback));
+		}
+
+		template <class... _Options>
+		void PostAsyncWithCallback(SessionPool::Lease session, MultiEngine::Callback callback, _Options&&... options) {
+			set_options(*session, std::forward<_Options>(options)...);
+			MultiEngine::Engine().Post(std::move(session), std::move(callback));
+		}
+
+		template <class... _Options>
+		void DeleteAsyncWithCallback(SessionPool::Lease session, MultiEngine::Callback callback, _Options&&... options) {
+			set_options(*session, std::forward<_Options>(options)...);
+			MultiEngine::Engine().Delete(std::move(session), std::move(callback));
+		}
+
+		template <class... _Options>
+		void GetAsyncWithSession(Session& session, MultiEngine::Callback callback, _Options&&... options) {
+			session.ClearContext();
+			set_options(session, std::forward<_Options>(options)...);
+			MultiEngine::Engine().Get(session, std::move(callback));
+		}
+
+		template <class... _Options>
+		void PostAsyncWithSession(Session& session, MultiEngine::Callback callback, _Options&&... options) {
+			session.ClearContext();
+			set_options(session, std::forward<_Options>(options)...);
+			MultiEngine::Engine().Post(session, std::move(callback));
+		}
+
+		template <class... _Options>
+		void DeleteAsyncWithSession(Session& session, MultiEngine::Callback callback, _Options&&... options) {
+			session.ClearContext();
+			set_options(session, std::forward<_Options>(options)...);
+			MultiEngine::Engine().Delete(session, std::move(callback));
+		}
+
+		template <class... _Options>
+		void DownloadAsync(SessionPool::Lease session, std::shared_ptr<std::ofstream> file, MultiEngine::Callback callback, _Options&&... options) {
+			set_options(*session, std::forward<_Options>(options)...);
+			MultiEngine::Engine().Download(std::move(session), std::move(file), std::move(callback));
+		}
+
+		template <class... _Options>
+		void DownloadAsyncWithSession(Session& session, std::shared_ptr<std::ofstream> file, MultiEngine::Callback callback, _Options&&... options) {
+			session.ClearContext();
+			set_options(session, std::forward<_Options>(options)...);
+			MultiEngine::Engine().Download(session, std::move(file), std::move(callback));
+		}
+
 		template <class... _Options>
 		void set_options(Session& session, _Options&&... opts) {
 			(session.SetOption(std::forward<_Options>(opts)), ...);
@@ -16,6 +16,12 @@
 #include <optional>
 #include <future>
 #include "netimpl.h"
+#include "circuit_breaker.h"
+#include "hedge_policy.h"
+#include "rate_limiter.h"
+#include "response_cache.h"
+#include "retry_policy.h"
+#include "single_flight.h"
 
 namespace liboai {
 	class Network {
@@ -53,8 +59,10 @@ namespace liboai {
 				netimpl::components::Header authorization
 			) noexcept(false) {
 				std::ofstream file(to, std::ios::binary);
+				netimpl::SessionPool::Lease session = netimpl::SessionPool::Pool().Acquire(from);
 				Response res;
-				res = netimpl::Download(
+				res = netimpl::DownloadWithSession(
+					*session,
 					file,
 					netimpl::components::Url{ from },
 					std::move(authorization)
@@ -104,21 +112,25 @@ namespace liboai {
 				const std::string& from,
 				netimpl::components::Header authorization
 			) noexcept(false) {
-				return std::async(
-					std::launch::async, [&]() -> bool {
-						std::ofstream file(to, std::ios::binary);
-						Response res;
-						res = netimpl::Download(
-							file,
-							netimpl::components::Url{ from },
-							std::move(authorization)
-						);
+				auto file = std::make_shared<std::ofstream>(to, std::ios::binary);
+				auto result = std::make_shared<std::promise<bool>>();
+				std::future<bool> future = result->get_future();
 
-						return res.status_code == 200;
-					}
+				netimpl::DownloadAsync(
+					netimpl::SessionPool::Pool().Acquire(from),
+					std::move(file),
+					Network::DownloadCompletion(std::move(result)),
+					netimpl::components::Url{ from },
+					std::move(authorization)
 				);
+
+				return future;
 			}
 
+			/*
+				@brief As DownloadAsync, but reusing 'session,' which
+					must outlive the returned future.
+			*/
 			[[nodiscard]]
 			static inline std::future<bool> DownloadAsyncWithSession(
 				const std::string& to,
@@ -126,20 +138,112 @@ namespace liboai {
 				netimpl::components::Header authorization,
 				netimpl::Session& session
 			) noexcept(false) {
-				return std::async(
-					std::launch::async, [&]() -> bool {
-						std::ofstream file(to, std::ios::binary);
-						Response res;
-						res = netimpl::DownloadWithSession(
-							session,
-							file,
-							netimpl::components::Url{ from },
-							std::move(authorization)
-						);
+				auto file = std::make_shared<std::ofstream>(to, std::ios::binary);
+				auto result = std::make_shared<std::promise<bool>>();
+				std::future<bool> future = result->get_future();
 
-						return res.status_code == 200;
-					}
+				netimpl::DownloadAsyncWithSession(
+					session,
+					std::move(file),
+					Network::DownloadCompletion(std::move(result)),
+					netimpl::components::Url{ from },
+					std::move(authorization)
 				);
+
+				return future;
+			}
+
+			/*
+				@brief Sets the number of event-loop threads used to
+					drive asynchronous requests. Must be called before
+					the first asynchronous request is made.
+
+				@param count   Number of loop threads, at least one.
+
+				@returns True if the count was applied.
+			*/
+			static inline bool SetAsyncLoopCount(size_t count) noexcept {
+				return netimpl::MultiEngine::Engine().SetLoopCount(count);
+			}
+
+			/*
+				@brief Enables or disables HTTP/2 multiplexing. While
+					enabled, concurrent requests to the same host--both
+					synchronous and asynchronous--are carried as streams
+					over a few shared connections rather than one
+					connection each. Hosts that do not offer HTTP/2 are
+					spoken to over HTTP/1.1 as before.
+
+				@param enabled                  Whether to multiplex.
+				@param max_concurrent_streams   Streams allowed per connection.
+				@param max_host_connections     Connections allowed per host.
+
+				@returns False if the linked cURL lacks HTTP/2 support.
+			*/
+			static inline bool SetHttp2(bool enabled, long max_concurrent_streams = 100, long max_host_connections = 4) noexcept {
+				return netimpl::MultiEngine::Engine().SetHttp2(enabled, max_concurrent_streams, max_host_connections);
+			}
+
+			/*
+				@brief Sets the cache that requests are answered from
+					where possible, or removes it when given nullptr;
+					see liboai::ResponseCache. There is no cache by
+					default.
+			*/
+			static inline void SetResponseCache(std::shared_ptr<ResponseCache> cache) noexcept {
+				ResponseCache::SetActive(std::move(cache));
+			}
+
+			/*
+				@brief Enables or disables coalescing of identical
+					requests: while enabled, a request made while an
+					identical one is still in flight waits for that
+					transfer rather than starting its own; see
+					liboai::SingleFlight. Disabled by default.
+			*/
+			static inline void SetRequestCoalescing(bool enabled) noexcept {
+				SingleFlight::SetEnabled(enabled);
+			}
+
+			/*
+				@brief Sets the limiter that requests wait on before
+					they are sent, or removes it when given nullptr; see
+					liboai::RateLimiter. There is no limiter by default.
+					Asynchronous requests already waiting on a limiter
+					keep waiting on it until it is destroyed.
+			*/
+			static inline void SetRateLimiter(std::shared_ptr<RateLimiter> limiter) noexcept {
+				RateLimiter::SetActive(std::move(limiter));
+			}
+
+			/*
+				@brief Sets the policy under which failed requests are
+					retried, or removes it when given nullptr; see
+					liboai::RetryPolicy. Requests are not retried by
+					default.
+			*/
+			static inline void SetRetryPolicy(std::shared_ptr<RetryPolicy> policy) noexcept {
+				RetryPolicy::SetActive(std::move(policy));
+			}
+
+			/*
+				@brief Sets the policy under which slow requests to
+					idempotent endpoints are hedged, or removes it when
+					given nullptr; see liboai::HedgePolicy. Requests are
+					not hedged by default.
+			*/
+			static inline void SetHedgePolicy(std::shared_ptr<HedgePolicy> policy) noexcept {
+				HedgePolicy::SetActive(std::move(policy));
+			}
+
+			/*
+				@brief Sets the breaker whose circuits every attempt at
+					a request must pass, or removes it when given
+					nullptr; see liboai::CircuitBreaker. There is no
+					breaker by default.
+			*/
+			static inline void SetCircuitBreaker(std::shared_ptr<CircuitBreaker> breaker) noexcept {
+				CircuitBreaker::SetActive(std::move(breaker));
 			}
 			
 		protected:
@@ -168,22 +272,53 @@ namespace liboai {
 					}
 				}
 				
-				Response res;
-				if constexpr (sizeof...(parameters) > 0) {
-					res = Network::MethodSchema<netimpl::components::Header&&, _Params&&...>::_method[static_cast<uint8_t>(http_method)](
-						netimpl::components::Url { root + endpoint },
-						std::move(_headers),
-						std::forward<_Params>(parameters)...
-					);
-				}
-				else {
-					res = Network::MethodSchema<netimpl::components::Header&&>::_method[static_cast<uint8_t>(http_method)](
-						netimpl::components::Url { root + endpoint },
-						std::move(_headers)
-					);
-				}			
+				// sessions are leased from the shared pool so that
+				// consecutive calls to the same origin reuse a warm
+				// connection instead of handshaking again
+				const std::string url = root + endpoint;
 
-				return res;
+				return Network::Shared(http_method, url, _headers, [&](Charge* charge, netimpl::components::Header* received) {
+					// a hedged request is raced on the engine, each
+					// attempt on a session of its own
+					std::shared_ptr<HedgePolicy> hedge = HedgePolicy::Active();
+					if (Network::Hedges(hedge, http_method, url, parameters...)) {
+						auto outcome = std::make_shared<std::promise<Response>>();
+						FutureResponse future = outcome->get_future();
+						Network::Hedged(hedge, [outcome](FutureResponse response) {
+							try {
+								outcome->set_value(response.get());
+							}
+							catch (...) {
+								outcome->set_exception(std::current_exception());
+							}
+						}, http_method, url, std::make_shared<const std::tuple<netimpl::components::Header, _Params...>>(_headers, parameters...), received);
+						return future.get();
+					}
+
+					netimpl::SessionPool::Lease session = netimpl::SessionPool::Pool().Acquire(url);
+					ReceivedHeaders copy(*session, received);
+
+					return Network::Retried(*session, url, charge, [&]() {
+						Response res;
+						if constexpr (sizeof...(parameters) > 0) {
+							res = Network::MethodSchemaWithSession<netimpl::components::Header&&, _Params&&...>::_method[static_cast<uint8_t>(http_method)](
+								*session,
+								netimpl::components::Url { url },
+								std::move(_headers),
+								std::forward<_Params>(parameters)...
+							);
+						}
+						else {
+							res = Network::MethodSchemaWithSession<netimpl::components::Header&&>::_method[static_cast<uint8_t>(http_method)](
+								*session,
+								netimpl::components::Url { url },
+								std::move(_headers)
+							);
+						}
+
+						return res;
+					});
+				}, parameters...);
 			}
 
 
@@ -207,24 +342,207 @@ namespace liboai {
 					}
 				}
 				
-				Response res;
+				return Network::Shared(http_method, root + endpoint, _headers, [&](Charge* charge, netimpl::components::Header* received) {
+					ReceivedHeaders copy(session, received);
+
+					return Network::Retried(session, root + endpoint, charge, [&]() {
+						Response res;
+						if constexpr (sizeof...(parameters) > 0) {
+							res = Network::MethodSchemaWithSession<netimpl::components::Header&&, _Params&&...>::_method[static_cast<uint8_t>(http_method)](
+								session,
+								netimpl::components::Url { root + endpoint },
+								std::move(_headers),
+								std::forward<_Params>(parameters)...
+							);
+						}
+						else {
+							res = Network::MethodSchemaWithSession<netimpl::components::Header&&>::_method[static_cast<uint8_t>(http_method)](
+								session,
+								netimpl::components::Url { root + endpoint },
+								std::move(_headers)
+							);
+						}
+
+						return res;
+					});
+				}, parameters...);
+			}
+
+			/*
+				@brief Asynchronous counterpart to Request. The transfer
+					is handed to the shared multi engine rather than
+					occupying a thread of its own; the returned future
+					is satisfied from the engine's loop thread.
+			*/
+			template <class... _Params,
+				std::enable_if_t<std::conjunction_v<std::negation<std::is_lvalue_reference<_Params>>...>, int> = 0>
+			inline FutureResponse RequestAsync(
+				const Method& http_method,
+				const std::string& root,
+				const std::string& endpoint,
+				const std::string& content_type,
+				std::optional<netimpl::components::Header> headers = std::nullopt,
+				_Params&&... parameters
+			) const {
+				// with a response cache, coalescing, a rate limiter,
+				// retries, hedging or a circuit breaker in use, requests
+				// go through the callback form below, which handles them
+				// all
+				if (ResponseCache::Active() || SingleFlight::Enabled() || RateLimiter::Active() || RetryPolicy::Active() || HedgePolicy::Active() || CircuitBreaker::Active()) {
+					auto result = std::make_shared<std::promise<Response>>();
+					FutureResponse future = result->get_future();
+
+					Network::RequestAsync(
+						[result](FutureResponse response) {
+							try {
+								result->set_value(response.get());
+							}
+							catch (...) {
+								result->set_exception(std::current_exception());
+							}
+						},
+						http_method, root, endpoint, content_type, std::move(headers), std::forward<_Params>(parameters)...
+					);
+					return future;
+				}
+
+				netimpl::components::Header _headers = { { "Content-Type", content_type } };
+				if (headers) {
+					if (headers.value().size() != 0) {
+						for (auto& i : headers.value()) {
+							_headers.insert(std::move(i));
+						}
+					}
+				}
+
+				const std::string url = root + endpoint;
+				netimpl::SessionPool::Lease session = netimpl::SessionPool::Pool().Acquire(url);
+
 				if constexpr (sizeof...(parameters) > 0) {
-					res = Network::MethodSchemaWithSession<netimpl::components::Header&&, _Params&&...>::_method[static_cast<uint8_t>(http_method)](
-						session,
-						netimpl::components::Url { root + endpoint },
+					return Network::MethodSchemaAsync<netimpl::components::Header&&, _Params&&...>::_method[static_cast<uint8_t>(http_method)](
+						std::move(session),
+						netimpl::components::Url { url },
 						std::move(_headers),
 						std::forward<_Params>(parameters)...
 					);
 				}
 				else {
-					res = Network::MethodSchemaWithSession<netimpl::components::Header&&>::_method[static_cast<uint8_t>(http_method)](
-						session,
-						netimpl::components::Url { root + endpoint },
+					return Network::MethodSchemaAsync<netimpl::components::Header&&>::_method[static_cast<uint8_t>(http_method)](
+						std::move(session),
+						netimpl::components::Url { url },
 						std::move(_headers)
 					);
-				}			
+				}
+			}
 
-				return res;
+			/*
+				@brief Selects Request or RequestAsync for Send, so a
+					component builds each request once and only the
+					call differs between a method and its _async twin.
+			*/
+			struct Synchronous { using Result = Response; };
+			struct Asynchronous { using Result = FutureResponse; };
+
+			template <class _Mode, class... _Params,
+				std::enable_if_t<std::conjunction_v<std::negation<std::is_lvalue_reference<_Params>>...>, int> = 0>
+			inline typename _Mode::Result Send(
+				_Mode,
+				const Method& http_method,
+				const std::string& root,
+				const std::string& endpoint,
+				const std::string& content_type,
+				std::optional<netimpl::components::Header> headers = std::nullopt,
+				_Params&&... parameters
+			) const {
+				if constexpr (std::is_same_v<_Mode, Asynchronous>) {
+					return this->RequestAsync(http_method, root, endpoint, content_type, std::move(headers), std::forward<_Params>(parameters)...);
+				}
+				else {
+					return this->Request(http_method, root, endpoint, content_type, std::move(headers), std::forward<_Params>(parameters)...);
+				}
+			}
+
+			/*
+				@brief As RequestAsync, but rather than returning a future
+					the request hands it to 'callback' once the transfer
+					completes. The callback runs on the engine's loop
+					thread, or on the calling thread if the request could
+					not be prepared, and should return quickly.
+			*/
+			template <class... _Params,
+				std::enable_if_t<std::conjunction_v<std::negation<std::is_lvalue_reference<_Params>>...>, int> = 0>
+			static inline void RequestAsync(
+				netimpl::MultiEngine::Callback callback,
+				const Method& http_method,
+				const std::string& root,
+				const std::string& endpoint,
+				const std::string& content_type,
+				std::optional<netimpl::components::Header> headers = std::nullopt,
+				_Params&&... parameters
+			) {
+				netimpl::components::Header _headers = { { "Content-Type", content_type } };
+				if (headers) {
+					if (headers.value().size() != 0) {
+						for (auto& i : headers.value()) {
+							_headers.insert(std::move(i));
+						}
+					}
+				}
+
+				const std::string url = root + endpoint;
+
+				// the request is owned by the send below, which a rate
+				// limiter may put off until after this call has returned,
+				// and so are the token and deadlines it is made under
+				auto request = std::make_shared<std::tuple<netimpl::components::Header, _Params...>>(std::move(_headers), std::forward<_Params>(parameters)...);
+
+				std::apply([&](const netimpl::components::Header& request_headers, const _Params&... request_parameters) {
+					Network::SharedAsync(std::move(callback), http_method, url, request_headers, [http_method, url, request, caller = Caller{}](netimpl::MultiEngine::Callback completion, netimpl::components::Header* received, std::shared_ptr<AsyncCharge> charge) {
+						CallerScope scope(caller);
+
+						std::shared_ptr<HedgePolicy> hedge = HedgePolicy::Active();
+						if (std::apply([&](const netimpl::components::Header&, const _Params&... owned_parameters) { return Network::Hedges(hedge, http_method, url, owned_parameters...); }, *request)) {
+							Network::Hedged(hedge, std::move(completion), http_method, url, std::shared_ptr<const std::tuple<netimpl::components::Header, _Params...>>(request), received);
+							return;
+						}
+
+						netimpl::SessionPool::Lease session = netimpl::SessionPool::Pool().Acquire(url);
+						if (received) {
+							completion = Network::ReceiveHeaders(*session, received, std::move(completion));
+						}
+
+						// a request that may be retried keeps its session
+						// until it is over, so that it can be sent again
+						if (std::shared_ptr<RetryPolicy> policy = RetryPolicy::Active()) {
+							Network::RetriedAsync(std::move(policy), std::move(session), url, std::move(charge), std::move(completion), [&](netimpl::Session& first, netimpl::MultiEngine::Callback done) {
+								std::apply([&](netimpl::components::Header& owned_headers, _Params&... owned_parameters) {
+									Network::MethodSchemaAsyncWithSession<netimpl::components::Header&&, _Params&&...>::_method[static_cast<uint8_t>(http_method)](
+										first,
+										std::move(done),
+										netimpl::components::Url { url },
+										std::move(owned_headers),
+										std::move(owned_parameters)...
+									);
+								}, *request);
+							});
+							return;
+						}
+
+						if (!Network::Guard(*session, url, completion)) {
+							return;
+						}
+
+						std::apply([&](netimpl::components::Header& owned_headers, _Params&... owned_parameters) {
+							Network::MethodSchemaAsyncWithCallback<netimpl::components::Header&&, _Params&&...>::_method[static_cast<uint8_t>(http_method)](
+								std::move(session),
+								std::move(completion),
+								netimpl::components::Url { url },
+								std::move(owned_headers),
+								std::move(owned_parameters)...
+							);
+						}, *request);
+					}, request_parameters...);
+				}, *request);
 			}
 
 			/*
@@ -245,6 +563,854 @@ namespace liboai {
 			const std::string azure_root_ = ".openai.azure.com/openai";
 
 		private:
+			/*
+				@brief The keys under which a request may be answered
+					from the response cache, and coalesced with identical
+					requests in flight, where those are enabled. Streamed
+					requests and uploads are neither, and requests made
+					under a cancellation token or deadlines are not
+					coalesced.
+			*/
+			struct SharingKeys {
+				std::optional<ResponseCache::Key> cache, flight;
+			};
+
+			template <class... _Params>
+			static SharingKeys KeysOf(
+				const std::shared_ptr<ResponseCache>& cache,
+				const Method& http_method,
+				const std::string& url,
+				const netimpl::components::Header& headers,
+				const _Params&... parameters
+			) {
+				SharingKeys keys;
+				// a request made under a cancellation token or deadlines
+				// would fail the requests waiting on it along with
+				// itself, or wait on one that is not held to them
+				bool coalesce = SingleFlight::Enabled() && !CancellationToken::Current() && !DeadlineScope::Current();
+				if ((!cache && !coalesce) || http_method == Method::HTTP_DELETE) {
+					return keys;
+				}
+
+				RequestParts parts = Network::PartsOf(parameters...);
+				if (!parts.shareable) {
+					return keys;
+				}
+
+				std::string context;
+				if (parts.query) {
+					context.append(parts.query->BuildParameterString()).push_back('\n');
+				}
+				for (const auto& [name, value] : headers) {
+					context.append(name).append(": ").append(value).push_back('\n');
+				}
+
+				const char* method = http_method == Method::HTTP_GET ? "GET" : "POST";
+				if (cache) {
+					keys.cache = cache->KeyOf(method, url, parts.body, context);
+				}
+				if (coalesce) {
+					keys.flight = SingleFlight::KeyOf(method, url, parts.body, context);
+				}
+				return keys;
+			}
+
+			/*
+				@brief A request's standing with the rate limiter. Each
+					attempt at the request is drawn from the limiter
+					before it is sent and settled with the headers it
+					received, so that retries are charged as they go.
+			*/
+			class Charge final {
+				public:
+					Charge(std::shared_ptr<RateLimiter> limiter, RateLimiter::Cost cost) noexcept
+						: limiter_(std::move(limiter)), cost_(std::move(cost)) {}
+					NON_COPYABLE(Charge)
+					NON_MOVABLE(Charge)
+
+					/*
+						@brief Waits for the limiter to grant an attempt.
+							Throws should the request be cancelled or its
+							deadline pass while it waits.
+					*/
+					void Draw() {
+						std::optional<CancellationToken> token = CancellationToken::Current();
+						std::optional<DeadlineOptions> deadline = DeadlineScope::Current();
+						if (!this->limiter_->Acquire(this->cost_, token.value_or(CancellationToken()), deadline ? deadline->deadline : std::nullopt)) {
+							if (token && token->Cancelled()) {
+								throw liboai::exception::OpenAIException(
+									"Request cancelled",
+									liboai::exception::EType::E_CONNECTIONERROR,
+									"liboai::Network::Shared()"
+								);
+							}
+							netimpl::ErrorCheck(CURLE_OPERATION_TIMEDOUT, "liboai::Network::Shared()");
+						}
+						this->drawn_ = true;
+					}
+
+					/*
+						@brief Settles the attempt last drawn, if it has
+							not been already.
+					*/
+					void Settle(const netimpl::components::Header& received) noexcept {
+						if (this->drawn_) {
+							this->limiter_->Settle(this->cost_, received);
+							this->drawn_ = false;
+						}
+					}
+
+				private:
+					std::shared_ptr<RateLimiter> limiter_;
+					RateLimiter::Cost cost_;
+					bool drawn_ = false;
+			};
+
+			/*
+				@brief Asynchronous counterpart to Charge; attempts are
+					granted on the limiter's thread. Queued attempts do
+					not keep the limiter alive; should it go away, they
+					are sent at once.
+			*/
+			class AsyncCharge final : public std::enable_shared_from_this<AsyncCharge> {
+				public:
+					AsyncCharge(const std::shared_ptr<RateLimiter>& limiter, RateLimiter::Cost cost) noexcept
+						: limiter_(limiter), cost_(std::move(cost)) {}
+					NON_COPYABLE(AsyncCharge)
+					NON_MOVABLE(AsyncCharge)
+
+					/*
+						@brief Calls 'grant' once the limiter grants an
+							attempt, or 'expire' should 'until' pass first.
+					*/
+					void Draw(std::function<void()> grant, std::optional<std::chrono::steady_clock::time_point> until, std::function<void()> expire) {
+						std::shared_ptr<RateLimiter> limiter = this->limiter_.lock();
+						if (!limiter) {
+							grant();
+							return;
+						}
+
+						limiter->Schedule(this->cost_, [charge = this->shared_from_this(), grant = std::move(grant)]() {
+							charge->drawn_ = true;
+							grant();
+						}, until, std::move(expire));
+					}
+
+					/*
+						@brief Settles the attempt last drawn, if it has
+							not been already.
+					*/
+					void Settle(const netimpl::components::Header& received) noexcept {
+						if (this->drawn_.exchange(false)) {
+							if (std::shared_ptr<RateLimiter> limiter = this->limiter_.lock()) {
+								limiter->Settle(this->cost_, received);
+							}
+						}
+					}
+
+				private:
+					std::weak_ptr<RateLimiter> limiter_;
+					RateLimiter::Cost cost_;
+					std::atomic<bool> drawn_ = false;
+			};
+
+			/*
+				@brief Sends a request with 'send', unless it can be
+					answered from the response cache or by an identical
+					request already in flight.
+			*/
+			template <class _Send, class... _Params>
+			static Response Shared(
+				const Method& http_method,
+				const std::string& url,
+				const netimpl::components::Header& headers,
+				_Send&& send,
+				const _Params&... parameters
+			) {
+				std::shared_ptr<ResponseCache> cache = ResponseCache::Active();
+				SharingKeys keys = Network::KeysOf(cache, http_method, url, headers, parameters...);
+				if (keys.cache) {
+					if (std::optional<Response> hit = cache->Lookup(keys.cache.value())) {
+						return std::move(hit.value());
+					}
+				}
+
+				std::shared_ptr<SingleFlight::Flight> flight;
+				if (keys.flight) {
+					auto landed = std::make_shared<std::promise<Response>>();
+					FutureResponse future = landed->get_future();
+					flight = SingleFlight::Join(keys.flight.value(), [landed](FutureResponse response) {
+						try {
+							landed->set_value(response.get());
+						}
+						catch (...) {
+							landed->set_exception(std::current_exception());
+						}
+					});
+					if (!flight) {
+						return future.get();
+					}
+				}
+
+				// a request cancelled, or whose deadline passes, while it
+				// waits for the limiter gives up its place; no flight is
+				// joined under a token or deadlines. 'send' draws again
+				// for every attempt after the first.
+				std::shared_ptr<RateLimiter> limiter = RateLimiter::Active();
+				std::optional<RateLimiter::Cost> cost = Network::CostOf(limiter, headers, parameters...);
+				std::optional<Charge> charge;
+				if (cost) {
+					charge.emplace(std::move(limiter), std::move(cost.value()));
+					charge->Draw();
+				}
+
+				netimpl::components::Header received;
+				Response res;
+				try {
+					res = charge ? send(&charge.value(), &received) : send(nullptr, nullptr);
+				}
+				catch (...) {
+					if (charge) {
+						charge->Settle(received);
+					}
+					if (flight) {
+						flight->Land(std::current_exception());
+					}
+					throw;
+				}
+
+				if (charge) {
+					charge->Settle(received);
+				}
+				if (keys.cache) {
+					cache->Store(keys.cache.value(), res);
+				}
+				if (flight) {
+					flight->Land(res);
+				}
+				return res;
+			}
+
+			/*
+				@brief Asynchronous counterpart to Shared; 'send' hands
+					the completion it is given to the engine. With a rate
+					limiter in use, 'send' is also given the request's
+					charge, from which retries are drawn, and may be
+					called on the limiter's thread after this returns,
+					and so must own what it sends.
+			*/
+			template <class _Send, class... _Params>
+			static void SharedAsync(
+				netimpl::MultiEngine::Callback callback,
+				const Method& http_method,
+				const std::string& url,
+				const netimpl::components::Header& headers,
+				_Send&& send,
+				const _Params&... parameters
+			) {
+				std::shared_ptr<ResponseCache> cache = ResponseCache::Active();
+				SharingKeys keys = Network::KeysOf(cache, http_method, url, headers, parameters...);
+				if (keys.cache) {
+					if (std::optional<Response> hit = cache->Lookup(keys.cache.value())) {
+						std::promise<Response> ready;
+						ready.set_value(std::move(hit.value()));
+						callback(ready.get_future());
+						return;
+					}
+				}
+
+				// a waiter's callback is run when the flight lands
+				std::shared_ptr<SingleFlight::Flight> flight;
+				if (keys.flight) {
+					flight = SingleFlight::Join(keys.flight.value(), callback);
+					if (!flight) {
+						return;
+					}
+				}
+
+				if (keys.cache || flight) {
+					callback = [cache = std::move(cache), key = keys.cache, flight, callback = std::move(callback)](FutureResponse response) {
+						std::promise<Response> outcome;
+						try {
+							Response res = response.get();
+							if (key) {
+								cache->Store(key.value(), res);
+							}
+							if (flight) {
+								flight->Land(res);
+							}
+							outcome.set_value(std::move(res));
+						}
+						catch (...) {
+							if (flight) {
+								flight->Land(std::current_exception());
+							}
+							outcome.set_exception(std::current_exception());
+						}
+						callback(outcome.get_future());
+					};
+				}
+
+				std::shared_ptr<RateLimiter> limiter = RateLimiter::Active();
+				std::optional<RateLimiter::Cost> cost = Network::CostOf(limiter, headers, parameters...);
+				if (!cost) {
+					// should the request not be sent, the flight is dropped
+					// with the callback and fails its waiters
+					send(std::move(callback), nullptr, nullptr);
+					return;
+				}
+
+				auto received = std::make_shared<netimpl::components::Header>();
+				auto charge = std::make_shared<AsyncCharge>(limiter, std::move(cost.value()));
+				auto completion = std::make_shared<netimpl::MultiEngine::Callback>(std::move(callback));
+				auto settled = std::make_shared<netimpl::MultiEngine::Callback>(
+					[charge, received, completion](FutureResponse response) {
+						charge->Settle(*received);
+						(*completion)(std::move(response));
+					}
+				);
+
+				// a request whose deadline passes while it is queued was
+				// never granted, and so fails without being settled
+				std::optional<DeadlineOptions> deadline = DeadlineScope::Current();
+				auto expire = [completion]() {
+					std::promise<Response> failed;
+					try {
+						netimpl::ErrorCheck(CURLE_OPERATION_TIMEDOUT, "liboai::Network::SharedAsync()");
+					}
+					catch (...) {
+						failed.set_exception(std::current_exception());
+					}
+					(*completion)(failed.get_future());
+				};
+
+				charge->Draw([send = std::forward<_Send>(send), received, settled, charge]() mutable {
+					try {
+						send([settled](FutureResponse response) { (*settled)(std::move(response)); }, received.get(), charge);
+					}
+					catch (...) {
+						// the request never reached the engine; it may have
+						// been granted on the limiter's thread, so the
+						// error goes to the callback rather than a caller
+						std::promise<Response> failed;
+						failed.set_exception(std::current_exception());
+						(*settled)(failed.get_future());
+					}
+				}, deadline ? deadline->deadline : std::nullopt, std::move(expire));
+			}
+
+			/*
+				@brief Makes the first attempt at a request to 'url' with
+					'send', and retries it on the same session under the
+					retry policy, if one is set, for as long as the policy
+					allows, or until the request is cancelled or would
+					run past its deadline. The last failure is rethrown.
+					With a circuit breaker in use, each attempt must pass
+					its circuit, and no more are made once it is open.
+					Given a 'charge', each failed attempt is settled and
+					the next drawn from the rate limiter before it is
+					sent.
+			*/
+			template <class _Send>
+			static Response Retried(netimpl::Session& session, const std::string& url, Charge* charge, _Send&& send) {
+				std::shared_ptr<RetryPolicy> policy = RetryPolicy::Active();
+				std::shared_ptr<CircuitBreaker> breaker = CircuitBreaker::Active();
+				if (!policy && !breaker) {
+					return send();
+				}
+
+				const auto start = std::chrono::steady_clock::now();
+				std::chrono::milliseconds delay{};
+				for (uint32_t attempt = 1; ; ++attempt) {
+					std::optional<CircuitBreaker::Permit> permit;
+					if (breaker) {
+						permit = breaker->Admit(url);
+					}
+
+					try {
+						Response res = attempt == 1 ? send() : session.Resend();
+						if (permit) {
+							breaker->Report(permit.value(), CircuitBreaker::OutcomeOf(session));
+						}
+						return res;
+					}
+					catch (...) {
+						if (permit) {
+							breaker->Report(permit.value(), CircuitBreaker::OutcomeOf(session));
+						}
+
+						// a stream that has been partly delivered cannot be
+						// taken back and sent again, nor is a cancelled
+						// request
+						if (!policy || session.Delivered() || session.Cancelled()) {
+							throw;
+						}
+
+						RetryPolicy::Failure failure;
+						failure.attempt = attempt;
+						failure.status_code = session.StatusCode();
+						failure.result = session.Result();
+						failure.header = &session.ResponseHeader();
+						failure.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+						failure.last_delay = delay;
+
+						std::optional<std::chrono::milliseconds> next = policy->Delay(failure);
+						if (!next) {
+							throw;
+						}
+
+						// an attempt that could not start before the
+						// deadline is not made
+						std::optional<std::chrono::steady_clock::time_point> deadline = session.Deadline();
+						if (deadline && std::chrono::steady_clock::now() + next.value() >= deadline.value()) {
+							throw;
+						}
+						delay = next.value();
+					}
+
+					if (charge) {
+						charge->Settle(session.ResponseHeader());
+					}
+
+					// the wait ends early should the request be cancelled
+					const std::optional<CancellationToken>& token = session.Token();
+					if (!token) {
+						std::this_thread::sleep_for(delay);
+					}
+					else if (!token->Wait(std::chrono::steady_clock::now() + delay)) {
+						throw liboai::exception::OpenAIException(
+							"Request cancelled",
+							liboai::exception::EType::E_CONNECTIONERROR,
+							"liboai::Network::Retried()"
+						);
+					}
+
+					if (charge) {
+						charge->Draw();
+					}
+				}
+			}
+
+			/*
+				@brief An asynchronous request under a retry policy: the
+					session its attempts are sent on, which it keeps
+					until it is over, and how far it has got.
+			*/
+			struct AsyncRetry {
+				std::shared_ptr<RetryPolicy> policy;
+				std::shared_ptr<CircuitBreaker> breaker;
+				std::shared_ptr<AsyncCharge> charge;
+				netimpl::SessionPool::Lease session;
+				std::string url;
+				netimpl::MultiEngine::Callback completion;
+				std::chrono::steady_clock::time_point start;
+				std::chrono::milliseconds delay{};
+				uint32_t attempt = 1;
+			};
+
+			using AsyncLaunch = std::function<void(netimpl::Session&, netimpl::MultiEngine::Callback)>;
+
+			/*
+				@brief Asynchronous counterpart to Retried. Makes the
+					first attempt at a request to 'url' on 'session' with
+					'send', and sends it again on the engine under
+					'policy' as Retried would, each delay being waited out
+					on the policy's thread. 'completion' receives the
+					first success, or the last failure. With a circuit
+					breaker in use, each attempt must pass its circuit;
+					given a 'charge', each failed attempt is settled and
+					the next drawn from the rate limiter before it is
+					sent.
+			*/
+			template <class _Send>
+			static void RetriedAsync(
+				std::shared_ptr<RetryPolicy> policy,
+				netimpl::SessionPool::Lease session,
+				const std::string& url,
+				std::shared_ptr<AsyncCharge> charge,
+				netimpl::MultiEngine::Callback completion,
+				_Send&& send
+			) {
+				auto retry = std::make_shared<AsyncRetry>();
+				retry->policy = std::move(policy);
+				retry->breaker = CircuitBreaker::Active();
+				retry->charge = std::move(charge);
+				retry->session = std::move(session);
+				retry->url = url;
+				retry->completion = std::move(completion);
+				retry->start = std::chrono::steady_clock::now();
+
+				Network::Attempt(retry, std::forward<_Send>(send));
+			}
+
+			/*
+				@brief Sends an attempt at a retried request with
+					'launch', once it has passed its circuit.
+			*/
+			static void Attempt(const std::shared_ptr<AsyncRetry>& retry, const AsyncLaunch& launch) {
+				std::optional<CircuitBreaker::Permit> permit;
+				if (retry->breaker) {
+					try {
+						permit = retry->breaker->Admit(retry->url);
+					}
+					catch (...) {
+						Network::Abandon(retry, std::current_exception());
+						return;
+					}
+				}
+
+				netimpl::MultiEngine::Callback done = [retry, permit](FutureResponse response) {
+					Network::Attempted(retry, permit, std::move(response));
+				};
+
+				try {
+					launch(*retry->session, done);
+				}
+				catch (...) {
+					// the request could not be set up, and never reached
+					// the engine
+					std::promise<Response> failed;
+					failed.set_exception(std::current_exception());
+					done(failed.get_future());
+				}
+			}
+
+			/*
+				@brief Completes a retried request with its attempt's
+					outcome, or, should the attempt have failed and the
+					policy allow another, waits out the delay before
+					sending it again.
+			*/
+			static void Attempted(const std::shared_ptr<AsyncRetry>& retry, const std::optional<CircuitBreaker::Permit>& permit, FutureResponse response) {
+				netimpl::Session& session = *retry->session;
+				if (permit) {
+					retry->breaker->Report(permit.value(), CircuitBreaker::OutcomeOf(session));
+				}
+
+				std::promise<Response> outcome;
+				bool failed = false;
+				try {
+					outcome.set_value(response.get());
+				}
+				catch (...) {
+					outcome.set_exception(std::current_exception());
+					failed = true;
+				}
+
+				// a stream that has been partly delivered cannot be
+				// taken back and sent again, nor is a cancelled request
+				std::optional<std::chrono::milliseconds> next;
+				if (failed && !session.Delivered() && !session.Cancelled()) {
+					RetryPolicy::Failure failure;
+					failure.attempt = retry->attempt;
+					failure.status_code = session.StatusCode();
+					failure.result = session.Result();
+					failure.header = &session.ResponseHeader();
+					failure.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - retry->start);
+					failure.last_delay = retry->delay;
+					next = retry->policy->Delay(failure);
+
+					// an attempt that could not start before the deadline
+					// is not made
+					std::optional<std::chrono::steady_clock::time_point> deadline = session.Deadline();
+					if (next && deadline && std::chrono::steady_clock::now() + next.value() >= deadline.value()) {
+						next.reset();
+					}
+				}
+
+				if (!next) {
+					retry->completion(outcome.get_future());
+					return;
+				}
+
+				retry->delay = next.value();
+				++retry->attempt;
+				if (retry->charge) {
+					retry->charge->Settle(session.ResponseHeader());
+				}
+
+				// the wait ends early should the request be cancelled
+				retry->policy->Schedule(std::chrono::steady_clock::now() + retry->delay, [retry]() {
+					Network::Reattempt(retry);
+				}, session.Token());
+			}
+
+			/*
+				@brief Sends a retried request again once its delay is
+					over, drawing the attempt from the rate limiter
+					first if it is charged.
+			*/
+			static void Reattempt(const std::shared_ptr<AsyncRetry>& retry) {
+				netimpl::Session& session = *retry->session;
+				if (session.Cancelled()) {
+					Network::Abandon(retry, std::make_exception_ptr(liboai::exception::OpenAIException(
+						"Request cancelled",
+						liboai::exception::EType::E_CONNECTIONERROR,
+						"liboai::Network::RetriedAsync()"
+					)));
+					return;
+				}
+
+				AsyncLaunch resend = [](netimpl::Session& again, netimpl::MultiEngine::Callback done) {
+					netimpl::MultiEngine::Engine().Resend(again, std::move(done));
+				};
+				if (!retry->charge) {
+					Network::Attempt(retry, resend);
+					return;
+				}
+
+				// an attempt whose deadline passes while it is queued was
+				// never granted, and fails as having timed out
+				retry->charge->Draw([retry, resend]() { Network::Attempt(retry, resend); }, session.Deadline(), [retry]() {
+					try {
+						netimpl::ErrorCheck(CURLE_OPERATION_TIMEDOUT, "liboai::Network::RetriedAsync()");
+					}
+					catch (...) {
+						Network::Abandon(retry, std::current_exception());
+					}
+				});
+			}
+
+			/*
+				@brief Completes a retried request with 'error', without
+					another attempt.
+			*/
+			static void Abandon(const std::shared_ptr<AsyncRetry>& retry, std::exception_ptr error) {
+				std::promise<Response> failed;
+				failed.set_exception(std::move(error));
+				retry->completion(failed.get_future());
+			}
+
+			/*
+				@brief Whether a request is hedged under 'policy': one to
+					an endpoint the policy covers that is neither streamed
+					nor an upload.
+			*/
+			template <class... _Params>
+			static bool Hedges(
+				const std::shared_ptr<HedgePolicy>& policy,
+				const Method& http_method,
+				const std::string& url,
+				const _Params&... parameters
+			) {
+				if (!policy || http_method == Method::HTTP_DELETE || !policy->Covers(url)) {
+					return false;
+				}
+
+				return Network::PartsOf(parameters...).shareable;
+			}
+
+			/*
+				@brief Races attempts at a request under 'policy', each
+					sent on a session of its own with a copy of 'request';
+					see HedgePolicy::Race().
+			*/
+			template <class... _Params>
+			static void Hedged(
+				const std::shared_ptr<HedgePolicy>& policy,
+				netimpl::MultiEngine::Callback callback,
+				const Method& http_method,
+				const std::string& url,
+				std::shared_ptr<const std::tuple<netimpl::components::Header, _Params...>> request,
+				netimpl::components::Header* received
+			) {
+				// hedges are launched from the policy's thread
+				policy->Race(url, [http_method, url, request = std::move(request), caller = Caller{}](HedgePolicy::Completion completion) -> netimpl::Session* {
+					CallerScope scope(caller);
+
+					netimpl::SessionPool::Lease session = netimpl::SessionPool::Pool().Acquire(url);
+					netimpl::Session* attempt = session.get();
+					netimpl::MultiEngine::Callback finished = [attempt, completion = std::move(completion)](FutureResponse response) {
+						completion(std::move(response), *attempt);
+					};
+					if (!Network::Guard(*attempt, url, finished)) {
+						return nullptr;
+					}
+
+					std::tuple<netimpl::components::Header, _Params...> copy = *request;
+					std::apply([&](netimpl::components::Header& owned_headers, _Params&... owned_parameters) {
+						Network::MethodSchemaAsyncWithCallback<netimpl::components::Header&&, _Params&&...>::_method[static_cast<uint8_t>(http_method)](
+							std::move(session),
+							std::move(finished),
+							netimpl::components::Url { url },
+							std::move(owned_headers),
+							std::move(owned_parameters)...
+						);
+					}, copy);
+					return attempt;
+				}, std::move(callback), received);
+			}
+
+			/*
+				@brief Passes an asynchronous attempt at 'url' through
+					the circuit breaker, if one is in use, wrapping its
+					engine completion so that the attempt is reported to
+					the breaker once over; the session is still alive
+					while the completion runs. An attempt turned away is
+					completed at once with the breaker's exception, and
+					false is returned.
+			*/
+			static bool Guard(const netimpl::Session& session, const std::string& url, netimpl::MultiEngine::Callback& completion) {
+				std::shared_ptr<CircuitBreaker> breaker = CircuitBreaker::Active();
+				if (!breaker) {
+					return true;
+				}
+
+				CircuitBreaker::Permit permit;
+				try {
+					permit = breaker->Admit(url);
+				}
+				catch (...) {
+					std::promise<Response> rejected;
+					rejected.set_exception(std::current_exception());
+					completion(rejected.get_future());
+					return false;
+				}
+
+				completion = [&session, breaker = std::move(breaker), permit = std::move(permit), completion = std::move(completion)](FutureResponse response) {
+					breaker->Report(permit, CircuitBreaker::OutcomeOf(session));
+					completion(std::move(response));
+				};
+				return true;
+			}
+
+			/*
+				@brief What a request draws from the rate limiter, if
+					one is in use and the request is to a model.
+			*/
+			template <class... _Params>
+			static std::optional<RateLimiter::Cost> CostOf(
+				const std::shared_ptr<RateLimiter>& limiter,
+				const netimpl::components::Header& headers,
+				const _Params&... parameters
+			) {
+				if (!limiter) {
+					return std::nullopt;
+				}
+
+				return RateLimiter::CostOf(headers, Network::PartsOf(parameters...).body);
+			}
+
+			/*
+				@brief The cancellation token and deadlines in effect on
+					the thread that makes a request, to be made current
+					again with a CallerScope on the thread that sends
+					it.
+			*/
+			struct Caller {
+				std::optional<CancellationToken> token = CancellationToken::Current();
+				std::optional<DeadlineOptions> deadline = DeadlineScope::Current();
+			};
+
+			class CallerScope final {
+				public:
+					explicit CallerScope(const Caller& caller) noexcept {
+						if (caller.token) {
+							this->token_.emplace(caller.token.value());
+						}
+						if (caller.deadline) {
+							this->deadline_.emplace(caller.deadline.value());
+						}
+					}
+					NON_COPYABLE(CallerScope)
+					NON_MOVABLE(CallerScope)
+
+				private:
+					std::optional<CancellationScope> token_;
+					std::optional<DeadlineScope> deadline_;
+			};
+
+			/*
+				@brief Copies the headers of the response a session
+					received into 'received', if given, once the request
+					is over, whether or not it succeeded.
+			*/
+			class ReceivedHeaders final {
+				public:
+					ReceivedHeaders(const netimpl::Session& session, netimpl::components::Header* received) noexcept
+						: session_(session), received_(received) {}
+					NON_COPYABLE(ReceivedHeaders)
+					NON_MOVABLE(ReceivedHeaders)
+
+					~ReceivedHeaders() {
+						if (this->received_) {
+							try {
+								*this->received_ = this->session_.ResponseHeader();
+							}
+							catch (...) {
+								// the limiter then goes by its own count
+							}
+						}
+					}
+
+				private:
+					const netimpl::Session& session_;
+					netimpl::components::Header* received_;
+			};
+
+			/*
+				@brief Wraps an engine completion so that the headers
+					the session received are copied first; the session
+					is still alive while the completion runs.
+			*/
+			static netimpl::MultiEngine::Callback ReceiveHeaders(const netimpl::Session& session, netimpl::components::Header* received, netimpl::MultiEngine::Callback completion) {
+				return [&session, received, completion = std::move(completion)](FutureResponse response) {
+					{
+						ReceivedHeaders copy(session, received);
+					}
+					completion(std::move(response));
+				};
+			}
+
+			/*
+				@brief The parts of a request that tell it apart from
+					others, pointing into its parameters: its body and
+					query, and whether it may be shared or sent twice at
+					all, which streamed requests and uploads may not.
+			*/
+			struct RequestParts {
+				std::string_view body;
+				const netimpl::components::Parameters* query = nullptr;
+				bool shareable = true;
+			};
+
+			template <class... _Params>
+			static RequestParts PartsOf(const _Params&... parameters) {
+				RequestParts parts;
+				(Network::AddPart(parts, parameters), ...);
+				return parts;
+			}
+
+			static void AddPart(RequestParts& parts, const netimpl::components::Body& part) {
+				parts.body = part.str();
+			}
+
+			static void AddPart(RequestParts& parts, const netimpl::components::Parameters& part) {
+				parts.query = &part;
+			}
+
+			static void AddPart(RequestParts& parts, const netimpl::components::WriteCallback& part) {
+				parts.shareable = parts.shareable && !part.callback;
+			}
+
+			static void AddPart(RequestParts& parts, const netimpl::components::Multipart&) {
+				parts.shareable = false;
+			}
+
+			template <class _Ty>
+			static void AddPart(RequestParts&, const _Ty&) {}
+
+			static inline netimpl::MultiEngine::Callback DownloadCompletion(std::shared_ptr<std::promise<bool>> result) {
+				return [result = std::move(result)](FutureResponse res) {
+					try {
+						result->set_value(res.get().status_code == 200);
+					}
+					catch (...) {
+						result->set_exception(std::current_exception());
+					}
+				};
+			}
+
 			template <class... T> struct MethodSchema {
 				inline static std::function<Response(netimpl::components::Url&&, T...)> _method[3] = {
 					netimpl::Get    <netimpl::components::Url&&, T...>,
@@ -260,5 +1426,29 @@ namespace liboai {
 					netimpl::DeleteWithSession <netimpl::components::Url&&, T...>
 				};
 			};
+
+			template <class... T> struct MethodSchemaAsync {
+				inline static std::function<FutureResponse(netimpl::SessionPool::Lease, netimpl::components::Url&&, T...)> _method[3] = {
+					netimpl::GetAsync    <netimpl::components::Url&&, T...>,
+					netimpl::PostAsync   <netimpl::components::Url&&, T...>,
+					netimpl::DeleteAsync <netimpl::components::Url&&, T...>
+				};
+			};
+
+			template <class... T> struct MethodSchemaAsyncWithSession {
+				inline static std::function<void(netimpl::Session&, netimpl::MultiEngine::Callback, netimpl::components::Url&&, T...)> _method[3] = {
+					netimpl::GetAsyncWithSession    <netimpl::components::Url&&, T...>,
+					netimpl::PostAsyncWithSession   <netimpl::components::Url&&, T...>,
+					netimpl::DeleteAsyncWithSession <netimpl::components::Url&&, T...>
+				};
+			};
+
+			template <class... T> struct MethodSchemaAsyncWithCallback {
+				inline static std::function<void(netimpl::SessionPool::Lease, netimpl::MultiEngine::Callback, netimpl::components::Url&&, T...)> _method[3] = {
+					netimpl::GetAsyncWithCallback    <netimpl::components::Url&&, T...>,
+					netimpl::PostAsyncWithCallback   <netimpl::components::Url&&, T...>,
+					netimpl::DeleteAsyncWithCallback <netimpl::components::Url&&, T...>
+				};
+			};
 	};
 }
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+/*
+	parser.h : liboai JSON parsing backend.
+		This header file provides declarations for the JSON parser
+		that liboai uses to read response bodies, streamed chunks
+		and typed results.
+
+		By default nlohmann_json parses everything. When liboai is
+		configured with -DLIBOAI_SIMDJSON=ON, simdjson's On-Demand
+		parser is used instead; documents are still handed back as
+		nlohmann::json values or SAX events, so the choice of
+		backend does not change any public type.
+*/
+
+#include <string>
+#include <string_view>
+#include "response.h"
+
+namespace liboai {
+	class JsonParser final {
+		public:
+			/*
+				@brief The name of the backend liboai was built with,
+					either "nlohmann_json" or "simdjson".
+			*/
+			LIBOAI_EXPORT static const char* Backend() noexcept;
+
+			/*
+				@brief Parses a JSON document.
+
+				@param json      The document to parse.
+				@param throwing  Whether to throw on a malformed document
+				                 rather than return a discarded value.
+
+				@throws liboai::exception::OpenAIException with
+					E_FAILURETOPARSE if throwing and the document is
+					malformed.
+			*/
+			LIBOAI_EXPORT static nlohmann::json Parse(std::string_view json, bool throwing = true) noexcept(false);
+
+			/*
+				@brief Parses a JSON document, reporting each value to
+					handler as it is encountered. Returns false if the
+					document is malformed or handler stopped the parse,
+					in which case error holds a description when one
+					is available.
+			*/
+			LIBOAI_EXPORT static bool Sax(std::string_view json, nlohmann::json_sax<nlohmann::json>& handler, std::string& error);
+	};
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+/*
+	rate_limiter.h : liboai client-side rate limiter implementation.
+		This header file provides declarations for the opt-in limiter
+		that liboai::Network applies before sending a request, once
+		one has been set with liboai::Network::SetRateLimiter(), so
+		that requests are held back on our side instead of being
+		rejected with 429 Too Many Requests.
+
+		Each API key, organization and model has a bucket of requests
+		and a bucket of tokens per minute, which refill continuously.
+		Every response resynchronizes its buckets from the
+		x-ratelimit-limit-*, x-ratelimit-remaining-* and
+		x-ratelimit-reset-* headers the API returns. A request that
+		its buckets cannot afford waits its turn; requests are granted
+		in the order they were made.
+*/
+
+#include <functional>
+#include "netimpl.h"
+
+namespace liboai {
+	/*
+		@brief Limits liboai::RateLimiter assumes for a model before
+			any response has reported the actual ones; zero leaves that
+			limit unenforced until then.
+	*/
+	struct RateLimiterOptions {
+		uint32_t requests_per_minute = 0;
+		uint32_t tokens_per_minute = 0;
+	};
+
+	class RateLimiter final {
+		public:
+			/*
+				@brief What a request draws from its buckets.
+			*/
+			struct Cost {
+				std::string bucket;  // a hash of the credentials, and the model
+				uint64_t tokens = 0; // estimated prompt tokens plus the most that may be generated
+			};
+
+			struct Stats {
+				uint64_t granted = 0, queued = 0; // queued counts the requests that had to wait
+			};
+
+			LIBOAI_EXPORT explicit RateLimiter(RateLimiterOptions options = {}) noexcept;
+			NON_COPYABLE(RateLimiter)
+			NON_MOVABLE(RateLimiter)
+
+			/*
+				@brief Stops the limiter's thread; requests still queued
+					are granted at once rather than left waiting.
+			*/
+			LIBOAI_EXPORT ~RateLimiter();
+
+			/*
+				@brief The cost of a request, or nullopt if it names no
+					model and so is not limited.
+
+				@param headers   The request headers, which carry the
+				                 credentials.
+				@param body      The JSON request body.
+			*/
+			LIBOAI_EXPORT static std::optional<Cost> CostOf(const netimpl::components::Header& headers, std::string_view body);
+
+			/*
+				@brief Blocks until the request's buckets can afford it,
+					and draws its cost from them.
+			*/
+			LIBOAI_EXPORT void Acquire(const Cost& cost);
+
+			/*
+				@brief As above, but gives up the request's place in the
+					queue should 'token' be cancelled or 'until' pass
+					first.
+
+				@returns False if the request gave up its place rather
+					than being granted.
+			*/
+			[[nodiscard]] LIBOAI_EXPORT bool Acquire(
+				const Cost& cost,
+				const CancellationToken& token,
+				std::optional<std::chrono::steady_clock::time_point> until = std::nullopt
+			);
+
+			/*
+				@brief Calls 'grant' once the request's buckets can afford
+					it: on the calling thread if they can right away and
+					no request is queued ahead of it, and otherwise later
+					on the limiter's own thread, which 'grant' must not
+					block. Should 'until' pass while the request is still
+					queued, it leaves the queue and 'expire' is called on
+					that thread instead.
+			*/
+			LIBOAI_EXPORT void Schedule(
+				const Cost& cost,
+				std::function<void()> grant,
+				std::optional<std::chrono::steady_clock::time_point> until = std::nullopt,
+				std::function<void()> expire = {}
+			);
+
+			/*
+				@brief Reports that a granted request is over, with the
+					headers of its response; these are empty if it failed
+					before one was received.
+			*/
+			LIBOAI_EXPORT void Settle(const Cost& cost, const netimpl::components::Header& received) noexcept;
+
+			LIBOAI_EXPORT Stats GetStats() const noexcept;
+
+			/*
+				@brief The limiter that liboai::Network applies, if any;
+					see liboai::Network::SetRateLimiter().
+			*/
+			LIBOAI_EXPORT static void SetActive(std::shared_ptr<RateLimiter> limiter) noexcept;
+			LIBOAI_EXPORT static std::shared_ptr<RateLimiter> Active() noexcept;
+
+		private:
+			struct State;
+
+			// shared with the limiter's thread, which may outlive it
+			std::shared_ptr<State> state_;
+	};
+}
@@ -26,7 +26,13 @@
 
 #include <iostream>
 #include <optional>
+#include <vector>
+#include <string_view>
+#include <charconv>
+#include <functional>
 #include <future>
+#include <mutex>
+#include <atomic>
 #include <nlohmann/json.hpp>
 #include "exception.h"
 
@@ -35,43 +41,167 @@ namespace liboai {
 	template <typename T> struct has_value_type<T, std::void_t<typename T::value_type>> : std::true_type {};
 	template <typename T> inline constexpr const bool has_value_type_v = has_value_type<T>::value;
 
+	template <typename T, typename = void> struct is_iterable : std::false_type {};
+	template <typename T> struct is_iterable<T, std::void_t<decltype(std::begin(std::declval<const T&>())), decltype(std::end(std::declval<const T&>()))>> : std::true_type {};
+
+	template <typename T> struct is_optional : std::false_type {};
+	template <typename T> struct is_optional<std::optional<T>> : std::true_type {};
+
+	template <typename T, typename = void> struct is_pair : std::false_type {};
+	template <typename T> struct is_pair<T, std::void_t<typename T::first_type, typename T::second_type>> : std::true_type {};
+
+	/*
+		Writes a request body as compact JSON, member by member,
+			straight into a string - no DOM is built along the way.
+			Values are serialized as they are pushed, so the body
+			is complete as soon as the last member is written.
+	*/
 	class JsonConstructor final {
 		public:
-			JsonConstructor() {}
-			JsonConstructor(const JsonConstructor& other) noexcept : _json(other._json) {}
-			JsonConstructor(JsonConstructor&& old) noexcept : _json(std::move(old._json)) {}
+			JsonConstructor() { this->_buffer.reserve(256); this->_buffer.push_back('{'); }
+			JsonConstructor(const JsonConstructor& other) : _buffer(other._buffer) {}
+			JsonConstructor(JsonConstructor&& old) noexcept : _buffer(std::move(old._buffer)) { old._buffer = "{"; }
 
 			template <class _Ty>
 			void push_back(std::string_view key, const _Ty& value) {
 				if constexpr (std::is_same_v<_Ty, std::optional<std::function<bool(std::string, intptr_t)>>>) {
 					if (value) {
-						this->_json[key.data()] = true;
+						this->key(key);
+						this->_buffer += "true";
 					}
 				}
 				else if constexpr (std::is_same_v<_Ty, std::function<bool(std::string, intptr_t)>>) {
 					if (value) {
-						this->_json[key.data()] = true;
+						this->key(key);
+						this->_buffer += "true";
 					}
 				}
 				else {
-					this->_json[key.data()] = value;
+					this->key(key);
+					this->write(value);
 				}
 			}
-			
+
 			template <class _Ty,
 				std::enable_if_t<std::conjunction_v<has_value_type<_Ty>, std::is_same<_Ty, std::optional<typename _Ty::value_type>>>, int> = 0>
 			void push_back(std::string_view key, _Ty&& value) {
 				if (value) {
-					this->_json[key.data()] = std::forward<typename _Ty::value_type>(value.value());
+					this->key(key);
+					this->write(value.value());
 				}
 			}
 
+			/*
+				@brief Adds a member whose value is already serialized
+					JSON, such as a cached message history.
+			*/
+			void push_back_raw(std::string_view key, std::string_view json) {
+				this->key(key);
+				this->_buffer += json;
+			}
+
+			/*
+				@brief Returns the serialized object, closed; the
+					constructor itself is left as it was.
+			*/
 			std::string dump() const {
-				return this->_json.dump(4);
+				std::string out;
+				out.reserve(this->_buffer.size() + 1);
+				out += this->_buffer;
+				out.push_back('}');
+				return out;
+			}
+
+			/*
+				@brief As dump(), but hands over the serialized body
+					without copying it; the constructor is left empty
+					afterwards.
+			*/
+			std::string release() {
+				std::string out = std::move(this->_buffer);
+				out.push_back('}');
+				this->_buffer = "{";
+				return out;
 			}
 
+			/*
+				@brief Appends a JSON string literal, quoted and escaped.
+			*/
+			LIBOAI_EXPORT static void write_string(std::string& out, std::string_view value);
+
 		private:
-			nlohmann::json _json;
+			void key(std::string_view key) {
+				if (this->_buffer.size() > 1) {
+					this->_buffer.push_back(',');
+				}
+				write_string(this->_buffer, key);
+				this->_buffer.push_back(':');
+			}
+
+			LIBOAI_EXPORT void write_number(double value);
+			LIBOAI_EXPORT void write_number(float value);
+
+			template <class _Ty>
+			void write(const _Ty& value) {
+				if constexpr (std::is_same_v<_Ty, nlohmann::json>) {
+					this->_buffer += value.dump();
+				}
+				else if constexpr (std::is_convertible_v<const _Ty&, std::string_view>) {
+					write_string(this->_buffer, value);
+				}
+				else if constexpr (std::is_same_v<_Ty, bool>) {
+					this->_buffer += value ? "true" : "false";
+				}
+				else if constexpr (std::is_integral_v<_Ty>) {
+					char digits[24];
+					auto result = std::to_chars(digits, digits + sizeof(digits), static_cast<std::conditional_t<std::is_signed_v<_Ty>, long long, unsigned long long>>(value));
+					this->_buffer.append(digits, result.ptr);
+				}
+				else if constexpr (std::is_floating_point_v<_Ty>) {
+					this->write_number(value);
+				}
+				else if constexpr (is_optional<_Ty>::value) {
+					if (value) {
+						this->write(value.value());
+					}
+					else {
+						this->_buffer += "null";
+					}
+				}
+				else if constexpr (is_iterable<_Ty>::value && is_pair<typename _Ty::value_type>::value) {
+					// maps become objects keyed by their (string) keys
+					this->_buffer.push_back('{');
+					bool first = true;
+					for (const auto& [k, v] : value) {
+						if (!first) {
+							this->_buffer.push_back(',');
+						}
+						first = false;
+						write_string(this->_buffer, k);
+						this->_buffer.push_back(':');
+						this->write(v);
+					}
+					this->_buffer.push_back('}');
+				}
+				else if constexpr (is_iterable<_Ty>::value) {
+					this->_buffer.push_back('[');
+					bool first = true;
+					for (const auto& element : value) {
+						if (!first) {
+							this->_buffer.push_back(',');
+						}
+						first = false;
+						this->write(element);
+					}
+					this->_buffer.push_back(']');
+				}
+				else {
+					// anything else goes through nlohmann's own conversions
+					this->_buffer += nlohmann::json(value).dump();
+				}
+			}
+
+			std::string _buffer;
 	};
 
 	class Response final {
@@ -96,9 +226,54 @@ namespace liboai {
 					access the Response object as if it were a json object.
 			*/
 			template <class _Ty>
-			nlohmann::json::const_reference operator[](const _Ty& key) const noexcept {
-				return this->raw_json[key];
+			nlohmann::json::const_reference operator[](const _Ty& key) const noexcept(false) {
+				return this->GetJSON()[key];
 			}
+
+			/*
+				@brief Returns the parsed JSON body, parsing it first if
+					lazy parsing is enabled and it has not been accessed
+					yet. The first parse is made once, however many
+					threads ask for it; a body that fails to parse
+					throws E_FAILURETOPARSE, as it would have on
+					construction.
+			*/
+			LIBOAI_EXPORT const nlohmann::json& GetJSON() const noexcept(false);
+
+			/*
+				@brief Reads the body into a typed result, such as
+					liboai::ChatCompletionResult, with a streaming parse
+					of content; no JSON DOM is built. Pairs well with lazy
+					parsing, see SetLazyParsing().
+			*/
+			template <class _Ty>
+			_Ty As() const noexcept(false) {
+				if (this->content.empty() && !this->GetJSON().is_null()) {
+					return _Ty::Parse(this->GetJSON().dump()); // content was released
+				}
+				return _Ty::Parse(this->content);
+			}
+
+			/*
+				@brief Enables or disables lazy parsing process-wide. When
+					enabled, successful responses are not parsed until
+					their JSON is first accessed through GetJSON() or
+					operator[]; error responses are still parsed up front
+					to extract the error message. Disabled by default, in
+					which case the body is always parsed on construction.
+			*/
+			LIBOAI_EXPORT static void SetLazyParsing(bool lazy) noexcept;
+			LIBOAI_EXPORT static bool LazyParsing() noexcept;
+
+			/*
+				@brief When enabled, content is released once the body
+					has been parsed on construction, so the response does
+					not hold the body twice. A body parsed lazily keeps
+					its content, which other threads may be reading.
+					Disabled by default.
+			*/
+			LIBOAI_EXPORT static void SetReleaseContent(bool release) noexcept;
+			LIBOAI_EXPORT static bool ReleaseContent() noexcept;
 			
 			/*
 				@brief std::ostream operator<< overload to allow for
@@ -109,9 +284,17 @@ namespace liboai {
 		public:
 			long status_code = 0; double elapsed = 0.0;
 			std::string status_line{}, content{}, url{}, reason{};
-			nlohmann::json raw_json{};
+			mutable nlohmann::json raw_json{}; // not yet populated in lazy mode, see GetJSON()
 
 		private:
+			/*
+				@brief Parses content into raw_json.
+			*/
+			void Parse() const noexcept(false);
+
+			mutable std::atomic<bool> parsed_{ true };
+			mutable std::mutex parse_mutex_; // held for the first parse, and while copying an unparsed body
+
 			/*
 				@brief Used internally during construction to check the response
 					for errors and throw exceptions if necessary.
@@ -0,0 +1,178 @@
+#pragma once
+
+/*
+	response_cache.h : liboai response cache implementation.
+		This header file provides declarations for the opt-in cache
+		of API responses that liboai::Network consults before sending
+		a request, once one has been set with
+		liboai::Network::SetResponseCache().
+
+		Responses are keyed by a hash of the method, URL, headers and
+		the request body in canonical form (parsed and re-serialized,
+		so member order and whitespace do not matter), and are kept
+		in a byte-budgeted LRU in memory and, optionally, in a second
+		budgeted LRU of files on disk. A hit is returned as a
+		liboai::Response without touching the network.
+
+		Only successful responses are cached. Streamed requests,
+		uploads and requests whose results are sampled (see
+		ResponseCacheOptions::deterministic_only) always go to the network.
+*/
+
+#include <filesystem>
+#include <chrono>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <memory>
+#include "response.h"
+
+namespace liboai {
+	/*
+		@brief Controls what liboai::ResponseCache keeps, where, and
+			for how long.
+	*/
+	struct ResponseCacheOptions {
+		size_t memory_bytes = 64 << 20; // budget of the memory tier
+
+		/*
+			A directory for the disk tier, created if need be;
+			without one, responses are only kept in memory.
+			Responses cached there survive restarts.
+		*/
+		std::optional<std::filesystem::path> directory;
+		uint64_t disk_bytes = 1ull << 30;
+
+		// how long a response stays valid; zero keeps it until evicted
+		std::chrono::seconds ttl = std::chrono::hours(24);
+
+		// URL suffixes of the endpoints whose responses are cached
+		std::vector<std::string> endpoints = { "/chat/completions", "/completions", "/moderations", "/embeddings" };
+
+		/*
+			Only cache requests that are answered the same way
+			each time: those with a temperature of 0, and those
+			to endpoints that do not sample (anything but
+			completions) which set no temperature.
+		*/
+		bool deterministic_only = true;
+	};
+
+	class ResponseCache final {
+		public:
+			struct Stats {
+				uint64_t memory_hits = 0, disk_hits = 0, misses = 0;
+				uint64_t memory_entries = 0, memory_bytes = 0;
+				uint64_t disk_entries = 0, disk_bytes = 0;
+			};
+
+			struct Key {
+				uint64_t hash[2];
+				bool operator==(const Key& other) const noexcept { return this->hash[0] == other.hash[0] && this->hash[1] == other.hash[1]; }
+			};
+
+			/*
+				@throws liboai::exception::OpenAIException with
+					E_FILEERROR if the disk tier's directory cannot be
+					created.
+			*/
+			LIBOAI_EXPORT explicit ResponseCache(ResponseCacheOptions options = {}) noexcept(false);
+			NON_COPYABLE(ResponseCache)
+			NON_MOVABLE(ResponseCache)
+			~ResponseCache() = default;
+
+			/*
+				@brief The key of a request, or nullopt if it is not to
+					be cached under this cache's options.
+
+				@param method    "GET" or "POST"; other methods are not cached.
+				@param url       The full URL, without query parameters.
+				@param body      The JSON request body, if any.
+				@param context   Anything else the response depends on,
+				                 such as headers and query parameters.
+			*/
+			LIBOAI_EXPORT std::optional<Key> KeyOf(std::string_view method, std::string_view url, std::string_view body, std::string_view context) const;
+
+			/*
+				@brief As above, but under the given rules rather than
+					this cache's options.
+
+				@param endpoints            URL suffixes to accept, or
+				                            nullptr to accept any URL.
+				@param deterministic_only   See ResponseCacheOptions.
+			*/
+			LIBOAI_EXPORT static std::optional<Key> KeyOf(
+				std::string_view method,
+				std::string_view url,
+				std::string_view body,
+				std::string_view context,
+				const std::vector<std::string>* endpoints,
+				bool deterministic_only
+			);
+
+			/*
+				@brief The cached response for a key, if there is one
+					that has not expired.
+			*/
+			LIBOAI_EXPORT std::optional<liboai::Response> Lookup(const Key& key);
+
+			/*
+				@brief Caches a response, if it is a successful one.
+					Failure to write the disk tier is not reported; the
+					response is then only cached in memory.
+			*/
+			LIBOAI_EXPORT void Store(const Key& key, const liboai::Response& response) noexcept;
+
+			/*
+				@brief Drops every cached response, including those on
+					disk.
+			*/
+			LIBOAI_EXPORT void Clear() noexcept;
+
+			LIBOAI_EXPORT Stats GetStats() const noexcept;
+
+			/*
+				@brief The cache that liboai::Network consults, if any;
+					see liboai::Network::SetResponseCache().
+			*/
+			LIBOAI_EXPORT static void SetActive(std::shared_ptr<ResponseCache> cache) noexcept;
+			LIBOAI_EXPORT static std::shared_ptr<ResponseCache> Active() noexcept;
+
+		private:
+			struct KeyHash {
+				size_t operator()(const Key& key) const noexcept { return static_cast<size_t>(key.hash[0]); }
+			};
+
+			struct Entry {
+				Key key;
+				std::string url, status_line, reason, content;
+				long status_code = 0;
+				int64_t expires = 0; // seconds since the epoch, 0 for never
+				size_t bytes = 0;
+			};
+
+			struct DiskEntry {
+				Key key;
+				uint64_t bytes = 0;
+			};
+
+			std::filesystem::path PathOf(const Key& key) const;
+			void Remember(Entry entry);
+			bool ReadDisk(const Key& key, Entry& entry) const;
+			bool WriteDisk(const Entry& entry) const;
+			void Scan();
+
+			ResponseCacheOptions options_;
+
+			mutable std::mutex mutex_;
+			std::list<Entry> memory_;  // most recently used first
+			std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> memory_index_;
+			size_t memory_bytes_ = 0;
+
+			std::list<DiskEntry> disk_;
+			std::unordered_map<Key, std::list<DiskEntry>::iterator, KeyHash> disk_index_;
+			uint64_t disk_bytes_ = 0;
+
+			Stats stats_;
+	};
+}
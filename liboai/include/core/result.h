@@ -0,0 +1,104 @@
+#pragma once
+
+/*
+	result.h : liboai typed result implementation.
+		This header file provides declarations for the streaming
+		(SAX) reader that typed result objects, such as
+		liboai::ChatCompletionResult, use to fill themselves
+		directly from a response body.
+
+		Unlike liboai::Response::GetJSON(), no nlohmann::json DOM
+		is built along the way; each value is handed to the reader
+		as it is parsed along with its location in the document,
+		and the reader stores only what its result type needs.
+*/
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <initializer_list>
+#include "response.h"
+#include "parser.h"
+
+namespace liboai {
+	/*
+		@brief Token usage reported with chat and embedding results.
+	*/
+	struct Usage {
+		uint32_t prompt_tokens = 0;
+		uint32_t completion_tokens = 0;
+		uint32_t total_tokens = 0;
+	};
+
+	class SaxReader : public nlohmann::json_sax<nlohmann::json> {
+		public:
+			SaxReader() = default;
+			~SaxReader() override = default;
+
+			/*
+				@brief Parses a JSON document, reporting each value
+					to the reader as it is encountered.
+
+				@throws liboai::exception::OpenAIException with
+					E_FAILURETOPARSE if the document is malformed.
+			*/
+			LIBOAI_EXPORT void Parse(std::string_view json) noexcept(false);
+
+			bool null() final;
+			bool boolean(bool value) final;
+			bool number_integer(number_integer_t value) final;
+			bool number_unsigned(number_unsigned_t value) final;
+			bool number_float(number_float_t value, const string_t& text) final;
+			bool string(string_t& value) final;
+			bool binary(binary_t& value) final;
+			bool start_object(std::size_t elements) final;
+			bool key(string_t& value) final;
+			bool end_object() final;
+			bool start_array(std::size_t elements) final;
+			bool end_array() final;
+			bool parse_error(std::size_t position, const std::string& last_token, const nlohmann::detail::exception& ex) final;
+
+		protected:
+			/*
+				Hooks for derived readers. At the time each is called,
+				At() and Key() describe the location of the value -
+				for OnEnter/OnLeave, that of the container itself.
+			*/
+			virtual void OnEnter(bool /*array*/) {}
+			virtual void OnLeave(bool /*array*/) {}
+			virtual void OnString(std::string& /*value*/) {}
+			virtual void OnNumber(double /*value*/) {}
+			virtual void OnBoolean(bool /*value*/) {}
+
+			/*
+				@brief Whether the current location matches a path of
+					member names, where "#" matches any array element
+					and "*" matches any member name.
+			*/
+			LIBOAI_EXPORT bool At(std::initializer_list<std::string_view> path) const noexcept;
+
+			/*
+				@brief The member name of the current location, or an
+					empty string if it is an array element.
+			*/
+			std::string_view Key() const noexcept;
+
+			size_t Depth() const noexcept { return this->stack_.size(); }
+
+			/*
+				@brief Stores the value if the current location is a
+					field of a top-level "usage" object.
+			*/
+			bool ReadUsage(Usage& usage, double value) const noexcept;
+
+		private:
+			struct Frame {
+				bool array = false;
+				std::string key;   // current member, for objects
+			};
+
+			std::vector<Frame> stack_;
+			std::string error_;
+	};
+}
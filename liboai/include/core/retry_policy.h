@@ -0,0 +1,129 @@
+#pragma once
+
+/*
+	retry_policy.h : liboai retry policy implementation.
+		This header file provides declarations for the opt-in policy
+		under which liboai::Network retries failed requests, once
+		one has been set with liboai::Network::SetRetryPolicy().
+
+		A failed attempt is retried if a rule covers its status code
+		(such as 429 or 503) or, if no response was received, the
+		cURL error it failed with, and the rule's attempts are not
+		used up. Attempts are spaced by exponential backoff with
+		decorrelated jitter, or by the delay a Retry-After header asks
+		for, and stop once the policy's time budget would be exceeded.
+
+		A retry sends the same request again on the same session; the
+		body is not rebuilt. Streamed requests are not retried once
+		any of the response has been handed to their callback. The
+		delays of asynchronous requests are waited out on the
+		policy's thread rather than on one of their own.
+*/
+
+#include <map>
+#include <memory>
+#include <chrono>
+#include <functional>
+#include "netimpl.h"
+
+namespace liboai {
+	/*
+		@brief How a kind of failure is retried.
+	*/
+	struct RetryRule {
+		uint32_t max_attempts = 4; // in all, including the first
+		std::chrono::milliseconds base_delay = std::chrono::milliseconds(500); // the shortest wait, from which backoff grows
+	};
+
+	/*
+		@brief Controls which failures liboai::RetryPolicy retries,
+			and how long it keeps at it.
+	*/
+	struct RetryPolicyOptions {
+		// rules by response status code
+		std::map<long, RetryRule> statuses = {
+			{ 408, {} }, { 409, {} }, { 429, {} },
+			{ 500, {} }, { 502, {} }, { 503, {} }, { 504, {} }
+		};
+
+		// rules by cURL error, for attempts that received no response
+		std::map<CURLcode, RetryRule> curl_errors = {
+			{ CURLE_COULDNT_CONNECT, {} }, { CURLE_OPERATION_TIMEDOUT, {} },
+			{ CURLE_SEND_ERROR, {} }, { CURLE_RECV_ERROR, {} },
+			{ CURLE_GOT_NOTHING, {} }, { CURLE_PARTIAL_FILE, {} },
+			{ CURLE_HTTP2, {} }, { CURLE_HTTP2_STREAM, {} },
+			{ CURLE_SSL_CONNECT_ERROR, {} }
+		};
+
+		std::chrono::milliseconds max_delay = std::chrono::seconds(30);    // the longest backoff between attempts
+		std::chrono::milliseconds max_elapsed = std::chrono::minutes(2);   // no attempt starts later than this after the first
+
+		/*
+			Wait as long as a Retry-After or retry-after-ms header
+			asks, in place of backoff, as long as it is within
+			max_elapsed.
+		*/
+		bool honor_retry_after = true;
+	};
+
+	class RetryPolicy final {
+		public:
+			/*
+				@brief A failed attempt, as RetryPolicy::Delay() weighs it.
+			*/
+			struct Failure {
+				uint32_t attempt = 1;                     // the number of the attempt that failed, from 1
+				long status_code = 0;                     // 0 if no response was received
+				CURLcode result = CURLE_OK;
+				const netimpl::components::Header* header = nullptr; // of the response, if any
+				std::chrono::milliseconds elapsed{};      // since the first attempt started
+				std::chrono::milliseconds last_delay{};   // the delay before this attempt, 0 for the first
+			};
+
+			LIBOAI_EXPORT explicit RetryPolicy(RetryPolicyOptions options = {}) noexcept;
+			NON_COPYABLE(RetryPolicy)
+			NON_MOVABLE(RetryPolicy)
+
+			/*
+				@brief Stops the policy's thread; waits not yet over
+					are dropped.
+			*/
+			LIBOAI_EXPORT ~RetryPolicy();
+
+			/*
+				@brief How long to wait before the next attempt, or
+					nullopt if the failure is not to be retried.
+			*/
+			LIBOAI_EXPORT std::optional<std::chrono::milliseconds> Delay(const Failure& failure) const;
+
+			/*
+				@brief Calls 'fire' on the policy's thread once 'at' has
+					come, or within milliseconds of 'token' being
+					cancelled if that is sooner; 'fire' then checks which
+					it was. Used to wait out the delay before an
+					asynchronous request is sent again.
+			*/
+			LIBOAI_EXPORT void Schedule(
+				std::chrono::steady_clock::time_point at,
+				std::function<void()> fire,
+				std::optional<CancellationToken> token = std::nullopt
+			);
+
+			const RetryPolicyOptions& Options() const noexcept { return this->options_; }
+
+			/*
+				@brief The policy that liboai::Network retries under, if
+					any; see liboai::Network::SetRetryPolicy().
+			*/
+			LIBOAI_EXPORT static void SetActive(std::shared_ptr<RetryPolicy> policy) noexcept;
+			LIBOAI_EXPORT static std::shared_ptr<RetryPolicy> Active() noexcept;
+
+		private:
+			struct Timers;
+
+			RetryPolicyOptions options_;
+
+			// shared with the policy's thread, which may outlive it
+			std::shared_ptr<Timers> timers_;
+	};
+}
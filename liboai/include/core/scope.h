@@ -0,0 +1,25 @@
+#pragma once
+
+/*
+	scope.h : liboai thread scope implementation.
+		This header file provides the per-thread stack behind the
+		scopes, such as liboai::CancellationScope and
+		liboai::DeadlineScope, that put the requests made on a
+		thread under some setting for as long as they are alive.
+*/
+
+namespace liboai {
+	/*
+		@brief The innermost _Scope alive on each thread. A scope
+			keeps the one it was opened in, and makes it innermost
+			again when it closes.
+	*/
+	template <class _Scope>
+	class ScopeStack final {
+		public:
+			static const _Scope*& Innermost() noexcept {
+				thread_local const _Scope* scope = nullptr;
+				return scope;
+			}
+	};
+}
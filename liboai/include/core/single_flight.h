@@ -0,0 +1,85 @@
+#pragma once
+
+/*
+	single_flight.h : liboai request coalescing implementation.
+		This header file provides declarations for the table of
+		requests in flight that liboai::Network uses, once enabled
+		with liboai::Network::SetRequestCoalescing(), to share one
+		transfer among concurrent identical requests.
+
+		Requests are keyed as liboai::ResponseCache keys them. The
+		first caller sends the request; callers that make the same
+		request before it completes wait for that transfer instead,
+		and each receives its own copy of the response, or the same
+		error.
+
+		Only requests without side effects are coalesced: GETs, and
+		chat, completion, moderation and embedding requests that
+		would be answered the same way each time (see
+		ResponseCacheOptions::deterministic_only).
+*/
+
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+#include "response_cache.h"
+
+namespace liboai {
+	class SingleFlight final {
+		public:
+			using Waiter = std::function<void(std::future<liboai::Response>)>;
+
+			/*
+				@brief A request in flight, held by the caller sending
+					it. Its outcome is handed to every waiter when it
+					lands; a flight dropped without landing fails its
+					waiters rather than leaving them waiting.
+			*/
+			class Flight final {
+				public:
+					LIBOAI_EXPORT ~Flight();
+					NON_COPYABLE(Flight)
+					NON_MOVABLE(Flight)
+
+					/*
+						@brief Hands the outcome to the waiters. Only the
+							first call has any effect.
+					*/
+					LIBOAI_EXPORT void Land(const liboai::Response& response) noexcept;
+					LIBOAI_EXPORT void Land(std::exception_ptr error) noexcept;
+
+				private:
+					friend class SingleFlight;
+					explicit Flight(const ResponseCache::Key& key) noexcept : key_(key) {}
+
+					void Deliver(const liboai::Response* response, std::exception_ptr error) noexcept;
+
+					ResponseCache::Key key_;
+					bool landed_ = false;         // guarded by the table's mutex
+					std::vector<Waiter> waiters_; // likewise
+			};
+
+			/*
+				@brief Joins the flight of an identical request, if one
+					is in progress, in which case waiter is later called
+					with its outcome and nullptr is returned. Otherwise
+					a new flight is started and returned, and the caller
+					must send the request and land the flight.
+			*/
+			LIBOAI_EXPORT static std::shared_ptr<Flight> Join(const ResponseCache::Key& key, Waiter waiter);
+
+			/*
+				@brief The key of a request if it may be coalesced, see
+					ResponseCache::KeyOf().
+			*/
+			LIBOAI_EXPORT static std::optional<ResponseCache::Key> KeyOf(std::string_view method, std::string_view url, std::string_view body, std::string_view context);
+
+			/*
+				@brief Whether liboai::Network coalesces requests; see
+					liboai::Network::SetRequestCoalescing().
+			*/
+			LIBOAI_EXPORT static void SetEnabled(bool enabled) noexcept;
+			LIBOAI_EXPORT static bool Enabled() noexcept;
+	};
+}
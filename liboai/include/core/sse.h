@@ -0,0 +1,119 @@
+#pragma once
+
+/*
+	sse.h : liboai server-sent events implementation.
+		This header file provides declarations for the incremental
+		server-sent events (SSE) parser used by streamed endpoints.
+
+		Network chunks are appended to the parser as they arrive,
+		regardless of where they split the stream; complete events
+		are then pulled out one at a time. Event fields are returned
+		as views into the parser's own buffer, so parsing a stream
+		performs no per-line or per-event allocation once the buffer
+		has grown to fit the largest event.
+*/
+
+#include <string>
+#include <string_view>
+#include <optional>
+#include <functional>
+#include <cstdint>
+#include "response.h"
+#include "netimpl.h"
+
+namespace liboai {
+	/*
+		@brief A single dispatched event. All views point into the
+			SseParser that produced the event and remain valid until
+			the next call to Append() or Next() on that parser.
+	*/
+	struct SseEvent {
+		std::string_view event;  // event type; "message" if unspecified
+		std::string_view data;   // data lines joined by '\n'
+		std::string_view id;     // last event ID seen on the stream
+		std::string_view raw;    // the raw bytes of the event, including its terminating blank line
+	};
+
+	class SseParser final {
+		public:
+			SseParser() = default;
+			SseParser(const SseParser& other) = default;
+			SseParser(SseParser&& old) noexcept = default;
+			~SseParser() = default;
+
+			SseParser& operator=(const SseParser& other) = default;
+			SseParser& operator=(SseParser&& old) noexcept = default;
+
+			/*
+				@brief Appends a chunk of the stream. Chunks may end
+					anywhere, including in the middle of a line or
+					between the CR and LF of a line break.
+			*/
+			LIBOAI_EXPORT void Append(std::string_view chunk);
+
+			/*
+				@brief Extracts the next complete event, if any.
+
+				@param *event    Receives the event on success.
+
+				@returns True if an event was extracted, false if more
+					data is needed.
+			*/
+			[[nodiscard]] LIBOAI_EXPORT bool Next(SseEvent& event);
+
+			/*
+				@brief Discards all buffered data and stream state.
+			*/
+			LIBOAI_EXPORT void Reset() noexcept;
+
+			/*
+				@returns The reconnection time last sent by the server
+					through a retry field, if any.
+			*/
+			std::optional<uint64_t> Retry() const noexcept { return this->retry_; }
+
+			/*
+				@returns The bytes appended since the last extracted
+					event that do not yet make up a whole event.
+			*/
+			std::string_view Pending() const noexcept { return std::string_view(this->buffer_).substr(this->event_begin_); }
+
+			/*
+				@brief Wraps a stream callback so that it is only ever
+					handed whole events. Each network chunk results in
+					at most one call, containing the raw bytes of every
+					event completed by that chunk; a partial event is
+					held back until the rest of it arrives, and handed
+					over as it stands if the stream ends first. A body
+					that is not an event stream, such as the JSON error
+					returned with a 4xx or 5xx status, is passed through
+					unframed.
+			*/
+			LIBOAI_EXPORT static netimpl::components::WriteCallback Framed(
+				std::function<bool(std::string, intptr_t)> callback
+			);
+
+		private:
+			struct Span {
+				size_t offset = 0, length = 0;
+			};
+
+			void ProcessLine(size_t begin, size_t end);
+			void Compact();
+			void ClearPending() noexcept;
+			std::string_view View(const Span& span) const noexcept { return { this->buffer_.data() + span.offset, span.length }; }
+
+			std::string buffer_;      // unconsumed stream data
+			size_t scan_ = 0;         // next unscanned byte in buffer_
+			size_t event_begin_ = 0;  // first byte of the event being assembled
+			bool skip_lf_ = false;    // a CR ended the last line; swallow a following LF
+
+			// fields of the event being assembled, as offsets into buffer_
+			Span event_, data_;
+			size_t data_lines_ = 0;
+			std::string joined_;      // data of multi-line events
+
+			std::string id_;          // persists across events, per spec
+			std::optional<uint64_t> retry_;
+	};
+}
@@ -34,6 +34,8 @@
 #include "components/completions.h"
 #include "components/edits.h"
 #include "components/embeddings.h"
+#include "components/embedding_cache.h"
+#include "components/vector_index.h"
 #include "components/files.h"
 #include "components/fine_tunes.h"
 #include "components/images.h"